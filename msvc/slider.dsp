@@ -53,7 +53,7 @@ BSC32=bscmake.exe
 # ADD BSC32 /nologo
 LINK32=link.exe
 # ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:windows /machine:I386
-# ADD LINK32 gtk-win32-2.0.lib gdk-win32-2.0.lib atk-1.0.lib gdk_pixbuf-2.0.lib pangowin32-1.0.lib gdi32.lib pango-1.0.lib gobject-2.0.lib gmodule-2.0.lib glib-2.0.lib intl.lib iconv.lib /nologo /subsystem:windows /machine:I386 /libpath:"$(GTK_BASEPATH)/lib"
+# ADD LINK32 gtk-win32-2.0.lib gdk-win32-2.0.lib atk-1.0.lib gdk_pixbuf-2.0.lib pangowin32-1.0.lib gdi32.lib pango-1.0.lib gobject-2.0.lib gmodule-2.0.lib gthread-2.0.lib glib-2.0.lib intl.lib iconv.lib /nologo /subsystem:windows /machine:I386 /libpath:"$(GTK_BASEPATH)/lib"
 
 !ELSEIF  "$(CFG)" == "slider - Win32 Debug"
 
@@ -79,7 +79,7 @@ BSC32=bscmake.exe
 # ADD BSC32 /nologo
 LINK32=link.exe
 # ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:console /debug /machine:I386 /pdbtype:sept
-# ADD LINK32 gtk-win32-2.0.lib gdk-win32-2.0.lib atk-1.0.lib gdk_pixbuf-2.0.lib pangowin32-1.0.lib gdi32.lib pango-1.0.lib gobject-2.0.lib gmodule-2.0.lib glib-2.0.lib intl.lib iconv.lib /nologo /subsystem:console /debug /machine:I386 /pdbtype:sept /libpath:"$(GTK_BASEPATH)/lib"
+# ADD LINK32 gtk-win32-2.0.lib gdk-win32-2.0.lib atk-1.0.lib gdk_pixbuf-2.0.lib pangowin32-1.0.lib gdi32.lib pango-1.0.lib gobject-2.0.lib gmodule-2.0.lib gthread-2.0.lib glib-2.0.lib intl.lib iconv.lib /nologo /subsystem:console /debug /machine:I386 /pdbtype:sept /libpath:"$(GTK_BASEPATH)/lib"
 
 !ENDIF 
 
@@ -118,6 +118,78 @@ SOURCE=..\src\file_business.c
 
 SOURCE=..\src\audio.c
 # End Source File
+# Begin Source File
+
+SOURCE=..\src\wav_exporter.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\core_audio.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\autosave.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\project_saver.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\project_loader.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\core_project.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\core_render.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\core_model.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\undo.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\model_pool.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\headless.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\editor_strip.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\spectrum_view.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\fft.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\scope_view.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\audio_ring.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\tile_pool.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\wave_view.c
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -152,6 +224,66 @@ SOURCE=..\src\audio.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\wav_exporter.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\autosave.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\project_saver.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\project_loader.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\slidercore.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\undo.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\model_pool.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\headless.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\editor_strip.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\spectrum_view.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\fft.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\scope_view.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\audio_ring.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\tile_pool.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\wave_view.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\gawrapper.h
 # End Source File
 # End Group
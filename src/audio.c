@@ -44,10 +44,12 @@ DAMAGE.  */
 #include "support.h"
 #include "wv_editors.h"
 #include "callbacks.h"
+#include "scope_view.h"
+#include "spectrum_view.h"
 
 gboolean audio_playing = FALSE;
 float agc_volume = 0.5;
-static unsigned sample_rate;
+unsigned sample_rate = 0;
 
 static int
 audio_process (float * out, unsigned long frames_per_buffer)
@@ -80,17 +82,17 @@ audio_process (float * out, unsigned long frames_per_buffer)
       cur_fund->phase_pos = modff (cur_fund->phase_pos, &intpart);
     }
 
-  { /* Normalize the waveform and clip near the desired maximum
-       amplitude.  */
-    float agc_clip_volume = agc_volume * 1.25;
-    for (i = 0; i < frames_per_buffer; i++)
-      {
-	out[i] *= agc_volume / max_ypt;
-	out[i] = ((out[i] > 0) ?
-		  MIN (out[i], agc_clip_volume) :
-		  MAX (out[i], -agc_clip_volume));
-      }
-  }
+  /* Normalize the waveform and clip near the desired maximum
+     amplitude.  */
+  apply_agc (out, frames_per_buffer, agc_volume, max_ypt);
+
+  /* Let the oscilloscope and the spectrum analyzer see what is
+     actually played.  This never blocks or allocates memory, and
+     costs one copy of the buffer per ring.  */
+  if (scope_ring != NULL)
+    audio_ring_write (scope_ring, out, frames_per_buffer);
+  if (spectrum_ring != NULL)
+    audio_ring_write (spectrum_ring, out, frames_per_buffer);
 
   return 0;
 }
@@ -44,6 +44,7 @@ DAMAGE.  */
 
 extern gboolean audio_playing;
 extern float agc_volume;
+extern unsigned sample_rate;
 
 void audio_init (void);
 void audio_play (void);
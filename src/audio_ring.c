@@ -0,0 +1,171 @@
+/* Wait-free ring buffer for passing audio out of the audio callback.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "audio_ring.h"
+
+/**
+ * A ring buffer of samples.
+ *
+ * The positions count samples since the ring was created and wrap
+ * around modulo 2^32, which is a multiple of the size, so the number
+ * of samples in the ring is always the difference of the two
+ * positions.
+ */
+struct _Audio_Ring
+{
+  float *buf;
+  /** Number of samples in ::buf, which is a power of two */
+  unsigned size;
+  /** Position of the next sample to write, written by the producer */
+  volatile gint write_pos;
+  /** Position of the next sample to read, written by the consumer */
+  volatile gint read_pos;
+  /** Number of samples dropped because the ring was full */
+  volatile gint dropped;
+};
+
+/**
+ * Creates a ring buffer.
+ *
+ * @param min_size the minimum number of samples that the ring must
+ * be able to hold.  It is rounded up to a power of two.
+ */
+Audio_Ring *
+audio_ring_new (unsigned min_size)
+{
+  Audio_Ring *ring = g_new (Audio_Ring, 1);
+  ring->size = 1;
+  while (ring->size < min_size)
+    ring->size <<= 1;
+  ring->buf = g_new0 (float, ring->size);
+  ring->write_pos = 0;
+  ring->read_pos = 0;
+  ring->dropped = 0;
+  return ring;
+}
+
+void
+audio_ring_free (Audio_Ring * ring)
+{
+  if (ring == NULL)
+    return;
+  g_free (ring->buf);
+  g_free (ring);
+}
+
+/**
+ * Appends samples to a ring.  Only the producer may call this.
+ *
+ * This function never blocks and never allocates memory, so it is
+ * safe to call from a real-time audio callback.
+ * @return the number of samples that were written.  The rest were
+ * dropped because the ring was full.
+ */
+unsigned
+audio_ring_write (Audio_Ring * ring, const float * samples,
+		  unsigned num_samples)
+{
+  guint write_pos = (guint) ring->write_pos;
+  guint read_pos = (guint) g_atomic_int_get (&ring->read_pos);
+  unsigned space = ring->size - (write_pos - read_pos);
+  unsigned count = MIN (num_samples, space);
+  unsigned ofs = write_pos & (ring->size - 1);
+  unsigned first = MIN (count, ring->size - ofs);
+
+  memcpy (&ring->buf[ofs], samples, sizeof (float) * first);
+  memcpy (ring->buf, &samples[first], sizeof (float) * (count - first));
+  /* The atomic store orders the copies above before the new position
+     becomes visible to the consumer.  */
+  g_atomic_int_set (&ring->write_pos, (gint) (write_pos + count));
+  if (count < num_samples)
+    g_atomic_int_add (&ring->dropped, (gint) (num_samples - count));
+  return count;
+}
+
+/**
+ * Returns the number of samples waiting to be read.  Only the
+ * consumer may call this.
+ */
+unsigned
+audio_ring_available (Audio_Ring * ring)
+{
+  guint write_pos = (guint) g_atomic_int_get (&ring->write_pos);
+  return write_pos - (guint) ring->read_pos;
+}
+
+/**
+ * Removes the oldest samples from a ring.  Only the consumer may call
+ * this.
+ *
+ * @param samples the array that will hold the samples, or NULL to
+ * just discard them
+ * @param num_samples the largest number of samples to remove
+ * @return the number of samples that were removed
+ */
+unsigned
+audio_ring_read (Audio_Ring * ring, float * samples, unsigned num_samples)
+{
+  guint read_pos = (guint) ring->read_pos;
+  unsigned count = MIN (num_samples, audio_ring_available (ring));
+  unsigned ofs = read_pos & (ring->size - 1);
+  unsigned first = MIN (count, ring->size - ofs);
+
+  if (samples != NULL)
+    {
+      memcpy (samples, &ring->buf[ofs], sizeof (float) * first);
+      memcpy (&samples[first], ring->buf, sizeof (float) * (count - first));
+    }
+  /* Only release the space to the producer once the copies are
+     done.  */
+  g_atomic_int_set (&ring->read_pos, (gint) (read_pos + count));
+  return count;
+}
+
+/**
+ * Returns the number of samples dropped since the last call and
+ * resets the count.
+ */
+unsigned
+audio_ring_take_dropped (Audio_Ring * ring)
+{
+  gint dropped;
+  do
+    dropped = g_atomic_int_get (&ring->dropped);
+  while (!g_atomic_int_compare_and_exchange (&ring->dropped, dropped, 0));
+  return (unsigned) dropped;
+}
@@ -0,0 +1,57 @@
+/* Wait-free ring buffer for passing audio out of the audio callback.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Wait-free single-producer, single-consumer ring buffer of samples.
+ *
+ * The audio callback must never block or allocate memory, so it hands
+ * its output to the user interface through this ring.  The producer
+ * and the consumer each own one position and only publish it with an
+ * atomic store, so neither side ever waits for the other.  When the
+ * consumer falls behind and the ring is full, the producer drops the
+ * samples that do not fit and counts them instead.
+ */
+
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+typedef struct _Audio_Ring Audio_Ring;
+
+Audio_Ring *audio_ring_new (unsigned min_size);
+void audio_ring_free (Audio_Ring * ring);
+unsigned audio_ring_write (Audio_Ring * ring, const float * samples,
+			   unsigned num_samples);
+unsigned audio_ring_available (Audio_Ring * ring);
+unsigned audio_ring_read (Audio_Ring * ring, float * samples,
+			  unsigned num_samples);
+unsigned audio_ring_take_dropped (Audio_Ring * ring);
+
+#endif /* not AUDIO_RING_H */
@@ -0,0 +1,634 @@
+/* Autosave journal of the current project.
+
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#  include <io.h>
+#  include <share.h>
+#  include <process.h>
+#  define getpid _getpid
+#endif
+
+#include "autosave.h"
+#include "callbacks.h"
+#include "interface.h"
+#include "support.h"
+#include "wv_editors.h"
+#include "wave_view.h"
+
+/** Milliseconds between checks for changes to autosave.  */
+#define AUTOSAVE_INTERVAL 5000
+/** The journal is compacted once it would grow past this many times
+    the size it had when it was last compacted...  */
+#define COMPACT_RATIO 4
+/** ...or past this many bytes, whichever is larger.  */
+#define COMPACT_MIN 65536
+
+/** Journals and their lock files are named with this prefix, followed
+    by the ID of the instance that writes them.  */
+#define JOURNAL_PREFIX "autosave-"
+#define JOURNAL_SUFFIX ".sliwj"
+#define LOCK_SUFFIX ".lock"
+
+/** File operations that are done on the journal.  */
+enum _Journal_Op
+{
+  JOURNAL_REWRITE, /**< Replace the journal with new contents */
+  JOURNAL_APPEND, /**< Append a block to the journal */
+  JOURNAL_DELETE /**< Delete the journal */
+};
+typedef enum _Journal_Op Journal_Op;
+
+typedef struct _Journal_Task Journal_Task;
+
+/** A file operation that is queued for the worker thread.  */
+struct _Journal_Task
+{
+  Journal_Op op;
+  /** What to write, or NULL for ::JOURNAL_DELETE */
+  GString *data;
+};
+
+/** A journal that was left behind by an instance that is gone.  */
+typedef struct _Orphan Orphan;
+
+struct _Orphan
+{
+  gchar *id; /**< The ID of the instance that wrote the journal */
+  int lock_fd; /**< Holds the lock on the journal's lock file */
+  time_t mtime; /**< When the journal was last written */
+};
+
+/** The directory that holds the journals.  */
+static gchar *journal_dir = NULL;
+/** The ID of this instance.  */
+static gchar *instance_id = NULL;
+/** The file name of the journal of this instance.  */
+static gchar *journal_name = NULL;
+/** The file name of the lock file of this instance.  */
+static gchar *lock_name = NULL;
+/** Holds the lock on ::lock_name, or -1 if it could not be locked, in
+    which case nothing is autosaved.  */
+static int lock_fd = -1;
+/** Does the file operations on the journal one at a time, in the
+    order they were queued.  */
+static GThreadPool *journal_pool = NULL;
+static guint timeout_source = 0;
+/** The hash of each set of the project as of the last block that was
+    queued, or empty if the journal must be written from scratch.  */
+static GArray *saved_hashes = NULL;
+/** Size of the journal once all queued operations are done.  */
+static gsize journal_size = 0;
+/** Size of the journal when it was last written from scratch.  */
+static gsize compact_size = 0;
+/** Set by the worker thread when a file operation failed, so that
+    the journal is written from scratch next time.  */
+static volatile gint journal_failed = 0;
+
+/**
+ * Does a file operation on the journal.  Called on the worker thread.
+ */
+static void
+journal_func (gpointer data, gpointer user_data)
+{
+  Journal_Task *task = (Journal_Task *) data;
+  Core_Error error = CORE_OK;
+
+  switch (task->op)
+    {
+    case JOURNAL_REWRITE:
+      error = write_file_atomic (journal_name, task->data->str,
+				 task->data->len, TRUE);
+      break;
+    case JOURNAL_APPEND:
+      error = append_file (journal_name, task->data->str,
+			   task->data->len, TRUE);
+      break;
+    case JOURNAL_DELETE:
+      g_unlink (journal_name);
+      break;
+    }
+  if (error != CORE_OK)
+    g_atomic_int_set (&journal_failed, 1);
+  if (task->data != NULL)
+    g_string_free (task->data, TRUE);
+  g_free (task);
+}
+
+/** Queues a file operation on the journal.  */
+static void
+queue_journal_task (Journal_Op op, GString * data)
+{
+  Journal_Task *task = g_new (Journal_Task, 1);
+  task->op = op;
+  task->data = data;
+  g_thread_pool_push (journal_pool, task, NULL);
+}
+
+/**
+ * Timer that records the sets that changed since the last check.
+ */
+static gboolean
+autosave_tick (gpointer data)
+{
+  gboolean *changed;
+  gboolean any_changed;
+  gboolean rewrite;
+  GString *block;
+  unsigned i;
+
+  if (!file_modified)
+    return TRUE;
+
+  changed = g_new (gboolean, wv_all_freqs->len);
+  any_changed = (wv_all_freqs->len != saved_hashes->len);
+  for (i = 0; i < wv_all_freqs->len; i++)
+    {
+      guint32 hash = hash_fund_freq (&wv_all_freqs->d[i]);
+      changed[i] = (i >= saved_hashes->len ||
+		    g_array_index (saved_hashes, guint32, i) != hash);
+      if (changed[i])
+	{
+	  if (i >= saved_hashes->len)
+	    g_array_set_size (saved_hashes, i + 1);
+	  g_array_index (saved_hashes, guint32, i) = hash;
+	  any_changed = TRUE;
+	}
+    }
+  g_array_set_size (saved_hashes, wv_all_freqs->len);
+  if (!any_changed)
+    {
+      g_free (changed);
+      return TRUE;
+    }
+
+  rewrite = (g_atomic_int_compare_and_exchange (&journal_failed, 1, 0) ||
+	     journal_size == 0);
+  block = g_string_new (NULL);
+  if (!rewrite)
+    {
+      journal_format_block (block, wv_all_freqs, changed);
+      rewrite = (journal_size + block->len >
+		 MAX (COMPACT_MIN, COMPACT_RATIO * compact_size));
+    }
+  g_free (changed);
+
+  if (rewrite)
+    {
+      g_string_truncate (block, 0);
+      journal_format_header (block, loaded_fname);
+      journal_format_block (block, wv_all_freqs, NULL);
+      journal_size = compact_size = block->len;
+      queue_journal_task (JOURNAL_REWRITE, block);
+    }
+  else
+    {
+      journal_size += block->len;
+      queue_journal_task (JOURNAL_APPEND, block);
+    }
+  return TRUE;
+}
+
+/**
+ * Builds the file name of the journal or the lock file of an
+ * instance.
+ *
+ * @param id the ID of the instance
+ * @param suffix #JOURNAL_SUFFIX or #LOCK_SUFFIX
+ * @return the file name, which must be freed with g_free()
+ */
+static gchar *
+instance_file_name (const gchar * id, const gchar * suffix)
+{
+  gchar *basename = g_strconcat (JOURNAL_PREFIX, id, suffix, NULL);
+  gchar *filename = g_build_filename (journal_dir, basename, NULL);
+  g_free (basename);
+  return filename;
+}
+
+/**
+ * Opens and locks a lock file.
+ *
+ * The lock is held until the file is closed.  The operating system
+ * releases it when the process exits for whatever reason, so a lock
+ * file that can be locked belongs to an instance that is gone.
+ * @param filename the lock file, which is created if necessary
+ * @return the file descriptor of the lock file, or -1 if another
+ * process holds the lock or the file could not be opened
+ */
+static int
+lock_file (const gchar * filename)
+{
+  int fd;
+#ifdef G_OS_WIN32
+  /* No other process can open the file while it is open without
+     sharing.  */
+  wchar_t *wname = g_utf8_to_utf16 (filename, -1, NULL, NULL, NULL);
+  fd = -1;
+  if (wname != NULL)
+    fd = _wsopen (wname, _O_RDWR | _O_CREAT, _SH_DENYRW,
+		  _S_IREAD | _S_IWRITE);
+  g_free (wname);
+#else
+  struct flock lock;
+
+  fd = g_open (filename, O_RDWR | O_CREAT, 0600);
+  if (fd == -1)
+    return -1;
+  memset (&lock, 0, sizeof (lock));
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  if (fcntl (fd, F_SETLK, &lock) == -1)
+    {
+      close (fd);
+      fd = -1;
+    }
+#endif
+  return fd;
+}
+
+/**
+ * Releases a lock taken with lock_file() and deletes the lock file.
+ */
+static void
+unlock_file (const gchar * filename, int fd)
+{
+#ifdef G_OS_WIN32
+  /* A file that is open cannot be deleted.  */
+  close (fd);
+  g_unlink (filename);
+#else
+  /* Deleting the file first keeps another process from locking it
+     in between.  */
+  g_unlink (filename);
+  close (fd);
+#endif
+}
+
+/**
+ * Sorts orphaned journals from the most recent to the oldest.
+ */
+static gint
+compare_orphans (gconstpointer a, gconstpointer b)
+{
+  time_t mtime_a = ((const Orphan *) a)->mtime;
+  time_t mtime_b = ((const Orphan *) b)->mtime;
+  return (mtime_a < mtime_b) - (mtime_a > mtime_b);
+}
+
+/**
+ * Checks whether the instance that wrote a journal or lock file is
+ * gone, and adds its journal to the list of orphans if so.
+ *
+ * @param key the ID of the instance
+ * @param value unused
+ * @param data the #GArray of ::Orphan to add to
+ */
+static void
+check_instance (gpointer key, gpointer value, gpointer data)
+{
+  Orphan orphan;
+  gchar *filename;
+  struct stat info;
+
+  if (!strcmp ((const gchar *) key, instance_id))
+    return;
+  filename = instance_file_name ((const gchar *) key, LOCK_SUFFIX);
+  orphan.lock_fd = lock_file (filename);
+  if (orphan.lock_fd == -1)
+    {
+      g_free (filename); /* The instance is still running.  */
+      return;
+    }
+
+  orphan.id = g_strdup ((const gchar *) key);
+  g_free (filename);
+  filename = instance_file_name (orphan.id, JOURNAL_SUFFIX);
+  if (g_stat (filename, &info) == 0)
+    {
+      orphan.mtime = info.st_mtime;
+      g_array_append_val ((GArray *) data, orphan);
+    }
+  else
+    {
+      /* The instance crashed before it wrote anything.  */
+      g_free (filename);
+      filename = instance_file_name (orphan.id, LOCK_SUFFIX);
+      unlock_file (filename, orphan.lock_fd);
+      g_free (orphan.id);
+    }
+  g_free (filename);
+}
+
+/**
+ * Finds the journals that were left behind by instances that crashed.
+ *
+ * @return a #GArray of ::Orphan, sorted from the most recent journal
+ * to the oldest.  The caller holds the lock on each journal.
+ */
+static GArray *
+find_orphans (void)
+{
+  GArray *orphans = g_array_new (FALSE, FALSE, sizeof (Orphan));
+  GHashTable *ids;
+  GDir *dir;
+  const gchar *name;
+
+  dir = g_dir_open (journal_dir, 0, NULL);
+  if (dir == NULL)
+    return orphans;
+  /* Look at lock files as well, so that the ones without a journal
+     are cleaned up.  */
+  ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      gsize len = strlen (name);
+      if (!g_str_has_prefix (name, JOURNAL_PREFIX))
+	continue;
+      if (g_str_has_suffix (name, JOURNAL_SUFFIX))
+	len -= strlen (JOURNAL_SUFFIX);
+      else if (g_str_has_suffix (name, LOCK_SUFFIX))
+	len -= strlen (LOCK_SUFFIX);
+      else
+	continue;
+      if (len <= strlen (JOURNAL_PREFIX))
+	continue;
+      g_hash_table_insert (ids, g_strndup (name + strlen (JOURNAL_PREFIX),
+					   len - strlen (JOURNAL_PREFIX)),
+			   NULL);
+    }
+  g_dir_close (dir);
+  g_hash_table_foreach (ids, check_instance, orphans);
+  g_hash_table_destroy (ids);
+  g_array_sort (orphans, compare_orphans);
+  return orphans;
+}
+
+/**
+ * Starts up autosaving.  This must be called after the GLib thread
+ * system was initialized.  Changes are not recorded until
+ * autosave_start() is called.
+ */
+void
+autosave_init (void)
+{
+  journal_dir = g_build_filename (g_get_user_data_dir (), PACKAGE, NULL);
+  g_mkdir_with_parents (journal_dir, 0700);
+  /* The start time keeps a process that is given the ID of a crashed
+     one from taking over its journal.  */
+  instance_id = g_strdup_printf ("%lu-%lu", (unsigned long) getpid (),
+				 (unsigned long) time (NULL));
+  journal_name = instance_file_name (instance_id, JOURNAL_SUFFIX);
+  lock_name = instance_file_name (instance_id, LOCK_SUFFIX);
+  lock_fd = lock_file (lock_name);
+
+  saved_hashes = g_array_new (FALSE, FALSE, sizeof (guint32));
+  journal_pool = g_thread_pool_new (journal_func, NULL, 1, FALSE, NULL);
+}
+
+/**
+ * Starts recording changes to the journal every few seconds.  This
+ * must be called after autosave_recover(), whose dialog runs the main
+ * loop.
+ */
+void
+autosave_start (void)
+{
+  if (lock_fd != -1 && timeout_source == 0)
+    timeout_source = g_timeout_add (AUTOSAVE_INTERVAL, autosave_tick,
+				    NULL);
+}
+
+/**
+ * Asks whether to recover the project from a journal.
+ *
+ * @param filename the journal
+ * @param pending_file the file given on the command line, or NULL
+ * @param model where to store the recovered project, or NULL if the
+ * journal is discarded
+ * @param project_name where to store the file name of the recovered
+ * project
+ * @return TRUE if the user chose to recover the journal
+ */
+static gboolean
+ask_recover (const gchar * filename, const gchar * pending_file,
+	     Wv_Fund_Freq_array ** model, gchar ** project_name)
+{
+  GtkWidget *dialog;
+  GString *text;
+  gint result;
+
+  *model = model_array_new ();
+  if (read_journal (*model, filename, project_name) != CORE_OK)
+    {
+      model_array_free (*model);
+      *model = NULL;
+      return FALSE;
+    }
+
+  text = g_string_new
+    (_("<b><big>Recover unsaved changes?</big></b>\n\n" \
+       "Slider Wave Editor did not close properly last time.  " \
+       "The changes that were not saved can be recovered from the " \
+       "autosave journal."));
+  if (*project_name != NULL)
+    {
+      gchar *display_name = g_filename_display_basename (*project_name);
+      gchar *markup = g_markup_printf_escaped (_("  They were made to %s."),
+					       display_name);
+      g_string_append (text, markup);
+      g_free (markup);
+      g_free (display_name);
+    }
+  if (pending_file != NULL)
+    {
+      gchar *display_name = g_filename_display_basename (pending_file);
+      gchar *markup = g_markup_printf_escaped
+	(_("\n\nIf you recover them, %s is not opened."), display_name);
+      g_string_append (text, markup);
+      g_free (markup);
+      g_free (display_name);
+    }
+  dialog = gtk_message_dialog_new (GTK_WINDOW (main_window),
+				   GTK_DIALOG_DESTROY_WITH_PARENT,
+				   GTK_MESSAGE_QUESTION, GTK_BUTTONS_NONE,
+				   NULL);
+  gtk_message_dialog_set_markup (GTK_MESSAGE_DIALOG (dialog), text->str);
+  g_string_free (text, TRUE);
+  gtk_dialog_add_buttons (GTK_DIALOG (dialog),
+			  _("_Discard"), GTK_RESPONSE_REJECT,
+			  _("_Recover"), GTK_RESPONSE_ACCEPT,
+			  NULL);
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog),
+				   GTK_RESPONSE_ACCEPT);
+  gtk_window_set_title (GTK_WINDOW (dialog), _("Slider Wave Editor"));
+  result = gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
+
+  if (result != GTK_RESPONSE_ACCEPT)
+    {
+      model_array_free (*model);
+      *model = NULL;
+      g_free (*project_name);
+      *project_name = NULL;
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/**
+ * Offers to recover the project from the journals that were left
+ * behind by instances that crashed, starting with the most recent
+ * one.  Journals are offered until one is recovered, and each one
+ * that is discarded is deleted.  This must be called once the main
+ * window is shown and before anything was edited.
+ *
+ * @param pending_file the file that is opened unless a journal is
+ * recovered, or NULL
+ * @return TRUE if the project was recovered, FALSE otherwise
+ */
+gboolean
+autosave_recover (const gchar * pending_file)
+{
+  GArray *orphans = find_orphans ();
+  Wv_Fund_Freq_array *model = NULL;
+  gchar *project_name = NULL;
+  unsigned i;
+
+  for (i = 0; i < orphans->len; i++)
+    {
+      Orphan *orphan = &g_array_index (orphans, Orphan, i);
+      gchar *orphan_journal = instance_file_name (orphan->id, JOURNAL_SUFFIX);
+      gchar *orphan_lock = instance_file_name (orphan->id, LOCK_SUFFIX);
+      gboolean deleted = TRUE;
+
+      if (model == NULL)
+	{
+	  if (ask_recover (orphan_journal, pending_file, &model,
+			   &project_name))
+	    {
+	      /* The journal becomes this instance's, which keeps the
+		 changes safe until the next check rewrites it.  */
+	      if (g_rename (orphan_journal, journal_name) != 0)
+		deleted = FALSE;
+	    }
+	  else
+	    g_unlink (orphan_journal);
+	}
+      else
+	deleted = FALSE; /* Offer it again next time.  */
+
+      if (deleted)
+	unlock_file (orphan_lock, orphan->lock_fd);
+      else
+	close (orphan->lock_fd);
+      g_free (orphan_lock);
+      g_free (orphan_journal);
+      g_free (orphan->id);
+    }
+  g_array_free (orphans, TRUE);
+  if (model == NULL)
+    return FALSE;
+
+  unselect_fund_freq (g_fund_set);
+  free_wv_editors ();
+  init_wv_editors ();
+  model_array_free (model_swap (model));
+  g_free (loaded_fname);
+  loaded_fname = project_name;
+  create_fund_uis (0, wv_all_freqs->len);
+  select_fund_freq (0);
+  wave_view_changed (FALSE);
+  /* The recovered project is not saved anywhere, and the next check
+     writes the journal from scratch.  */
+  file_modified = TRUE;
+  return TRUE;
+}
+
+/**
+ * Deletes the journal, because the current project was just saved,
+ * loaded, or replaced with a new one.
+ */
+void
+autosave_reset (void)
+{
+  g_array_set_size (saved_hashes, 0);
+  journal_size = 0;
+  queue_journal_task (JOURNAL_DELETE, NULL);
+}
+
+/**
+ * Stops autosaving and deletes the journal.  This must be called
+ * after the main loop has quit and the user had the chance to save
+ * the project.
+ */
+void
+autosave_shutdown (void)
+{
+  if (timeout_source != 0)
+    g_source_remove (timeout_source);
+  timeout_source = 0;
+  queue_journal_task (JOURNAL_DELETE, NULL);
+  /* This waits for the queued operations.  */
+  g_thread_pool_free (journal_pool, FALSE, TRUE);
+  journal_pool = NULL;
+  /* The journal must be gone before the lock is released, or another
+     instance could take it for a crashed one.  */
+  if (lock_fd != -1)
+    unlock_file (lock_name, lock_fd);
+  lock_fd = -1;
+  g_array_free (saved_hashes, TRUE);
+  saved_hashes = NULL;
+  g_free (lock_name);
+  lock_name = NULL;
+  g_free (journal_name);
+  journal_name = NULL;
+  g_free (instance_id);
+  instance_id = NULL;
+  g_free (journal_dir);
+  journal_dir = NULL;
+}
@@ -0,0 +1,61 @@
+/* Autosave journal of the current project.
+
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Autosave journal of the current project.
+ *
+ * While the project has unsaved changes, the sets that changed since
+ * the last check are appended to an autosave journal every few
+ * seconds, so that a crash loses little work.  When the journal has
+ * grown well past the size of the project, it is compacted by
+ * replacing it with a single block that holds every set.  The blocks
+ * are formatted on the main thread, which is cheap, and all of the
+ * file operations are done in order on a worker thread.
+ *
+ * Each running instance of the program keeps its own journal in the
+ * user data directory, next to a lock file that it holds locked until
+ * it exits.  The journal is deleted when the project is saved or
+ * discarded.  A journal whose lock file is not locked at startup was
+ * left behind by an instance that crashed, and the user is offered to
+ * recover it.
+ */
+
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+void autosave_init (void);
+void autosave_start (void);
+gboolean autosave_recover (const gchar * pending_file);
+void autosave_reset (void);
+void autosave_shutdown (void);
+
+#endif /* not AUTOSAVE_H */
@@ -42,7 +42,16 @@ DAMAGE.  */
 #include "interface.h"
 #include "support.h"
 #include "wv_editors.h"
+#include "editor_strip.h"
 #include "audio.h"
+#include "wave_view.h"
+#include "scope_view.h"
+#include "spectrum_view.h"
+#include "undo.h"
+#include "project_loader.h"
+#include "project_saver.h"
+#include "autosave.h"
+#include "wav_exporter.h"
 
 /** Stores the number entered the "Multiply Amplitudes" dialog.  */
 static const gchar *mult_dlg_text;
@@ -55,8 +64,6 @@ gboolean file_modified = FALSE;
 gchar *last_folder = NULL;
 /** Keeps track of the currently loaded filename.  */
 gchar *loaded_fname = NULL;
-/** Contains the maximum y-point that is set during wave rendering.  */
-float max_ypt;
 
 void
 manual_win_destroy (GtkObject * object, gpointer user_data)
@@ -99,6 +106,9 @@ gboolean check_save (gboolean closing)
      question.  */
   gui_audio_stop ();
 
+  /* A save that is still running might yet fail.  */
+  project_saver_wait ();
+  precslid_flush ();
   if (!file_modified)
     return TRUE;
 
@@ -136,18 +146,23 @@ gboolean check_save (gboolean closing)
   else if (result == GTK_RESPONSE_CANCEL)
     return FALSE;
   else if (result == GTK_RESPONSE_YES)
-      return save_as ();
+    return save_as () && project_saver_wait ();
   /* Unknown response?  Do nothing.  */
   return FALSE;
 }
 
 /**
  * Save a file with a specific name from the GUI.
+ *
+ * The file is saved in the background, so an error is only reported
+ * once saving finishes.
+ * @return TRUE if saving was started, FALSE if the user cancelled
  */
 gboolean
 save_as (void)
 {
   GtkFileFilter *filter = gtk_file_filter_new ();
+  GtkFileFilter *binary_filter = gtk_file_filter_new ();
   GtkWidget *dialog =
     gtk_file_chooser_dialog_new (_("Save File"),
 				 GTK_WINDOW (main_window),
@@ -158,6 +173,10 @@ save_as (void)
   gtk_file_filter_set_name (filter, _("Slider Project Files"));
   gtk_file_filter_add_pattern (filter, "*.sliw");
   gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), filter);
+  gtk_file_filter_set_name (binary_filter,
+			    _("Slider Binary Project Files"));
+  gtk_file_filter_add_pattern (binary_filter, "*" SLIWB_SUFFIX);
+  gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), binary_filter);
   if (last_folder != NULL)
     {
       gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (dialog),
@@ -166,27 +185,26 @@ save_as (void)
 
   if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
     {
-      gboolean result;
       gchar *filename =
 	gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
-      unsigned filename_len = strlen (filename);
+      gboolean binary = (gtk_file_chooser_get_filter
+			 (GTK_FILE_CHOOSER (dialog)) == binary_filter);
       g_free (last_folder);
       last_folder = gtk_file_chooser_get_current_folder
 	                   (GTK_FILE_CHOOSER (dialog));
       gtk_widget_destroy (dialog);
-      if (filename_len <= 5 ||
-	  strcmp(&filename[filename_len-5], ".sliw"))
-	{
-	  filename = g_realloc (filename,
-				sizeof(gchar) * (filename_len + 6));
-	  strcpy(&filename[filename_len], ".sliw");
-	}
-      result = save_sliw_project (filename);
-      if (!result)
+      /* Add the extension of the chosen file type unless either
+	 extension was typed in.  */
+      if (!g_str_has_suffix (filename, ".sliw") &&
+	  !g_str_has_suffix (filename, SLIWB_SUFFIX))
 	{
+	  gchar *full_name = g_strconcat (filename,
+					  binary ? SLIWB_SUFFIX : ".sliw",
+					  NULL);
 	  g_free (filename);
-	  return FALSE;
+	  filename = full_name;
 	}
+      project_saver_start (filename);
       file_modified = FALSE;
       g_free(loaded_fname); loaded_fname = NULL;
       loaded_fname = filename;
@@ -213,6 +231,7 @@ open_file (void)
 				 NULL);
   gtk_file_filter_set_name (filter, _("Slider Project Files"));
   gtk_file_filter_add_pattern (filter, "*.sliw");
+  gtk_file_filter_add_pattern (filter, "*" SLIWB_SUFFIX);
   gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), filter);
   if (last_folder != NULL)
     {
@@ -228,20 +247,10 @@ open_file (void)
       last_folder = gtk_file_chooser_get_current_folder
 	                   (GTK_FILE_CHOOSER (dialog));
       gtk_widget_destroy (dialog);
-      g_free(loaded_fname); loaded_fname = NULL;
-      unselect_fund_freq (g_fund_set);
-      free_wv_editors ();
-      init_wv_editors ();
-      if (!load_sliw_project (filename))
-	{
-	  free_wv_editors ();
-	  g_free (filename);
-	  init_wv_editors ();
-	  new_sliw_project ();
-	}
-      else
-	loaded_fname = filename;
-      select_fund_freq (g_fund_set);
+      /* The current project is replaced once the file has been
+	 read.  */
+      project_loader_start (filename);
+      g_free (filename);
     }
   else
     gtk_widget_destroy (dialog);
@@ -266,38 +275,111 @@ main_window_delete (GtkWidget * widget, gpointer user_data)
 gboolean
 wavrnd_expose (GtkWidget * widget, GdkEventExpose * event, gpointer user_data)
 {
-  unsigned i;
-  gint last_ypt, win_width, win_height;
-  float *ypts;
-
   if (G_UNLIKELY (wr_gc == NULL))
     {
       wr_gc = gdk_gc_new (wave_render->window);
       gdk_gc_set_rgb_fg_color (wr_gc, &wr_foreground);
     }
 
-  win_width = widget->allocation.width;
-  win_height = widget->allocation.height;
-  ypts = (float *) g_malloc (sizeof (float) * win_width);
-  render_waves (ypts, win_width, 1.0 / calc_freq_extent ());
+  wave_view_draw (widget);
+
+  return TRUE;
+}
+
+/** Horizontal position of the pointer during a drag across
+    ::wave_render, or -1 if no drag is in progress.  */
+static gint wavrnd_drag_x = -1;
 
-  last_ypt = win_height / 2;
-  /* NB: widget->allocation.width >= 1 */
-  for (i = 0; i < (unsigned) win_width; i++)
+/**
+ * Signal handler for the "button_press_event" event sent to
+ * ::wave_render.
+ *
+ * Pressing the first button starts panning the time axis, and
+ * double-clicking returns to the automatic time scale.
+ */
+gboolean
+wavrnd_button_press (GtkWidget * widget, GdkEventButton * event,
+		     gpointer user_data)
+{
+  if (event->button != 1)
+    return FALSE;
+  if (event->type == GDK_2BUTTON_PRESS)
     {
-      gint ypt;
-      ypt = (gint) (ypts[i] / max_ypt * win_height / 2);
-      ypt = win_height / 2 - ypt;
-      if (last_ypt < ypt)
-	last_ypt++;
-      else if (last_ypt > ypt)
-	last_ypt--;
-      gdk_draw_line (widget->window, wr_gc, i, last_ypt, i, ypt);
-      last_ypt = ypt;
+      wavrnd_drag_x = -1;
+      wave_view_reset_zoom ();
     }
+  else if (event->type == GDK_BUTTON_PRESS)
+    wavrnd_drag_x = (gint) event->x;
+  return TRUE;
+}
 
-  g_free (ypts);
+/**
+ * Signal handler for the "button_release_event" event sent to
+ * ::wave_render.
+ */
+gboolean
+wavrnd_button_release (GtkWidget * widget, GdkEventButton * event,
+		       gpointer user_data)
+{
+  if (event->button != 1)
+    return FALSE;
+  wavrnd_drag_x = -1;
+  return TRUE;
+}
 
+/**
+ * Signal handler for the "motion_notify_event" event sent to
+ * ::wave_render.
+ *
+ * Dragging moves the waveform along with the pointer.
+ */
+gboolean
+wavrnd_motion_notify (GtkWidget * widget, GdkEventMotion * event,
+		      gpointer user_data)
+{
+  gint x = (gint) event->x;
+  if (wavrnd_drag_x < 0)
+    return FALSE;
+  wave_view_pan (wavrnd_drag_x - x);
+  wavrnd_drag_x = x;
+  return TRUE;
+}
+
+/**
+ * Signal handler for the "scroll_event" event sent to ::wave_render.
+ *
+ * The mouse wheel zooms the time axis around the pointer.  With the
+ * Shift key held down, or with a horizontal wheel, it pans instead.
+ */
+gboolean
+wavrnd_scroll (GtkWidget * widget, GdkEventScroll * event,
+	       gpointer user_data)
+{
+  gint pan_step = MAX (widget->allocation.width / 8, 1);
+  gboolean shift = (event->state & GDK_SHIFT_MASK) != 0;
+  switch (event->direction)
+    {
+    case GDK_SCROLL_UP:
+      if (shift)
+	wave_view_pan (-pan_step);
+      else
+	wave_view_zoom (1, (gint) event->x);
+      break;
+    case GDK_SCROLL_DOWN:
+      if (shift)
+	wave_view_pan (pan_step);
+      else
+	wave_view_zoom (-1, (gint) event->x);
+      break;
+    case GDK_SCROLL_LEFT:
+      wave_view_pan (-pan_step);
+      break;
+    case GDK_SCROLL_RIGHT:
+      wave_view_pan (pan_step);
+      break;
+    default:
+      return FALSE;
+    }
   return TRUE;
 }
 
@@ -319,6 +401,7 @@ activate_action (GtkAction * action)
 	return;
       file_modified = FALSE;
       g_free (loaded_fname); loaded_fname = NULL;
+      autosave_reset ();
       unselect_fund_freq (g_fund_set);
       free_wv_editors ();
       init_wv_editors ();
@@ -333,9 +416,14 @@ activate_action (GtkAction * action)
     }
   else if (!strcmp (name, "Save"))
     {
-      if (loaded_fname != NULL &&
-	  save_sliw_project (loaded_fname))
-	file_modified = FALSE;
+      /* A slider that is being dragged may not have been applied
+	 yet.  */
+      precslid_flush ();
+      if (loaded_fname != NULL)
+	{
+	  project_saver_start (loaded_fname);
+	  file_modified = FALSE;
+	}
       else
 	{
 	  gui_audio_stop ();
@@ -344,12 +432,14 @@ activate_action (GtkAction * action)
     }
   else if (!strcmp (name, "SaveAs"))
     {
+      precslid_flush ();
       gui_audio_stop ();
       save_as ();
     }
   else if (!strcmp (name, "Export"))
     {
       GtkWidget *dialog;
+      precslid_flush ();
       gui_audio_stop ();
       dialog = gtk_file_chooser_dialog_new (_("Export Nyquist File"),
 			     GTK_WINDOW (main_window),
@@ -369,6 +459,65 @@ activate_action (GtkAction * action)
       else
 	gtk_widget_destroy (dialog);
     }
+  else if (!strcmp (name, "Render"))
+    {
+      GtkWidget *dialog;
+      precslid_flush ();
+      dialog = create_render_dialog ((sample_rate != 0) ? sample_rate :
+				     DEFAULT_SAMPLE_RATE);
+      if (last_folder != NULL)
+	gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (dialog),
+					     last_folder);
+      if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
+	{
+	  gchar *filename =
+	    gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+	  double duration = gtk_spin_button_get_value
+	    (GTK_SPIN_BUTTON (lookup_widget (dialog, "duration_spin")));
+	  unsigned rate = (unsigned) gtk_spin_button_get_value_as_int
+	    (GTK_SPIN_BUTTON (lookup_widget (dialog, "rate_spin")));
+	  Sample_Format format = (Sample_Format) gtk_combo_box_get_active
+	    (GTK_COMBO_BOX (lookup_widget (dialog, "format_combo")));
+	  gtk_widget_destroy (dialog);
+	  if (!g_str_has_suffix (filename, ".wav"))
+	    {
+	      gchar *full_name = g_strconcat (filename, ".wav", NULL);
+	      g_free (filename);
+	      filename = full_name;
+	    }
+	  wav_exporter_start (filename, rate,
+			      (guint64) (duration * rate + 0.5), format);
+	  g_free (filename);
+	}
+      else
+	gtk_widget_destroy (dialog);
+    }
+  else if (!strcmp (name, "Undo"))
+    {
+      precslid_flush ();
+      undo_undo ();
+    }
+  else if (!strcmp (name, "Redo"))
+    {
+      precslid_flush ();
+      undo_redo ();
+    }
+  else if (!strcmp (name, "SetOverlays"))
+    wave_view_set_overlays (gtk_toggle_action_get_active
+			    (GTK_TOGGLE_ACTION (action)));
+  else if (!strcmp (name, "ShowScope"))
+    scope_view_show (gtk_toggle_action_get_active
+		     (GTK_TOGGLE_ACTION (action)));
+  else if (!strcmp (name, "ShowSpectrum"))
+    spectrum_view_show (gtk_toggle_action_get_active
+			(GTK_TOGGLE_ACTION (action)));
+  else if (!strcmp (name, "ZoomIn"))
+    wave_view_zoom (ZOOM_STEPS_PER_OCTAVE, wave_render->allocation.width / 2);
+  else if (!strcmp (name, "ZoomOut"))
+    wave_view_zoom (-ZOOM_STEPS_PER_OCTAVE,
+		    wave_render->allocation.width / 2);
+  else if (!strcmp (name, "ZoomAuto"))
+    wave_view_reset_zoom ();
   else if (!strcmp (name, "Preferences"))
     ;
   else if (!strcmp (name, "Quit"))
@@ -447,7 +596,7 @@ cb_fund_set_changed (GtkComboBox * combobox, gpointer user_data)
      automatically.  */
   unsigned fund_set_test;
   fund_set_test = gtk_combo_box_get_active (combobox);
-  if (fund_set_test >= wv_all_freqs->len)
+  if (fund_set_test >= wv_all_freqs->len || fund_set_test == g_fund_set)
     return;
   unselect_fund_freq (g_fund_set);
   g_fund_set = fund_set_test;
@@ -507,24 +656,76 @@ void
 mult_amps_clicked (GtkButton * button, gpointer user_data)
 {
   GtkWidget *dialog = create_mult_amps_dialog ();
+  precslid_flush ();
   if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
     {
       float new_amplitude;
       if (sscanf(mult_dlg_text, "%g", &new_amplitude) > 0)
 	{
 	  file_modified = TRUE;
+	  undo_record (UNDO_ALL_SETS, NULL);
 	  mult_amplitudes (new_amplitude, dialog);
 	}
     }
   gtk_widget_destroy (dialog);
 }
 
+/**
+ * Signal handler for the "Generate Harmonics" button.
+ *
+ * The whole harmonic series of the current fundamental set is
+ * replaced at once, and the user interface is only refreshed once.
+ */
+void
+gen_harmcs_clicked (GtkButton * button, gpointer user_data)
+{
+  GtkWidget *dialog = create_gen_harmcs_dialog ();
+  if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
+    {
+      Harmc_Series series;
+      unsigned count;
+      float rolloff;
+      series = (Harmc_Series) gtk_combo_box_get_active
+	(GTK_COMBO_BOX (lookup_widget (dialog, "series_combo")));
+      count = gtk_spin_button_get_value_as_int
+	(GTK_SPIN_BUTTON (lookup_widget (dialog, "count_spin")));
+      rolloff = gtk_spin_button_get_value
+	(GTK_SPIN_BUTTON (lookup_widget (dialog, "rolloff_spin")));
+      gtk_widget_destroy (dialog);
+
+      file_modified = TRUE;
+      undo_record (g_fund_set, NULL);
+      unselect_fund_freq (g_fund_set);
+      generate_harmonics (g_fund_set, series, count, rolloff);
+      select_fund_freq (g_fund_set);
+      wave_view_changed (FALSE);
+      return;
+    }
+  gtk_widget_destroy (dialog);
+}
+
+/**
+ * Signal handler for when the series is changed in the "Generate
+ * Harmonics" dialog.
+ *
+ * @param user_data the rolloff spin button, which only applies to
+ * exponential rolloff
+ */
+void
+gen_series_changed (GtkComboBox * combobox, gpointer user_data)
+{
+  gtk_widget_set_sensitive (GTK_WIDGET (user_data),
+			    gtk_combo_box_get_active (combobox) ==
+			    HARMC_SERIES_EXPONENTIAL);
+}
+
 void
 fundset_add_clicked (GtkButton * button, gpointer user_data)
 {
   unsigned new_fund;
   Wv_Data *second_harmonic;
   file_modified = TRUE;
+  undo_record (UNDO_SET_LIST, NULL);
   add_fund_freq ();
   new_fund = wv_all_freqs->len - 1;
   add_harmonic (new_fund);
@@ -536,26 +737,36 @@ fundset_add_clicked (GtkButton * button, gpointer user_data)
   select_fund_freq (g_fund_set);
   /* Add a combo box entry.  */
   {
-    unsigned cur_fund;
+    GtkListStore *store;
+    GtkTreeIter iter;
     gchar cb_text[11];
-    cur_fund = wv_all_freqs->len;
-    sprintf (cb_text, "%u", cur_fund);
-    gtk_combo_box_append_text (GTK_COMBO_BOX (cb_fund_set), cb_text);
+    store = GTK_LIST_STORE
+      (gtk_combo_box_get_model (GTK_COMBO_BOX (cb_fund_set)));
+    sprintf (cb_text, "%u", wv_all_freqs->len);
+    gtk_list_store_insert_with_values (store, &iter, -1, 0, cb_text, -1);
     gtk_combo_box_set_active (GTK_COMBO_BOX (cb_fund_set), new_fund);
   }
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 void
 fundset_remove_clicked (GtkButton * button, gpointer user_data)
 {
   file_modified = TRUE;
+  undo_record (UNDO_SET_LIST, NULL);
   unselect_fund_freq (g_fund_set);
   remove_fund_freq (g_fund_set);
   /* Always remove the last label so that there are not any numerical
      jumps which don't actually exist in the internal data.  */
-  gtk_combo_box_remove_text (GTK_COMBO_BOX (cb_fund_set), wv_all_freqs->len);
+  {
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    model = gtk_combo_box_get_model (GTK_COMBO_BOX (cb_fund_set));
+    if (gtk_tree_model_iter_nth_child (model, &iter, NULL,
+				       wv_all_freqs->len))
+      gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+  }
   if (g_fund_set > 0)
     g_fund_set--;
   else
@@ -563,7 +774,7 @@ fundset_remove_clicked (GtkButton * button, gpointer user_data)
   select_fund_freq (g_fund_set);
   gtk_combo_box_set_active (GTK_COMBO_BOX (cb_fund_set), g_fund_set);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -575,14 +786,16 @@ fundset_remove_clicked (GtkButton * button, gpointer user_data)
 void
 fndfrq_mntisa_activate (GtkEntry * entry, gpointer user_data)
 {
-  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].fund_editor;
+  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   wv_all_freqs->d[g_fund_set].fund_freq =
     sci_notation_get_value (entry, GTK_SPIN_BUTTON (cur_data->fndfrq_exp));
 
   update_slider_bases (entry, cur_data, TRUE);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -610,12 +823,14 @@ fndfrq_mntisa_focus_out (GtkEntry * entry,
 void
 fndfrq_exp_value_changed (GtkSpinButton * spinbutton, gpointer user_data)
 {
-  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].fund_editor;
+  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   wv_all_freqs->d[g_fund_set].fund_freq =
     sci_notation_get_value (GTK_ENTRY (cur_data->fndfrq_mntisa), spinbutton);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -628,14 +843,16 @@ fndfrq_exp_value_changed (GtkSpinButton * spinbutton, gpointer user_data)
 void
 fndamp_mntisa_activate (GtkEntry * entry, gpointer user_data)
 {
-  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].fund_editor;
+  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   wv_all_freqs->d[g_fund_set].amplitude =
     sci_notation_get_value (entry, GTK_SPIN_BUTTON (cur_data->amp_exp));
 
   update_slider_bases (entry, cur_data, FALSE);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -663,25 +880,32 @@ fndamp_mntisa_focus_out (GtkEntry * entry,
 void
 fndamp_exp_value_changed (GtkSpinButton * spinbutton, gpointer user_data)
 {
-  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].fund_editor;
+  Wv_Editor_Data *cur_data = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   wv_all_freqs->d[g_fund_set].amplitude =
     sci_notation_get_value (GTK_ENTRY (cur_data->amp_mntisa), spinbutton);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
  * Signal handler called when the selected harmonic is changed.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 harmc_sel_changed (GtkComboBox * combobox, gpointer user_data)
 {
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
   gint new_sel = gtk_combo_box_get_active (combobox);
+  precslid_flush ();
+  /* The selected harmonic might have just been removed from the
+     shared model.  */
+  if (new_sel < 0)
+    return;
   cur_editor->data = &wv_all_freqs->d[g_fund_set].harmonics->d[new_sel];
 
   sci_notation_set_values (GTK_ENTRY (cur_editor->amp_mntisa),
@@ -693,75 +917,47 @@ harmc_sel_changed (GtkComboBox * combobox, gpointer user_data)
  * Signal handler called when the add harmonic button is clicked.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 harmc_add_clicked (GtkButton * button, gpointer user_data)
 {
   Wv_Editor_Data *cur_data = (Wv_Editor_Data *) user_data;
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
+  /* The new harmonic shows up in every combo box since they all
+     share one model.  */
   add_harmonic (g_fund_set);
-  {
-    gchar cb_text[11];
-    unsigned i;
-    unsigned num_harmcs;
-    num_harmcs = wv_all_freqs->d[g_fund_set].harmonics->len;
-    sprintf (cb_text, "%u",
-	wv_all_freqs->d[g_fund_set].harmonics->d[num_harmcs-1].harmc_num);
-    for (i = 0; i < wv_all_freqs->d[g_fund_set].wv_editors->len; i++)
-      {
-	gtk_combo_box_append_text (GTK_COMBO_BOX
-	   (wv_all_freqs->d[g_fund_set].wv_editors->d[i]->harmc_sel), cb_text);
-      }
-    gtk_combo_box_set_active (GTK_COMBO_BOX (cur_data->harmc_sel),
-			      wv_all_freqs->d[g_fund_set].harmonics->len - 1);
-  }
+  gtk_combo_box_set_active (GTK_COMBO_BOX (cur_data->harmc_sel),
+			    wv_all_freqs->d[g_fund_set].harmonics->len - 1);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
  * Signal handler called when the remove harmonic button is clicked.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 harmc_remove_clicked (GtkButton * button, gpointer user_data)
 {
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
   unsigned harmc_idx = cur_editor->data->group_idx;
-  unsigned swap_idx;
-  unsigned i;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
 
-  if (harmc_idx > 0)
-    swap_idx = harmc_idx - 1;
-  else
-    swap_idx = 0;
-
-  /* Note: The following if clause was added to fix a bug with memory
-     reallocation corruption (MinGW GCC 3.4.5 and GTK+ 2.10.11.0).  I
-     do not quite understand the predicament, but this following
-     construct should be cleaned up once the reason is understood.  */
-  if (wv_all_freqs->d[g_fund_set].harmonics->len != 1)
-    {
-      for (i = 0; i < wv_all_freqs->d[g_fund_set].wv_editors->len; i++)
-	{
-	  Wv_Editor_Data *iter_editor;
-	  Wv_Data *iter_data;
-	  iter_editor = wv_all_freqs->d[g_fund_set].wv_editors->d[i];
-	  iter_data = iter_editor->data;
-	  gtk_combo_box_remove_text (GTK_COMBO_BOX
-				     (iter_editor->harmc_sel), harmc_idx);
-	  if (iter_data->group_idx == harmc_idx)
-	    gtk_combo_box_set_active (GTK_COMBO_BOX (iter_editor->harmc_sel),
-				      swap_idx);
-	}
-    }
+  /* remove_harmonic() moves the windows viewing the removed harmonic
+     to a neighboring one, so only the bound views need updating.  */
   remove_harmonic (g_fund_set, harmc_idx);
+  if (wv_all_freqs->d[g_fund_set].ui->wv_editors->len == 0)
+    editor_strip_update ();
+  else
+    editor_strip_refresh ();
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -769,7 +965,7 @@ harmc_remove_clicked (GtkButton * button, gpointer user_data)
  * clicked.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 harmc_win_add_clicked (GtkButton * button, gpointer user_data)
@@ -777,23 +973,10 @@ harmc_win_add_clicked (GtkButton * button, gpointer user_data)
   /* Add the new editor after the current editor.  */
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
   unsigned new_ed_idx = cur_editor->index + 1;
-  GtkWidget *new_widget;
 
   add_wv_editor (g_fund_set, new_ed_idx, cur_editor->data);
-  wv_all_freqs->d[g_fund_set].wv_editors->d[new_ed_idx]->widget =
-    create_wvedit_holder (FALSE, new_ed_idx);
-  new_widget = wv_all_freqs->d[g_fund_set].wv_editors->d[new_ed_idx]->widget;
-  gtk_box_pack_start (GTK_BOX (wave_edit_cntr), new_widget, FALSE, FALSE, 0);
-  /* We must not let the reordered child to go before the fundamental
-     editor, so we add one to the index.  */
-  gtk_box_reorder_child (GTK_BOX (wave_edit_cntr), new_widget,
-			 new_ed_idx + 1);
-
-  if (wv_all_freqs->d[g_fund_set].wv_editors->len == 2)
-    {
-      gtk_widget_set_sensitive ((wv_all_freqs->d[g_fund_set].wv_editors->d[0]->
-				 harmc_win_rm_btn), TRUE);
-    }
+  /* This also updates the sensitivity of the remove buttons.  */
+  editor_strip_update ();
 }
 
 /**
@@ -801,44 +984,42 @@ harmc_win_add_clicked (GtkButton * button, gpointer user_data)
  * clicked.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 harmc_win_remove_clicked (GtkButton * button, gpointer user_data)
 {
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
   remove_wv_editor (g_fund_set, cur_editor->index);
-  if (wv_all_freqs->d[g_fund_set].wv_editors->len == 1)
-    {
-      gtk_widget_set_sensitive ((wv_all_freqs->d[g_fund_set].wv_editors->d[0]->
-				 harmc_win_rm_btn), FALSE);
-    }
+  editor_strip_update ();
 }
 
 /**
  * Updates the value of a harmonic's amplitude.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 amp_mntisa_activate (GtkEntry * entry, gpointer user_data)
 {
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   cur_editor->data->amplitude =
     sci_notation_get_value (entry, GTK_SPIN_BUTTON (cur_editor->amp_exp));
 
   update_slider_bases (entry, cur_editor, FALSE);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
  * Updates the value of a harmonic's amplitude.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 gboolean
 amp_mntisa_focus_out (GtkEntry * entry,
@@ -852,17 +1033,19 @@ amp_mntisa_focus_out (GtkEntry * entry,
  * Updates the value of a harmonic's amplitude.
  *
  * @param user_data pointer to the parent wave editor window structure
- * within <code>wv_all_freqs->d[g_fund_set].wv_editors</code>
+ * within <code>wv_all_freqs->d[g_fund_set].ui->wv_editors</code>
  */
 void
 amp_exp_value_changed (GtkSpinButton * spinbutton, gpointer user_data)
 {
   Wv_Editor_Data *cur_editor = (Wv_Editor_Data *) user_data;
+  precslid_flush ();
   file_modified = TRUE;
+  undo_record (g_fund_set, NULL);
   cur_editor->data->amplitude =
     sci_notation_get_value (GTK_ENTRY (cur_editor->amp_mntisa), spinbutton);
 
-  gtk_widget_queue_draw (wave_render);
+  wave_view_changed (FALSE);
 }
 
 /**
@@ -910,8 +1093,10 @@ sci_notation_set_values (GtkEntry * mntisa_widget,
   gtk_entry_set_text (mntisa_widget, sci_string);
 
   /* Make sure not to accidentally change the file modification state
-     when doing this.  */
+     or record an edit when doing this.  */
+  undo_freeze ();
   gtk_spin_button_set_value (exp_widget, (gdouble) exp_num);
+  undo_thaw ();
   file_modified = last_mod_state;
 }
 
@@ -930,15 +1115,15 @@ precslid_add_clicked (GtkButton * button, gpointer user_data)
 
   if (fund_editor)
     {
-      cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
-      if (index == 0 && cur_editor->freq_sliders->len == 2)
+      cur_editor = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+      if (index == 0 && cur_editor->freq_sliders.len == 2)
 	gtk_widget_set_sensitive (cur_editor->freq_slid_rm_btn, TRUE);
       else if (index == 0)
 	return;
     }
   else
-    cur_editor = wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-  if (cur_editor->amp_sliders->len == 2)
+    cur_editor = wv_all_freqs->d[g_fund_set].ui->wv_editors->d[index];
+  if (cur_editor->amp_sliders.len == 2)
     gtk_widget_set_sensitive (cur_editor->amp_slid_rm_btn, TRUE);
 }
 
@@ -957,54 +1142,75 @@ precslid_remove_clicked (GtkButton * button, gpointer user_data)
 
   if (fund_editor)
     {
-      cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
-      if (index == 0 && cur_editor->freq_sliders->len == 1)
+      cur_editor = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+      if (index == 0 && cur_editor->freq_sliders.len == 1)
 	gtk_widget_set_sensitive (cur_editor->freq_slid_rm_btn, FALSE);
       else if (index == 0)
 	return;
     }
   else
-    cur_editor = wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-  if (cur_editor->amp_sliders->len == 1)
+    cur_editor = wv_all_freqs->d[g_fund_set].ui->wv_editors->d[index];
+  if (cur_editor->amp_sliders.len == 1)
     gtk_widget_set_sensitive (cur_editor->amp_slid_rm_btn, FALSE);
 }
 
+/** Slider whose latest value has not been applied to the data model
+    yet.  */
+static Slide_Data *pending_slider = NULL;
+static guint pending_apply_source = 0;
+/** Mantissa entry whose text has not been updated yet.  */
+static GtkEntry *pending_entry = NULL;
+/** Mantissa to show in ::pending_entry.  */
+static gdouble pending_mntisa;
+static guint pending_text_source = 0;
+
 /**
- * Signal handler called when a slider in a precision slider group is
- * changed.
- * @param user_data a pointer to the Slide_Data structure
+ * Shows the mantissa computed by the last applied slider motion.
  */
-void
-precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data)
+static gboolean
+slider_text_idle (gpointer data)
+{
+  gchar *new_mntisa;
+  pending_text_source = 0;
+  /* The sliders should primarily change the mantissa in the display
+     rather than change the direct floating point value.  */
+  new_mntisa = g_strdup_printf ("%f", pending_mntisa);
+  gtk_entry_set_text (pending_entry, new_mntisa);
+  g_free (new_mntisa);
+  pending_entry = NULL;
+  return FALSE;
+}
+
+/**
+ * Applies a precision slider's value to the data model.
+ *
+ * The new value is computed numerically from the slider values, and
+ * the mantissa entry is only updated later from an idle callback,
+ * since laying out its text is much slower than the computation.
+ */
+static void
+apply_slider_motion (Slide_Data * cur_slider)
 {
-  Slide_Data *cur_slider;
-  gdouble new_value;
-  gdouble value_mult;
   Wv_Editor_Data *cur_editor;
-  Slide_Data_Ptr_array *slider_array;
+  Slide_Data_List *slider_array;
   GtkWidget *cur_mntisa;
   GtkWidget *cur_exp;
-  float sci_value;
+  gdouble sci_value;
   float store_value; /* Value to store in whatever is actually being
 			modified */
-  file_modified = TRUE;
-
-  cur_slider = (Slide_Data *) user_data;
-  new_value = gtk_range_get_value (GTK_RANGE (cur_slider->widget));
-  cur_slider->last_value = new_value;
 
   if (cur_slider->fund_assoc)
     {
-      cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
+      cur_editor = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
       if (cur_slider->parent_index == 0)
 	{
-	  slider_array = cur_editor->freq_sliders;
+	  slider_array = &cur_editor->freq_sliders;
 	  cur_mntisa = cur_editor->fndfrq_mntisa;
 	  cur_exp = cur_editor->fndfrq_exp;
 	}
       else
 	{
-	  slider_array = cur_editor->amp_sliders;
+	  slider_array = &cur_editor->amp_sliders;
 	  cur_mntisa = cur_editor->amp_mntisa;
 	  cur_exp = cur_editor->amp_exp;
 	}
@@ -1013,8 +1219,8 @@ precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data)
     {
       unsigned index = cur_slider->parent_index;
       cur_editor =
-	wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-      slider_array = cur_editor->amp_sliders;
+	wv_all_freqs->d[g_fund_set].ui->wv_editors->d[index];
+      slider_array = &cur_editor->amp_sliders;
       cur_mntisa = cur_editor->amp_mntisa;
       cur_exp = cur_editor->amp_exp;
     }
@@ -1024,42 +1230,24 @@ precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data)
      rather than a delta formula to prevent unusual scroll-bar
      behavior.  */
   {
-    float next_base = cur_slider->base;
+    gdouble next_base = cur_slider->base;
     unsigned i;
     for (i = cur_slider->index; i < slider_array->len; i++)
       {
 	Slide_Data *iter_slider = slider_array->d[i];
-	/* Note that the base of the exponent calculation below should
-	   be user configurable or calculated from the length of the
-	   scroll bars.  Note that this formula is copied throughout
-	   the program rather than only having a single defintion.  */
-	gdouble value_mult = pow(100, -((gdouble) i));
 	iter_slider->base = next_base;
-	next_base = next_base + iter_slider->last_value * value_mult;
+	next_base = next_base +
+	  iter_slider->last_value * iter_slider->value_mult;
       }
     sci_value = next_base;
   }
 
-  {
-    /* The sliders should primarily change the mantissa in the display
-       rather than change the direct floating point value.  */
-
-    /* Never allocate "big data" on the stack.  That includes "fixed
-       length" strings.  Okay, never say never... on modern computers,
-       strings are considered small.  */
-    gchar *new_mntisa = (gchar *) g_malloc (140);
-    sprintf (new_mntisa, "%f", sci_value);
-    gtk_entry_set_text (GTK_ENTRY (cur_mntisa), new_mntisa);
-    g_free (new_mntisa);
-
-    store_value =
-      sci_notation_get_value (GTK_ENTRY (cur_mntisa),
-			      GTK_SPIN_BUTTON (cur_exp));
-  }
-
+  store_value = sci_value *
+    pow (10, gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (cur_exp)));
+  /* A whole drag of the slider is undone at once.  */
+  undo_record (g_fund_set, cur_slider);
   if (cur_slider->fund_assoc)
     {
-      cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
       if (cur_slider->parent_index == 0)
 	  wv_all_freqs->d[g_fund_set].fund_freq = store_value;
       else
@@ -1070,7 +1258,77 @@ precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data)
       cur_editor->data->amplitude = store_value;
     }
 
-  gtk_widget_queue_draw (wave_render);
+  if (pending_entry != NULL && pending_entry != GTK_ENTRY (cur_mntisa))
+    {
+      g_source_remove (pending_text_source);
+      slider_text_idle (NULL);
+    }
+  pending_entry = GTK_ENTRY (cur_mntisa);
+  pending_mntisa = sci_value;
+  if (pending_text_source == 0)
+    pending_text_source = g_idle_add (slider_text_idle, NULL);
+
+  wave_view_changed (TRUE);
+}
+
+/**
+ * Applies the latest value of the slider that was moved.
+ */
+static gboolean
+slider_apply_idle (gpointer data)
+{
+  Slide_Data *cur_slider = pending_slider;
+  pending_apply_source = 0;
+  pending_slider = NULL;
+  apply_slider_motion (cur_slider);
+  return FALSE;
+}
+
+/**
+ * Finishes any precision slider motion that has not been applied yet.
+ *
+ * This must be called before anything reads the mantissa entries or
+ * the values the sliders edit, and before any slider or mantissa
+ * entry is destroyed or rebound.
+ */
+void
+precslid_flush (void)
+{
+  if (pending_apply_source != 0)
+    {
+      g_source_remove (pending_apply_source);
+      slider_apply_idle (NULL);
+    }
+  if (pending_text_source != 0)
+    {
+      g_source_remove (pending_text_source);
+      slider_text_idle (NULL);
+    }
+}
+
+/**
+ * Signal handler called when a slider in a precision slider group is
+ * changed.
+ *
+ * While a slider is being dragged, many motion events can arrive
+ * between two frames.  Only the slider's value is recorded here, and
+ * the latest value is applied once per frame from an idle callback
+ * that runs before GTK+ redraws anything.
+ * @param user_data a pointer to the Slide_Data structure
+ */
+void
+precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data)
+{
+  Slide_Data *cur_slider = (Slide_Data *) user_data;
+  file_modified = TRUE;
+  cur_slider->last_value = gtk_range_get_value (GTK_RANGE (scrollbar));
+
+  if (pending_slider != NULL && pending_slider != cur_slider)
+    apply_slider_motion (pending_slider);
+  pending_slider = cur_slider;
+  if (pending_apply_source == 0)
+    pending_apply_source = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
+					    slider_apply_idle, NULL, NULL);
 }
 
 /**
@@ -1107,12 +1365,11 @@ void
 update_slider_bases (GtkEntry * entry, Wv_Editor_Data * cur_data,
 		     gboolean freq_sliders)
 {
-  Slide_Data_Ptr_array *sliders = ((freq_sliders) ? cur_data->freq_sliders :
-				   cur_data->amp_sliders);
+  Slide_Data_List *sliders = ((freq_sliders) ? &cur_data->freq_sliders :
+			       &cur_data->amp_sliders);
   Slide_Data *last_slider = sliders->d[sliders->len-1];
-  gdouble value_mult = pow(100, -((gdouble) last_slider->index));
   float last_mntisa = (last_slider->base +
-		       last_slider->last_value * value_mult);
+		       last_slider->last_value * last_slider->value_mult);
   float cur_mntisa;
   float mntisa_diff;
   unsigned i;
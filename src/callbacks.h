@@ -48,9 +48,9 @@ DAMAGE.  */
 
 #include "wv_editors.h"
 
+extern gboolean file_modified;
 extern gchar *last_folder;
 extern gchar *loaded_fname;
-extern float max_ypt;
 
 void manual_win_destroy (GtkObject * object, gpointer user_data);
 gboolean check_save (gboolean closing);
@@ -61,6 +61,18 @@ void activate_action (GtkAction * action);
 gboolean
 wavrnd_expose (GtkWidget * widget,
 	       GdkEventExpose * event, gpointer user_data);
+gboolean
+wavrnd_button_press (GtkWidget * widget,
+		     GdkEventButton * event, gpointer user_data);
+gboolean
+wavrnd_button_release (GtkWidget * widget,
+		       GdkEventButton * event, gpointer user_data);
+gboolean
+wavrnd_motion_notify (GtkWidget * widget,
+		      GdkEventMotion * event, gpointer user_data);
+gboolean
+wavrnd_scroll (GtkWidget * widget,
+	       GdkEventScroll * event, gpointer user_data);
 void b_save_as_clicked (GtkButton * button, gpointer user_data);
 void b_play_clicked (GtkButton * button, gpointer user_data);
 void agc_vol_changed (GtkRange * range, gpointer user_data);
@@ -102,6 +114,9 @@ void sci_notation_set_values (GtkEntry * mntisa_widget,
 void precslid_add_clicked (GtkButton * button, gpointer user_data);
 void precslid_remove_clicked (GtkButton * button, gpointer user_data);
 void precslid_value_changed (GtkHScrollbar * scrollbar, gpointer user_data);
+void precslid_flush (void);
+void gen_harmcs_clicked (GtkButton * button, gpointer user_data);
+void gen_series_changed (GtkComboBox * combobox, gpointer user_data);
 void mult_amp_entry_activate (GtkEntry * entry, gpointer user_data);
 gboolean mult_amp_entry_focus_out (GtkEntry * entry,
 				   GdkEventFocus * event, gpointer user_data);
@@ -0,0 +1,528 @@
+/* Rendering audio without a sound device.
+
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Rendering audio without a sound device.
+ *
+ * Unlike playback, which keeps a running phase for every fundamental
+ * set, every sample here is computed from its absolute sample index.
+ * That makes each sample independent of the ones before it, so a long
+ * stretch of time can be split into chunks, and each chunk into
+ * tiles, that are rendered in parallel and still come out exactly as
+ * a serial render would.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#  include <io.h>
+#endif
+
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
+
+#include "slidercore.h"
+#include "tile_pool.h"
+
+/** Number of samples that write_wav_file() renders at once.  This
+    bounds its memory use while leaving enough tiles to keep every
+    processor busy.  */
+#define RENDER_CHUNK (TILE_SIZE * 16)
+
+/** Number of samples that stream_audio() renders at once when it
+    paces itself to real time, which is short enough that the output
+    does not come in bursts.  */
+#define STREAM_CHUNK (TILE_SIZE * 2)
+
+/** Size of the header that write_wav_file() writes for PCM
+    samples.  */
+#define WAV_PCM_HEADER_SIZE 44
+/** Size of the header that write_wav_file() writes for float
+    samples, which adds a @c cbSize field and a @c fact chunk.  */
+#define WAV_FLOAT_HEADER_SIZE 58
+
+/** WAVE format tags.  */
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+
+/** Names of the sample formats, as used on the command line.  */
+const char *const sample_format_names[SAMPLE_FORMAT_COUNT] = {
+  "f32le", "s16le", "s24le"
+};
+
+/**
+ * Finds a sample format by name.
+ *
+ * @param name the name, which is one of ::sample_format_names
+ * @param format where to store the format
+ * @return TRUE if @a name was found, FALSE otherwise
+ */
+gboolean
+sample_format_from_name (const char * name, Sample_Format * format)
+{
+  unsigned i;
+  for (i = 0; i < SAMPLE_FORMAT_COUNT; i++)
+    {
+      if (!strcmp (name, sample_format_names[i]))
+	{
+	  *format = (Sample_Format) i;
+	  return TRUE;
+	}
+    }
+  return FALSE;
+}
+
+/**
+ * Returns the size in bytes of one sample in the given format.
+ */
+unsigned
+sample_format_size (Sample_Format format)
+{
+  switch (format)
+    {
+    case SAMPLE_FORMAT_S16:
+      return 2;
+    case SAMPLE_FORMAT_S24:
+      return 3;
+    default:
+      return 4;
+    }
+}
+
+/** Shared state for rendering the tiles of a range of samples.  */
+typedef struct _Sample_Job Sample_Job;
+struct _Sample_Job
+{
+  const Wv_Fund_Freq_array *model;
+  float *out;
+  guint64 first_sample;
+  unsigned rate;
+};
+
+static void
+render_sample_tile (unsigned start, unsigned end, unsigned tile_idx,
+		    gpointer data)
+{
+  Sample_Job *job = (Sample_Job *) data;
+  const Wv_Fund_Freq_array *model = job->model;
+  unsigned i;
+  unsigned j;
+
+  for (i = start; i < end; i++)
+    job->out[i] = 0.0;
+
+  for (j = 0; j < model->len; j++)
+    {
+      const Wv_Fund_Freq *cur_fund = &model->d[j];
+      const Wv_Data *harmonics = cur_fund->harmonics->d;
+      unsigned num_harmonics = cur_fund->harmonics->len;
+      double cycles_per_sample = (double) cur_fund->fund_freq / job->rate;
+      for (i = start; i < end; i++)
+	{
+	  /* Only the position within the current cycle matters, and
+	     taking it in double precision keeps the phase exact for
+	     hours of audio.  */
+	  double cycles = (double) (job->first_sample + i) *
+	    cycles_per_sample;
+	  double phase = cycles - floor (cycles);
+	  float ypt = sinf ((float) (phase * 2 * G_PI)) *
+	    cur_fund->amplitude;
+	  unsigned k;
+	  for (k = 0; k < num_harmonics; k++)
+	    {
+	      double harmc_phase = phase * harmonics[k].harmc_num;
+	      harmc_phase -= floor (harmc_phase);
+	      ypt += sinf ((float) (harmc_phase * 2 * G_PI)) *
+		harmonics[k].amplitude;
+	    }
+	  job->out[i] += ypt;
+	}
+    }
+}
+
+/**
+ * Renders a range of samples of a project as it sounds when played.
+ *
+ * The samples are rendered in tiles on the tile pool.  Every sample
+ * only depends on its index, so rendering a range in pieces gives the
+ * same result as rendering it at once.
+ * @param model the project to render, which must not change
+ * meanwhile
+ * @param out the array that will hold the samples, which must be
+ * sufficiently allocated
+ * @param first_sample the index of the first sample, counted from the
+ * start of the sound at phase zero
+ * @param num_samples the number of samples to render
+ * @param rate the sample rate in Hertz
+ */
+void
+render_samples (const Wv_Fund_Freq_array * model, float * out,
+		guint64 first_sample, unsigned num_samples, unsigned rate)
+{
+  Sample_Job job;
+  job.model = model;
+  job.out = out;
+  job.first_sample = first_sample;
+  job.rate = rate;
+  tile_pool_run (num_samples, render_sample_tile, &job);
+}
+
+/**
+ * Normalizes rendered samples and clips them near the desired
+ * maximum amplitude, as is done for playback.
+ *
+ * @param samples the samples to change in place
+ * @param num_samples the number of samples
+ * @param volume the desired maximum amplitude, such as ::agc_volume
+ * @param peak the displacement that is scaled to @a volume, such as
+ * ::max_ypt.  If it is zero, the result is silence.
+ */
+void
+apply_agc (float * samples, unsigned num_samples, float volume, float peak)
+{
+  float gain = (peak > 0) ? volume / peak : 0;
+  float clip_volume = volume * 1.25;
+  unsigned i;
+  for (i = 0; i < num_samples; i++)
+    {
+      samples[i] *= gain;
+      samples[i] = ((samples[i] > 0) ?
+		    MIN (samples[i], clip_volume) :
+		    MAX (samples[i], -clip_volume));
+    }
+}
+
+/**
+ * Converts samples to a sample format.
+ *
+ * Integer samples are clipped to full scale and rounded to the
+ * nearest value.
+ * @param dest where to store the converted samples, which must hold
+ * @a num_samples times sample_format_size() bytes
+ * @param samples the samples to convert
+ * @param num_samples the number of samples
+ * @param format the format to convert to
+ */
+void
+encode_samples (guint8 * dest, const float * samples, unsigned num_samples,
+		Sample_Format format)
+{
+  unsigned i;
+  switch (format)
+    {
+    case SAMPLE_FORMAT_F32:
+      for (i = 0; i < num_samples; i++)
+	{
+	  guint32 bits;
+	  memcpy (&bits, &samples[i], 4);
+	  bits = GUINT32_TO_LE (bits);
+	  memcpy (dest + 4 * i, &bits, 4);
+	}
+      break;
+    case SAMPLE_FORMAT_S16:
+      for (i = 0; i < num_samples; i++)
+	{
+	  float value = CLAMP (samples[i], -1.0f, 1.0f);
+	  gint16 level = (gint16) floor (value * 32767 + 0.5);
+	  dest[2*i] = (guint8) (level & 0xff);
+	  dest[2*i+1] = (guint8) ((level >> 8) & 0xff);
+	}
+      break;
+    case SAMPLE_FORMAT_S24:
+      for (i = 0; i < num_samples; i++)
+	{
+	  float value = CLAMP (samples[i], -1.0f, 1.0f);
+	  gint32 level = (gint32) floor (value * 8388607 + 0.5);
+	  dest[3*i] = (guint8) (level & 0xff);
+	  dest[3*i+1] = (guint8) ((level >> 8) & 0xff);
+	  dest[3*i+2] = (guint8) ((level >> 16) & 0xff);
+	}
+      break;
+    default:
+      break;
+    }
+}
+
+/**
+ * Renders a range of samples, normalizes them, and converts them to a
+ * sample format, using buffers that the caller allocated once.
+ *
+ * @param samples scratch space for @a num_samples floats
+ * @param dest where to store the converted samples
+ * @return the number of bytes stored in @a dest
+ */
+static gsize
+render_encoded (const Wv_Fund_Freq_array * model, float * samples,
+		guint8 * dest, guint64 first_sample, unsigned num_samples,
+		unsigned rate, Sample_Format format, float volume,
+		float peak)
+{
+  render_samples (model, samples, first_sample, num_samples, rate);
+  apply_agc (samples, num_samples, volume, peak);
+  encode_samples (dest, samples, num_samples, format);
+  return (gsize) num_samples * sample_format_size (format);
+}
+
+/** Stores a 16-bit little-endian number.  */
+static void
+put_le16 (guint8 * dest, guint16 value)
+{
+  dest[0] = (guint8) (value & 0xff);
+  dest[1] = (guint8) (value >> 8);
+}
+
+/** Stores a 32-bit little-endian number.  */
+static void
+put_le32 (guint8 * dest, guint32 value)
+{
+  put_le16 (dest, (guint16) (value & 0xffff));
+  put_le16 (dest + 2, (guint16) (value >> 16));
+}
+
+/**
+ * Formats the header of a mono WAVE file.
+ *
+ * @param dest where to store the header, which must hold
+ * ::WAV_FLOAT_HEADER_SIZE bytes
+ * @param rate the sample rate in Hertz
+ * @param num_samples the number of samples in the file
+ * @param format the sample format
+ * @param pad_size the number of pad bytes after the samples
+ * @return the size of the header
+ */
+static unsigned
+format_wav_header (guint8 * dest, unsigned rate, guint32 num_samples,
+		   Sample_Format format, unsigned pad_size)
+{
+  unsigned sample_size = sample_format_size (format);
+  guint32 data_size = num_samples * sample_size;
+  gboolean is_float = (format == SAMPLE_FORMAT_F32);
+  unsigned header_size = is_float ? WAV_FLOAT_HEADER_SIZE :
+    WAV_PCM_HEADER_SIZE;
+  guint8 *pos;
+
+  memcpy (dest, "RIFF", 4);
+  put_le32 (dest + 4, header_size - 8 + data_size + pad_size);
+  memcpy (dest + 8, "WAVEfmt ", 8);
+  put_le32 (dest + 16, is_float ? 18 : 16);
+  put_le16 (dest + 20, is_float ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+  put_le16 (dest + 22, 1); /* Channels */
+  put_le32 (dest + 24, rate);
+  put_le32 (dest + 28, rate * sample_size); /* Bytes per second */
+  put_le16 (dest + 32, sample_size); /* Block alignment */
+  put_le16 (dest + 34, sample_size * 8); /* Bits per sample */
+  pos = dest + 36;
+  if (is_float)
+    {
+      put_le16 (pos, 0); /* No extension of the format */
+      memcpy (pos + 2, "fact", 4);
+      put_le32 (pos + 6, 4);
+      put_le32 (pos + 10, num_samples);
+      pos += 14;
+    }
+  memcpy (pos, "data", 4);
+  put_le32 (pos + 4, data_size);
+  return header_size;
+}
+
+/**
+ * Renders a project to a mono WAVE file.
+ *
+ * The audio is rendered a chunk at a time with render_samples(),
+ * normalized with apply_agc(), and written out in order, so memory
+ * use does not depend on the length of the file.  The file starts at
+ * phase zero.
+ * @param model the project to render, which must not change
+ * meanwhile
+ * @param filename the file to write
+ * @param rate the sample rate in Hertz
+ * @param num_samples the number of samples to render
+ * @param format the sample format of the file
+ * @param volume the desired maximum amplitude, as for apply_agc()
+ * @param peak the displacement that is scaled to @a volume
+ * @param progress function to call from time to time, or NULL
+ * @param user_data data to pass to @a progress
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the file could not be written or would be too large for the WAVE
+ * format, or ::CORE_ERROR_CANCELLED if @a progress asked to stop.  On
+ * failure, the partly written file is removed.
+ */
+Core_Error
+write_wav_file (const Wv_Fund_Freq_array * model, const char * filename,
+		unsigned rate, guint64 num_samples, Sample_Format format,
+		float volume, float peak, Core_Progress_Func progress,
+		gpointer user_data)
+{
+  unsigned sample_size = sample_format_size (format);
+  unsigned pad_size = (unsigned) ((num_samples * sample_size) & 1);
+  guint8 header[WAV_FLOAT_HEADER_SIZE];
+  unsigned header_size;
+  float *samples;
+  guint8 *encoded;
+  guint64 done = 0;
+  Core_Error error = CORE_OK;
+  int saved_errno;
+  int fd;
+
+  /* The sizes in a WAVE file are 32 bits.  */
+  if (num_samples * sample_size + pad_size >
+      G_MAXUINT32 - WAV_FLOAT_HEADER_SIZE)
+    {
+      errno = EFBIG;
+      return CORE_ERROR_IO;
+    }
+
+  fd = g_open (filename, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  if (fd == -1)
+    return CORE_ERROR_IO;
+  header_size = format_wav_header (header, rate, (guint32) num_samples,
+				   format, pad_size);
+  if (!write_all (fd, (const gchar *) header, header_size))
+    error = CORE_ERROR_IO;
+
+  samples = (float *) g_malloc (sizeof (float) * RENDER_CHUNK);
+  /* One more byte for the pad byte.  */
+  encoded = (guint8 *) g_malloc (sample_size * RENDER_CHUNK + 1);
+  while (error == CORE_OK && done < num_samples)
+    {
+      unsigned count = (unsigned) MIN (num_samples - done, RENDER_CHUNK);
+      gsize length = render_encoded (model, samples, encoded, done, count,
+				     rate, format, volume, peak);
+      done += count;
+      if (done == num_samples && pad_size != 0)
+	encoded[length++] = 0;
+      if (!write_all (fd, (const gchar *) encoded, length))
+	error = CORE_ERROR_IO;
+      else if (progress != NULL &&
+	       !progress ((double) done / num_samples, user_data))
+	error = CORE_ERROR_CANCELLED;
+    }
+  g_free (encoded);
+  g_free (samples);
+
+  saved_errno = errno;
+  if (close (fd) != 0 && error == CORE_OK)
+    {
+      error = CORE_ERROR_IO;
+      saved_errno = errno;
+    }
+  if (error != CORE_OK)
+    g_unlink (filename);
+  errno = saved_errno;
+  return error;
+}
+
+/**
+ * Streams raw samples of a project to a file descriptor, such as
+ * standard output or a named pipe.
+ *
+ * The samples are rendered like in write_wav_file() and written
+ * without any header.  All buffers are allocated once, and each chunk
+ * of samples is handed to the file descriptor in a single write.
+ * Without pacing, samples are produced as fast as the reader takes
+ * them, since writing to a full pipe blocks.
+ * @param model the project to render, which must not change
+ * meanwhile
+ * @param fd the file descriptor to write to
+ * @param rate the sample rate in Hertz
+ * @param num_samples the number of samples to write, or zero to keep
+ * going until writing fails
+ * @param format the sample format
+ * @param volume the desired maximum amplitude, as for apply_agc()
+ * @param peak the displacement that is scaled to @a volume
+ * @param realtime if TRUE, samples are written no faster than they
+ * would be played, staying at most ::STREAM_CHUNK samples ahead
+ * @return ::CORE_OK once @a num_samples were written, or
+ * ::CORE_ERROR_IO with @c errno set if writing failed.  @c EPIPE
+ * means that the reader went away.
+ */
+Core_Error
+stream_audio (const Wv_Fund_Freq_array * model, int fd, unsigned rate,
+	      guint64 num_samples, Sample_Format format, float volume,
+	      float peak, gboolean realtime)
+{
+  unsigned chunk = realtime ? STREAM_CHUNK : RENDER_CHUNK;
+  float *samples = (float *) g_malloc (sizeof (float) * chunk);
+  guint8 *encoded = (guint8 *) g_malloc (sample_format_size (format) *
+					 chunk);
+  GTimer *timer = g_timer_new ();
+  guint64 done = 0;
+  Core_Error error = CORE_OK;
+  int saved_errno;
+
+  while (num_samples == 0 || done < num_samples)
+    {
+      unsigned count = (num_samples == 0) ? chunk :
+	(unsigned) MIN (num_samples - done, chunk);
+      gsize length = render_encoded (model, samples, encoded, done, count,
+				     rate, format, volume, peak);
+      if (realtime && done > chunk)
+	{
+	  /* Wait until the reader has played everything but the last
+	     chunk.  */
+	  double ahead = (double) (done - chunk) / rate -
+	    g_timer_elapsed (timer, NULL);
+	  if (ahead > 0)
+	    g_usleep ((gulong) (ahead * G_USEC_PER_SEC));
+	}
+      if (!write_all (fd, (const gchar *) encoded, length))
+	{
+	  error = CORE_ERROR_IO;
+	  break;
+	}
+      done += count;
+    }
+
+  saved_errno = errno;
+  g_timer_destroy (timer);
+  g_free (encoded);
+  g_free (samples);
+  errno = saved_errno;
+  return error;
+}
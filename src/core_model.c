@@ -0,0 +1,554 @@
+/* Core data model of the fundamental frequency sets.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <math.h>
+
+#include <glib.h>
+
+#include "slidercore.h"
+
+/**
+ * An array of all of the fundamental frequency sets.
+ *
+ * Inside of each element is an array that holds all of the harmonics
+ * of the set.
+ */
+Wv_Fund_Freq_array *wv_all_freqs = NULL;
+
+/** Names of the harmonic series, as used on the command line.  */
+const char *const harmc_series_names[HARMC_SERIES_COUNT] =
+  { "sawtooth", "square", "triangle", "inverse-square", "exponential" };
+
+/**
+ * Compares two harmonics by harmonic number, for sorting.
+ */
+static gint
+compare_harmc_num (gconstpointer a, gconstpointer b)
+{
+  unsigned num_a = ((const Wv_Data *) a)->harmc_num;
+  unsigned num_b = ((const Wv_Data *) b)->harmc_num;
+  return (num_a > num_b) - (num_a < num_b);
+}
+
+/**
+ * Searches a sorted harmonic array by harmonic number.
+ *
+ * @param harmonics the harmonic array to search
+ * @param harmc_num the harmonic number to look for
+ * @param found where to store whether @a harmc_num is in the array
+ * @return the index of the harmonic if it was found, otherwise the
+ * index where it would have to be inserted
+ */
+static unsigned
+search_harmonics (const Wv_Data_array *harmonics, unsigned harmc_num,
+		  gboolean *found)
+{
+  unsigned low = 0, high = harmonics->len;
+
+  /* Appending is by far the most common case, such as while reading
+     a project file.  */
+  *found = FALSE;
+  if (high == 0 || harmonics->d[high-1].harmc_num < harmc_num)
+    return high;
+  while (low < high)
+    {
+      unsigned mid = low + (high - low) / 2;
+      if (harmonics->d[mid].harmc_num < harmc_num)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+  *found = (harmonics->d[low].harmc_num == harmc_num);
+  return low;
+}
+
+/**
+ * Sorts a harmonic array by harmonic number and merges harmonics
+ * that have the same number by adding up their amplitudes.
+ *
+ * The @a group_idx fields are renumbered afterward.
+ */
+void
+harmonics_sort (Wv_Data_array *harmonics)
+{
+  unsigned i, j;
+
+  for (i = 1; i < harmonics->len; i++)
+    {
+      if (harmonics->d[i-1].harmc_num >= harmonics->d[i].harmc_num)
+	break;
+    }
+  if (i < harmonics->len)
+    {
+      g_array_sort ((GArray *) harmonics, compare_harmc_num);
+      /* Since all harmonics start in phase, two harmonics with the
+	 same number are the same as one with both amplitudes.  */
+      for (i = 1, j = 0; i < harmonics->len; i++)
+	{
+	  if (harmonics->d[i].harmc_num == harmonics->d[j].harmc_num)
+	    harmonics->d[j].amplitude += harmonics->d[i].amplitude;
+	  else
+	    harmonics->d[++j] = harmonics->d[i];
+	}
+      g_array_set_size ((GArray *) harmonics, j + 1);
+    }
+  for (i = 0; i < harmonics->len; i++)
+    harmonics->d[i].group_idx = i;
+}
+
+/**
+ * Allocates an empty project that is separate from ::wv_all_freqs.
+ *
+ * Nothing else knows about the new project, so it can be filled in
+ * on any thread, such as while a project file is read in the
+ * background.  It can be made current with model_swap().
+ */
+Wv_Fund_Freq_array *
+model_array_new (void)
+{
+  return (Wv_Fund_Freq_array *)
+    g_array_new (FALSE, FALSE, sizeof (Wv_Fund_Freq));
+}
+
+/**
+ * Frees a project that was allocated with model_array_new().
+ *
+ * The @a ui field of every set must already have been freed.
+ */
+void
+model_array_free (Wv_Fund_Freq_array *model)
+{
+  unsigned i;
+  for (i = 0; i < model->len; i++)
+    g_array_free ((GArray *) model->d[i].harmonics, TRUE);
+  g_array_free ((GArray *) model, TRUE);
+}
+
+/**
+ * Adds a fundamental frequency set to the end of a project, with
+ * default values and no harmonics.
+ *
+ * @param model the project to add to
+ * @return the new set, which is only valid until the next set is
+ * added
+ */
+Wv_Fund_Freq *
+model_array_add_fund_freq (Wv_Fund_Freq_array *model)
+{
+  Wv_Fund_Freq *cur_fund;
+  unsigned index;
+  index = model->len;
+  g_array_set_size ((GArray *) model, index + 1);
+  cur_fund = &model->d[index];
+  cur_fund->fund_freq = 440.0;
+  cur_fund->amplitude = 1.0;
+  cur_fund->phase_pos = 0.0;
+  cur_fund->harmonics = (Wv_Data_array *)
+    g_array_new (FALSE, FALSE, sizeof (Wv_Data));
+  cur_fund->ui = NULL;
+  return cur_fund;
+}
+
+/**
+ * Copies a project, such as to save a snapshot of ::wv_all_freqs on
+ * another thread while the user keeps editing.
+ *
+ * The @a ui fields of the copy are NULL.
+ * @param model the project to copy
+ * @return a new project that must be freed with model_array_free()
+ */
+Wv_Fund_Freq_array *
+model_copy (const Wv_Fund_Freq_array *model)
+{
+  Wv_Fund_Freq_array *copy = (Wv_Fund_Freq_array *)
+    g_array_sized_new (FALSE, FALSE, sizeof (Wv_Fund_Freq), model->len);
+  unsigned i;
+
+  g_array_set_size ((GArray *) copy, model->len);
+  for (i = 0; i < model->len; i++)
+    {
+      const Wv_Data_array *harmonics = model->d[i].harmonics;
+      copy->d[i] = model->d[i];
+      copy->d[i].ui = NULL;
+      copy->d[i].harmonics = (Wv_Data_array *)
+	g_array_sized_new (FALSE, FALSE, sizeof (Wv_Data), harmonics->len);
+      g_array_append_vals ((GArray *) copy->d[i].harmonics,
+			   harmonics->d, harmonics->len);
+    }
+  return copy;
+}
+
+/**
+ * Makes another project the current one.
+ *
+ * Only the pointer ::wv_all_freqs is changed, so the switch happens
+ * all at once.  This must be called on the main thread.
+ * @param model the project to make current
+ * @return the project that was current before, which is now owned by
+ * the caller
+ */
+Wv_Fund_Freq_array *
+model_swap (Wv_Fund_Freq_array *model)
+{
+  Wv_Fund_Freq_array *old_model = wv_all_freqs;
+  wv_all_freqs = model;
+  return old_model;
+}
+
+/**
+ * Initializes ::wv_all_freqs to an empty project.
+ */
+void
+model_init (void)
+{
+  wv_all_freqs = model_array_new ();
+}
+
+/**
+ * Frees ::wv_all_freqs.
+ *
+ * The @a ui field of every set must already have been freed.
+ */
+void
+model_free (void)
+{
+  model_array_free (wv_all_freqs);
+  wv_all_freqs = NULL;
+}
+
+/**
+ * Adds a fundamental frequency set.
+ *
+ * The new fundamental frequency set is added to the end of
+ * ::wv_all_freqs with default values and no harmonics.
+ */
+void
+model_add_fund_freq (void)
+{
+  model_array_add_fund_freq (wv_all_freqs);
+}
+
+/**
+ * Deletes a fundamental frequency set.
+ *
+ * @param index the zero-based index of the fundamental frequency set
+ * to remove
+ */
+void
+model_remove_fund_freq (unsigned index)
+{
+  g_array_free ((GArray *) wv_all_freqs->d[index].harmonics, TRUE);
+  g_array_remove_index ((GArray *) wv_all_freqs, index);
+}
+
+/**
+ * Adds a harmonic.
+ *
+ * The new harmonic is added onto the end of the harmonic list, one
+ * harmonic number above the last one.  Note that this can move the
+ * harmonic array.
+ * @param fund_freq the fundamental frequency set to work with
+ */
+void
+model_add_harmonic (unsigned fund_freq)
+{
+  Wv_Data_array *harmonics = wv_all_freqs->d[fund_freq].harmonics;
+  unsigned index = harmonics->len;
+  Wv_Data *cur_harmonic;
+
+  g_array_set_size ((GArray *) harmonics, index + 1);
+  cur_harmonic = &harmonics->d[index];
+  cur_harmonic->amplitude = 1.0;
+  if (index != 0)
+    cur_harmonic->harmc_num = harmonics->d[index-1].harmc_num + 1;
+  else
+    cur_harmonic->harmc_num = 2;
+  cur_harmonic->group_idx = index;
+}
+
+/**
+ * Adds a harmonic with the given harmonic number in sorted position.
+ *
+ * If the array already has a harmonic with that number, @a amplitude
+ * is added to its amplitude instead.  Finding the position and
+ * merging a duplicate take O(log n) time, as does appending, but
+ * inserting in the middle moves all the harmonics after it, which
+ * takes O(n).  To add many harmonics in any order, append them and
+ * call harmonics_sort() once.  Note that this can move the harmonic
+ * array.
+ * @param harmonics the sorted harmonic array to add to
+ * @param harmc_num the harmonic number
+ * @param amplitude the amplitude of the harmonic
+ * @return the index of the new or merged harmonic
+ */
+unsigned
+harmonics_insert (Wv_Data_array *harmonics, unsigned harmc_num,
+		  float amplitude)
+{
+  Wv_Data new_harmonic;
+  gboolean found;
+  unsigned index;
+  unsigned i;
+
+  index = search_harmonics (harmonics, harmc_num, &found);
+  if (found)
+    {
+      harmonics->d[index].amplitude += amplitude;
+      return index;
+    }
+  new_harmonic.harmc_num = harmc_num;
+  new_harmonic.amplitude = amplitude;
+  g_array_insert_val ((GArray *) harmonics, index, new_harmonic);
+  for (i = index; i < harmonics->len; i++)
+    harmonics->d[i].group_idx = i;
+  return index;
+}
+
+/**
+ * Looks up a harmonic by harmonic number in a sorted harmonic array.
+ *
+ * This is a binary search, so it takes O(log n) time.
+ * @param harmonics the sorted harmonic array to search
+ * @param harmc_num the harmonic number to look for
+ * @return the harmonic, or NULL if the array does not have one with
+ * that number
+ */
+Wv_Data *
+harmonics_find (Wv_Data_array *harmonics, unsigned harmc_num)
+{
+  gboolean found;
+  unsigned index;
+
+  index = search_harmonics (harmonics, harmc_num, &found);
+  return found ? &harmonics->d[index] : NULL;
+}
+
+/**
+ * Adds a harmonic to a fundamental frequency set with
+ * harmonics_insert().
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param harmc_num the harmonic number
+ * @param amplitude the amplitude of the harmonic
+ * @return the index of the new or merged harmonic
+ */
+unsigned
+model_insert_harmonic (unsigned fund_freq, unsigned harmc_num,
+		       float amplitude)
+{
+  return harmonics_insert (wv_all_freqs->d[fund_freq].harmonics,
+			   harmc_num, amplitude);
+}
+
+/**
+ * Looks up a harmonic of a fundamental frequency set by harmonic
+ * number with harmonics_find().
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param harmc_num the harmonic number to look for
+ * @return the harmonic, or NULL if the set does not have one with
+ * that number
+ */
+Wv_Data *
+model_find_harmonic (unsigned fund_freq, unsigned harmc_num)
+{
+  return harmonics_find (wv_all_freqs->d[fund_freq].harmonics, harmc_num);
+}
+
+/**
+ * Deletes a harmonic.
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param index zero-based index of the harmonic to remove
+ */
+void
+model_remove_harmonic (unsigned fund_freq, unsigned index)
+{
+  Wv_Data_array *harmonics = wv_all_freqs->d[fund_freq].harmonics;
+  unsigned i;
+
+  g_array_remove_index ((GArray *) harmonics, index);
+  /* Recalculate group indices as necessary.  */
+  for (i = index; i < harmonics->len; i++)
+    harmonics->d[i].group_idx = i;
+}
+
+/**
+ * Makes room for a number of harmonics in a harmonic array without
+ * adding any, so that adding up to that many harmonics does not
+ * reallocate the array.
+ *
+ * @param harmonics the harmonic array to work with
+ * @param count the number of harmonics to make room for
+ */
+void
+harmonics_reserve (Wv_Data_array *harmonics, unsigned count)
+{
+  unsigned len = harmonics->len;
+
+  /* A GArray never gives back memory when it shrinks.  */
+  if (count > len)
+    {
+      g_array_set_size ((GArray *) harmonics, count);
+      g_array_set_size ((GArray *) harmonics, len);
+    }
+}
+
+/**
+ * Makes room for a number of harmonics in a fundamental frequency
+ * set with harmonics_reserve().
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param count the number of harmonics to make room for
+ */
+void
+model_reserve_harmonics (unsigned fund_freq, unsigned count)
+{
+  harmonics_reserve (wv_all_freqs->d[fund_freq].harmonics, count);
+}
+
+/**
+ * Replaces all of the harmonics of a fundamental frequency set.
+ *
+ * The harmonic array is only resized once.  The @a group_idx fields
+ * of @a harmonics are ignored.  @a harmonics does not need to be
+ * sorted, and harmonics with the same number are merged, so the set
+ * can end up with fewer than @a count harmonics.
+ * @param fund_freq the fundamental frequency set to work with
+ * @param harmonics the new harmonics
+ * @param count the number of elements in @a harmonics
+ */
+void
+model_set_harmonics (unsigned fund_freq, const Wv_Data *harmonics,
+		     unsigned count)
+{
+  Wv_Data_array *cur_harmonics = wv_all_freqs->d[fund_freq].harmonics;
+
+  g_array_set_size ((GArray *) cur_harmonics, count);
+  memcpy (cur_harmonics->d, harmonics, sizeof (Wv_Data) * count);
+  harmonics_sort (cur_harmonics);
+}
+
+/**
+ * Replaces the harmonics of a fundamental frequency set with a
+ * generated harmonic series.
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param series the shape of the harmonic series
+ * @param count the number of harmonics to generate, not counting the
+ * fundamental
+ * @param rolloff the ratio between the amplitudes of neighboring
+ * harmonics for ::HARMC_SERIES_EXPONENTIAL
+ */
+void
+model_generate_harmonics (unsigned fund_freq, Harmc_Series series,
+			  unsigned count, float rolloff)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  unsigned i;
+
+  g_array_set_size ((GArray *) cur_fund->harmonics, count);
+  for (i = 0; i < count; i++)
+    {
+      Wv_Data *cur_harmonic = &cur_fund->harmonics->d[i];
+      unsigned harmc_num;
+      double rel_amp;
+      switch (series)
+	{
+	case HARMC_SERIES_SQUARE:
+	  harmc_num = 2 * i + 3;
+	  rel_amp = 1.0 / harmc_num;
+	  break;
+	case HARMC_SERIES_TRIANGLE:
+	  /* The odd harmonics alternate in sign, starting with a
+	     negative third harmonic.  */
+	  harmc_num = 2 * i + 3;
+	  rel_amp = 1.0 / ((double) harmc_num * harmc_num);
+	  if (i % 2 == 0)
+	    rel_amp = -rel_amp;
+	  break;
+	case HARMC_SERIES_INV_SQUARE:
+	  harmc_num = i + 2;
+	  rel_amp = 1.0 / ((double) harmc_num * harmc_num);
+	  break;
+	case HARMC_SERIES_EXPONENTIAL:
+	  harmc_num = i + 2;
+	  rel_amp = pow (rolloff, harmc_num - 1);
+	  break;
+	case HARMC_SERIES_SAWTOOTH:
+	default:
+	  harmc_num = i + 2;
+	  rel_amp = 1.0 / harmc_num;
+	  break;
+	}
+      cur_harmonic->harmc_num = harmc_num;
+      cur_harmonic->amplitude = (float) (cur_fund->amplitude * rel_amp);
+      cur_harmonic->group_idx = i;
+    }
+}
+
+/**
+ * Fills an empty ::wv_all_freqs with a new project.
+ *
+ * A new project has one fundamental frequency set with one harmonic.
+ */
+void
+model_new_project (void)
+{
+  model_add_fund_freq ();
+  model_add_harmonic (0);
+}
+
+/**
+ * Looks up a harmonic series by name.
+ *
+ * @param name the name to look up, one of ::harmc_series_names
+ * @param series where to store the series that was found
+ * @return TRUE if @a name was found, FALSE otherwise
+ */
+gboolean
+harmc_series_from_name (const char * name, Harmc_Series * series)
+{
+  unsigned i;
+  for (i = 0; i < HARMC_SERIES_COUNT; i++)
+    {
+      if (!strcmp (name, harmc_series_names[i]))
+	{
+	  *series = (Harmc_Series) i;
+	  return TRUE;
+	}
+    }
+  return FALSE;
+}
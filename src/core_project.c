@@ -0,0 +1,1327 @@
+/* Reading and writing of project files.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#  include <io.h>
+#  define fsync _commit
+#endif
+
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
+
+#include "slidercore.h"
+#include "file_business.h"
+
+/** Number of attempts at finding an unused temporary file name.  */
+#define TEMP_NAME_TRIES 100
+
+/**
+ * Formats a project in the Slider Wave Editor text format.
+ *
+ * Numbers are formatted with format_float(), which does not depend
+ * on the locale, so this is safe to call on any thread as long as
+ * nothing else changes @a model meanwhile.
+ * @param out the buffer to append the project file to
+ * @param model the project to format
+ */
+void
+format_sliw_project (GString * out, const Wv_Fund_Freq_array * model)
+{
+  gchar num_buf[FLOAT_STR_SIZE];
+  unsigned i;
+  unsigned j;
+
+  g_string_append (out,
+"# This is a Slider Wave Editor project file.  Comments are only\n"
+"# allowed at the beginning of a project file, and they are not\n"
+"# preserved during file loading and saving in Slider.\n"
+"#\n"
+"# A harmonic is specified as a pair of numbers.  The first number is\n"
+"# the harmonic number, and the second is the amplitude.\n");
+
+  for (i = 0; i < model->len; i++)
+    {
+      const Wv_Data_array *harmonics = model->d[i].harmonics;
+      g_string_append_printf (out, "\nFundamental %u\n", i + 1);
+      g_string_append_printf (out, "Frequency: %s\n",
+			      format_float (num_buf, model->d[i].fund_freq));
+      g_string_append_printf (out, "Amplitude: %s\n",
+			      format_float (num_buf, model->d[i].amplitude));
+      g_string_append (out, "Harmonics:");
+      for (j = 0; j < harmonics->len; j++)
+	{
+	  g_string_append_printf (out, " %u, %s;", harmonics->d[j].harmc_num,
+				  format_float (num_buf,
+						harmonics->d[j].amplitude));
+	}
+      g_string_append_c (out, '\n');
+    }
+}
+
+/**
+ * Writes all of a buffer to a file descriptor.
+ *
+ * @return TRUE on success, FALSE with @c errno set on failure
+ */
+gboolean
+write_all (int fd, const gchar * contents, gsize length)
+{
+  while (length > 0)
+    {
+      /* Some systems cannot write more than this at once.  */
+      int chunk = (int) MIN (length, G_MAXINT / 2);
+      int written = write (fd, contents, chunk);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return FALSE;
+	}
+      contents += written;
+      length -= written;
+    }
+  return TRUE;
+}
+
+/**
+ * Replaces the contents of a file without ever leaving a partly
+ * written file under its name.
+ *
+ * The contents are written to a new temporary file in the same
+ * folder, which is then renamed over @a filename.  If anything fails,
+ * the old file is left as it was and the temporary file is removed.
+ * The permissions of an existing file are kept.
+ * @param filename the name of the file to replace or create
+ * @param contents the new contents of the file
+ * @param length the length of @a contents in bytes
+ * @param sync if TRUE, the data is flushed to the disk before the
+ * rename, so that the file is complete even after a system crash
+ * @return ::CORE_OK on success, or ::CORE_ERROR_IO with @c errno set
+ */
+Core_Error
+write_file_atomic (const char * filename, const gchar * contents,
+		   gsize length, gboolean sync)
+{
+  gchar *tmp_name = NULL;
+  struct stat old_stat;
+  int fd = -1;
+  int saved_errno;
+  unsigned i;
+
+  for (i = 0; i < TEMP_NAME_TRIES && fd == -1; i++)
+    {
+      g_free (tmp_name);
+      tmp_name = g_strdup_printf ("%s.%08x.tmp", filename,
+				  (unsigned) g_random_int ());
+      fd = g_open (tmp_name, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, 0666);
+      if (fd == -1 && errno != EEXIST)
+	break;
+    }
+  if (fd == -1)
+    {
+      saved_errno = errno;
+      g_free (tmp_name);
+      errno = saved_errno;
+      return CORE_ERROR_IO;
+    }
+
+  if (!write_all (fd, contents, length) || (sync && fsync (fd) != 0))
+    {
+      saved_errno = errno;
+      close (fd);
+      goto fail;
+    }
+  if (close (fd) != 0)
+    {
+      saved_errno = errno;
+      goto fail;
+    }
+  if (g_stat (filename, &old_stat) == 0)
+    g_chmod (tmp_name, old_stat.st_mode & 07777);
+  /* GLib replaces an existing file on Windows as well.  */
+  if (g_rename (tmp_name, filename) != 0)
+    {
+      saved_errno = errno;
+      goto fail;
+    }
+  g_free (tmp_name);
+  return CORE_OK;
+
+ fail:
+  g_unlink (tmp_name);
+  g_free (tmp_name);
+  errno = saved_errno;
+  return CORE_ERROR_IO;
+}
+
+/**
+ * Writes a project as a Nyquist Lisp script.
+ *
+ * The script is represented as a series of waveforms defined only by
+ * frequency and amplitude.  This is intended to be used as an
+ * efficient way to import Slider sounds into other applications.
+ * @param filename the name of the file to export to
+ * @param header comment lines to write at the beginning of the
+ * script, each starting with a semicolon
+ * @return ::CORE_OK on success, or ::CORE_ERROR_IO with @c errno set
+ */
+Core_Error
+write_nyquist_script (const char * filename, const char * header)
+{
+  FILE* fp;
+
+  fp = fopen (filename, "w");
+  if (fp == NULL)
+    return CORE_ERROR_IO;
+
+  fputs (header, fp);
+
+  fputs ("(sum", fp);
+  /* "libintl" overrides the default *printf functions, so to prevent
+     problems with passing file pointers between different versions of
+     the Microsoft C runtime, all fprintf functions must be declared
+     in a separate source file.  */
+  do_export_printing (fp);
+  fputs (")\n", fp);
+
+  if (fclose (fp) == EOF)
+    return CORE_ERROR_IO;
+  return CORE_OK;
+}
+
+/**
+ * Formats a number in the C locale with as few significant digits as
+ * possible.
+ *
+ * The result is the shortest of the <code>%.1g</code> to
+ * <code>%.9g</code> conversions that reads back as exactly the same
+ * float through g_ascii_strtod(), which is how project files are
+ * read.  Nine digits are always enough for a float.  Unlike
+ * setlocale(), this is safe to use from any thread.
+ * @param buffer where to store the result, which must have room for
+ * ::FLOAT_STR_SIZE bytes
+ * @param value the number to format
+ * @return @a buffer
+ */
+gchar *
+format_float (gchar * buffer, float value)
+{
+  static const char *const formats[] =
+    { "%.1g", "%.2g", "%.3g", "%.4g", "%.5g", "%.6g", "%.7g", "%.8g",
+      "%.9g" };
+  unsigned low = 0, high = G_N_ELEMENTS (formats) - 1;
+  unsigned formatted = G_N_ELEMENTS (formats);
+  const char *exponent;
+
+  /* If a number reads back exactly with some number of digits, it
+     also does with any more digits, so the shortest precision can be
+     found with a binary search.  */
+  while (low < high)
+    {
+      unsigned mid = low + (high - low) / 2;
+      g_ascii_formatd (buffer, FLOAT_STR_SIZE, formats[mid], value);
+      formatted = mid;
+      if ((float) g_ascii_strtod (buffer, NULL) == value)
+	high = mid;
+      else
+	low = mid + 1;
+    }
+  if (formatted != high)
+    g_ascii_formatd (buffer, FLOAT_STR_SIZE, formats[high], value);
+
+  /* Write whole numbers such as 440 without an exponent, even though
+     "4.4e+02" is shorter.  */
+  exponent = strchr (buffer, 'e');
+  if (exponent != NULL)
+    {
+      long digits = strtol (exponent + 1, NULL, 10);
+      if (digits > 0 && digits < (long) G_N_ELEMENTS (formats))
+	g_ascii_formatd (buffer, FLOAT_STR_SIZE, formats[digits], value);
+    }
+  return buffer;
+}
+
+/** Number of bytes to read from a project file at once.  */
+#define READ_CHUNK 65536
+/** Number of bytes of a text project file, or harmonics of a binary
+    project file, to read between calls to the progress function.  */
+#define PROGRESS_INTERVAL 65536
+
+/**
+ * State of the project file tokenizer.
+ *
+ * The whole file is held in memory, followed by a NUL byte so that
+ * numbers can be converted in place.
+ */
+typedef struct _Sliw_Parser
+{
+  const char *pos; /**< Next character to read */
+  const char *end; /**< End of the file contents */
+  const char *line_start; /**< Start of the current line */
+  unsigned line; /**< Current line number, starting at one */
+  Wv_Fund_Freq_array *model; /**< The project to read into */
+  Core_Progress_Func progress; /**< Progress function, or NULL */
+  gpointer user_data; /**< Data for ::progress */
+  const char *start; /**< Start of the file contents */
+  const char *next_report; /**< Where to call ::progress next */
+  gboolean cancelled; /**< TRUE if ::progress asked to stop */
+} Sliw_Parser;
+
+/**
+ * Skips over whitespace, counting lines.
+ */
+static void
+skip_space (Sliw_Parser * parser)
+{
+  while (parser->pos < parser->end)
+    {
+      switch (*parser->pos)
+	{
+	case '\n':
+	  parser->line++;
+	  parser->line_start = parser->pos + 1;
+	  /* Fall through.  */
+	case ' ': case '\t': case '\r': case '\v': case '\f':
+	  parser->pos++;
+	  break;
+	default:
+	  return;
+	}
+    }
+}
+
+/**
+ * Skips over the given text if it comes next.
+ *
+ * @return TRUE if the text was found, FALSE otherwise
+ */
+static gboolean
+match_text (Sliw_Parser * parser, const char * text)
+{
+  size_t len = strlen (text);
+  if ((size_t) (parser->end - parser->pos) < len ||
+      memcmp (parser->pos, text, len))
+    return FALSE;
+  parser->pos += len;
+  return TRUE;
+}
+
+/**
+ * Reads an unsigned decimal integer.
+ *
+ * @return TRUE if a number was read, FALSE if no digits are next or
+ * the number is too large
+ */
+static gboolean
+parse_unsigned (Sliw_Parser * parser, unsigned * value)
+{
+  const char *pos = parser->pos;
+  guint64 result = 0;
+
+  if (pos == parser->end || !g_ascii_isdigit (*pos))
+    return FALSE;
+  while (pos < parser->end && g_ascii_isdigit (*pos))
+    {
+      result = result * 10 + (*pos - '0');
+      if (result > G_MAXUINT)
+	return FALSE;
+      pos++;
+    }
+  *value = (unsigned) result;
+  parser->pos = pos;
+  return TRUE;
+}
+
+/**
+ * Reads a floating point number in the C locale.
+ *
+ * Numbers written by format_float() are read back exactly.
+ * @return TRUE if a number was read, FALSE otherwise
+ */
+static gboolean
+parse_float (Sliw_Parser * parser, float * value)
+{
+  gchar *num_end;
+  gdouble result;
+
+  if (parser->pos == parser->end)
+    return FALSE;
+  result = g_ascii_strtod (parser->pos, &num_end);
+  if (num_end == parser->pos)
+    return FALSE;
+  *value = (float) result;
+  parser->pos = num_end;
+  return TRUE;
+}
+
+/**
+ * Calls the progress function if enough of the file was parsed since
+ * the last call.
+ *
+ * @return FALSE if parsing should stop, TRUE otherwise
+ */
+static gboolean
+report_progress (Sliw_Parser * parser)
+{
+  if (parser->progress == NULL || parser->pos < parser->next_report)
+    return TRUE;
+  parser->next_report = parser->pos + PROGRESS_INTERVAL;
+  if (!parser->progress ((double) (parser->pos - parser->start) /
+			 (parser->end - parser->start),
+			 parser->user_data))
+    {
+      parser->cancelled = TRUE;
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/**
+ * Parses the harmonics of a set and appends them to its harmonic
+ * array in the order they appear in the file.
+ *
+ * @param parser the parser, which is at the first harmonic
+ * @param harmonics the harmonic array of the set
+ * @return TRUE on success, FALSE on a syntax error, in which case
+ * @a parser is left at the position of the error, or if the progress
+ * function asked to stop
+ */
+static gboolean
+parse_harmonics (Sliw_Parser * parser, Wv_Data_array * harmonics)
+{
+  for (;;)
+    {
+      Wv_Data new_harmonic;
+
+      if (!report_progress (parser))
+	return FALSE;
+      skip_space (parser);
+      if (parser->pos == parser->end || *parser->pos == 'F')
+	return TRUE;
+      if (!parse_unsigned (parser, &new_harmonic.harmc_num))
+	return FALSE;
+      skip_space (parser);
+      if (!match_text (parser, ","))
+	return FALSE;
+      skip_space (parser);
+      if (!parse_float (parser, &new_harmonic.amplitude))
+	return FALSE;
+      skip_space (parser);
+      if (!match_text (parser, ";"))
+	return FALSE;
+      new_harmonic.group_idx = harmonics->len;
+      g_array_append_val ((GArray *) harmonics, new_harmonic);
+    }
+}
+
+/**
+ * Parses the contents of a project file into the parser's project.
+ *
+ * Whitespace is allowed anywhere between tokens.  The harmonics of a
+ * set are counted before they are read, so that the harmonic array
+ * only needs to be allocated once.
+ * @return TRUE on success, FALSE on a syntax error, in which case
+ * @a parser is left at the position of the error, or if the progress
+ * function asked to stop
+ */
+static gboolean
+parse_sliw_project (Sliw_Parser * parser)
+{
+  /* First skip the comments.  */
+  while (parser->pos < parser->end && *parser->pos == '#')
+    {
+      const char *newline = (const char *)
+	memchr (parser->pos, '\n', parser->end - parser->pos);
+      if (newline == NULL)
+	{
+	  parser->pos = parser->end;
+	  break;
+	}
+      parser->pos = newline + 1;
+      parser->line++;
+      parser->line_start = parser->pos;
+    }
+
+  skip_space (parser);
+  if (!match_text (parser, "Fundamental"))
+    return FALSE;
+  do
+    {
+      Wv_Fund_Freq *cur_fund;
+      unsigned fund_freq = parser->model->len;
+      unsigned fund_num;
+      unsigned count;
+      const char *scan;
+      gboolean valid;
+
+      skip_space (parser);
+      scan = parser->pos;
+      if (!parse_unsigned (parser, &fund_num))
+	return FALSE;
+      /* Sets must be numbered in order, starting from one.  */
+      if (fund_num != fund_freq + 1)
+	{
+	  parser->pos = scan;
+	  return FALSE;
+	}
+      cur_fund = model_array_add_fund_freq (parser->model);
+
+      skip_space (parser);
+      if (!match_text (parser, "Frequency:"))
+	return FALSE;
+      skip_space (parser);
+      if (!parse_float (parser, &cur_fund->fund_freq))
+	return FALSE;
+      skip_space (parser);
+      if (!match_text (parser, "Amplitude:"))
+	return FALSE;
+      skip_space (parser);
+      if (!parse_float (parser, &cur_fund->amplitude))
+	return FALSE;
+      skip_space (parser);
+      if (!match_text (parser, "Harmonics:"))
+	return FALSE;
+
+      count = 0;
+      for (scan = parser->pos; scan < parser->end && *scan != 'F'; scan++)
+	{
+	  if (*scan == ';')
+	    count++;
+	}
+      harmonics_reserve (cur_fund->harmonics, count);
+
+      valid = parse_harmonics (parser, cur_fund->harmonics);
+      /* Harmonics are kept sorted, and any duplicates in the file
+	 are merged.  Sorting once per set keeps files with harmonics
+	 out of order from taking quadratic time.  */
+      harmonics_sort (cur_fund->harmonics);
+      if (!valid)
+	return FALSE;
+    } while (match_text (parser, "Fundamental"));
+
+  return parser->pos == parser->end;
+}
+
+/**
+ * Reads a Slider Wave Editor project file into an empty project.
+ *
+ * The whole file is read into memory and then parsed in a single
+ * pass.  Numbers are always read in the C locale, so the current
+ * locale is never changed.  On an error, the sets that were read so
+ * far are left in @a model.
+ * @param model the project to read into, which may be ::wv_all_freqs
+ * or one that was allocated with model_array_new()
+ * @param filename the name of the file to load
+ * @param error_loc where to store the position of a syntax error, or
+ * NULL
+ * @param progress the function to call with the progress of parsing,
+ * or NULL
+ * @param user_data the data to pass to @a progress
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the file could not be read, ::CORE_ERROR_SYNTAX, or
+ * ::CORE_ERROR_CANCELLED
+ */
+Core_Error
+read_sliw_project (Wv_Fund_Freq_array * model, const char * filename,
+		   Core_Location * error_loc, Core_Progress_Func progress,
+		   gpointer user_data)
+{
+  FILE *fp;
+  GByteArray *contents;
+  Sliw_Parser parser;
+  gboolean valid;
+
+  fp = fopen (filename, "rb");
+  if (fp == NULL)
+    return CORE_ERROR_IO;
+
+  contents = g_byte_array_new ();
+  for (;;)
+    {
+      guint len = contents->len;
+      size_t num_read;
+      g_byte_array_set_size (contents, len + READ_CHUNK);
+      num_read = fread (contents->data + len, 1, READ_CHUNK, fp);
+      g_byte_array_set_size (contents, len + num_read);
+      if (num_read < READ_CHUNK)
+	break;
+      /* The size of the file is not known yet, so only give a chance
+	 to cancel.  */
+      if (progress != NULL && contents->len % (16 * READ_CHUNK) == 0 &&
+	  !progress (0.0, user_data))
+	{
+	  fclose (fp);
+	  g_byte_array_free (contents, TRUE);
+	  return CORE_ERROR_CANCELLED;
+	}
+    }
+  if (ferror (fp))
+    {
+      int saved_errno = errno;
+      fclose (fp);
+      g_byte_array_free (contents, TRUE);
+      errno = saved_errno;
+      return CORE_ERROR_IO;
+    }
+  fclose (fp);
+  g_byte_array_append (contents, (const guint8 *) "", 1);
+
+  parser.pos = (const char *) contents->data;
+  parser.end = parser.pos + contents->len - 1;
+  parser.line_start = parser.pos;
+  parser.line = 1;
+  parser.model = model;
+  parser.progress = progress;
+  parser.user_data = user_data;
+  parser.start = parser.pos;
+  parser.next_report = parser.pos;
+  parser.cancelled = FALSE;
+  valid = parse_sliw_project (&parser);
+  if (!valid && !parser.cancelled && error_loc != NULL)
+    {
+      error_loc->line = parser.line;
+      error_loc->column = (unsigned) (parser.pos - parser.line_start) + 1;
+    }
+  g_byte_array_free (contents, TRUE);
+  if (parser.cancelled)
+    return CORE_ERROR_CANCELLED;
+  if (!valid)
+    return CORE_ERROR_SYNTAX;
+  if (progress != NULL && !progress (1.0, user_data))
+    return CORE_ERROR_CANCELLED;
+  return CORE_OK;
+}
+
+/**
+ * @name Binary project files
+ *
+ * A binary project file holds the same data as a text project file,
+ * laid out so that it can be mapped into memory and used without any
+ * parsing.  All numbers are little-endian, and floats are in IEEE 754
+ * single precision.  The file starts with a header:
+ *
+ * - 8 bytes: ::SLIWB_MAGIC
+ * - 32 bits: format version, ::SLIWB_VERSION
+ * - 32 bits: number of fundamental frequency sets
+ *
+ * The header is followed by an index with one ::SLIWB_INDEX_SIZE
+ * byte entry for each set:
+ *
+ * - float: frequency
+ * - float: amplitude
+ * - 32 bits: number of harmonics
+ * - 32 bits: reserved, zero
+ * - 64 bits: file offset of the harmonic numbers, which is a multiple
+ *   of four
+ *
+ * At that offset there is an array of 32-bit harmonic numbers,
+ * immediately followed by an array of float amplitudes of the same
+ * length.
+ */
+/*@{*/
+
+/** Identifies a binary project file.  The line ending characters
+    catch files that were mangled by a text mode transfer.  */
+#define SLIWB_MAGIC "SLIWB\r\n\032"
+/** Length of ::SLIWB_MAGIC.  */
+#define SLIWB_MAGIC_SIZE 8
+/** Version of the binary project file format that is written.  */
+#define SLIWB_VERSION 1
+/** Size of the binary project file header.  */
+#define SLIWB_HEADER_SIZE 16
+/** Size of one entry in the binary project file index.  */
+#define SLIWB_INDEX_SIZE 24
+
+/*@}*/
+
+/** Stores a 32-bit little-endian number.  */
+static void
+put_le32 (guint8 * dest, guint32 value)
+{
+  value = GUINT32_TO_LE (value);
+  memcpy (dest, &value, 4);
+}
+
+/** Stores a float in little-endian byte order.  */
+static void
+put_le_float (guint8 * dest, float value)
+{
+  guint32 bits;
+  memcpy (&bits, &value, 4);
+  put_le32 (dest, bits);
+}
+
+/** Loads a 32-bit little-endian number.  */
+static guint32
+get_le32 (const guint8 * src)
+{
+  guint32 value;
+  memcpy (&value, src, 4);
+  return GUINT32_FROM_LE (value);
+}
+
+/** Loads a float in little-endian byte order.  */
+static float
+get_le_float (const guint8 * src)
+{
+  guint32 bits = get_le32 (src);
+  float value;
+  memcpy (&value, &bits, 4);
+  return value;
+}
+
+/**
+ * Sets @c errno to match a GLib file error.
+ */
+static void
+set_errno_from_error (const GError * error)
+{
+  /* GLib does not keep errno, so only the most likely reasons can be
+     told apart.  */
+  if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+    errno = ENOENT;
+  else if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_ACCES))
+    errno = EACCES;
+  else if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOMEM))
+    errno = ENOMEM;
+  else
+    errno = EIO;
+}
+
+/**
+ * Formats a project in the binary Slider Wave Editor format.
+ *
+ * The buffer is grown once to the size of the whole file, and then
+ * filled in place.
+ * @param out the buffer to append the project file to
+ * @param model the project to format
+ */
+void
+format_sliwb_project (GString * out, const Wv_Fund_Freq_array * model)
+{
+  unsigned num_sets = model->len;
+  gsize start = out->len;
+  guint64 offset;
+  guint8 *dest;
+  unsigned i, j;
+
+  offset = SLIWB_HEADER_SIZE + (guint64) SLIWB_INDEX_SIZE * num_sets;
+  for (i = 0; i < num_sets; i++)
+    offset += (guint64) 8 * model->d[i].harmonics->len;
+  g_string_set_size (out, start + (gsize) offset);
+  dest = (guint8 *) out->str + start;
+
+  memcpy (dest, SLIWB_MAGIC, SLIWB_MAGIC_SIZE);
+  put_le32 (dest + 8, SLIWB_VERSION);
+  put_le32 (dest + 12, num_sets);
+
+  offset = SLIWB_HEADER_SIZE + (guint64) SLIWB_INDEX_SIZE * num_sets;
+  for (i = 0; i < num_sets; i++)
+    {
+      const Wv_Fund_Freq *cur_fund = &model->d[i];
+      const Wv_Data_array *harmonics = cur_fund->harmonics;
+      guint8 *entry = dest + SLIWB_HEADER_SIZE + SLIWB_INDEX_SIZE * i;
+      guint8 *harmc_nums = dest + offset;
+      guint8 *amplitudes = harmc_nums + 4 * (gsize) harmonics->len;
+
+      put_le_float (entry, cur_fund->fund_freq);
+      put_le_float (entry + 4, cur_fund->amplitude);
+      put_le32 (entry + 8, harmonics->len);
+      put_le32 (entry + 12, 0);
+      put_le32 (entry + 16, (guint32) (offset & 0xffffffff));
+      put_le32 (entry + 20, (guint32) (offset >> 32));
+      for (j = 0; j < harmonics->len; j++)
+	{
+	  put_le32 (harmc_nums + 4 * j, harmonics->d[j].harmc_num);
+	  put_le_float (amplitudes + 4 * j, harmonics->d[j].amplitude);
+	}
+      offset += (guint64) 8 * harmonics->len;
+    }
+}
+
+/**
+ * Reads a binary Slider Wave Editor project file into an empty
+ * project.
+ *
+ * The file is mapped into memory, and the harmonic arrays are copied
+ * straight from the mapping.  Every offset and length in the file is
+ * checked against the size of the file first.
+ * @param model the project to read into, which may be ::wv_all_freqs
+ * or one that was allocated with model_array_new()
+ * @param filename the name of the file to load
+ * @param progress the function to call with the progress of reading,
+ * or NULL
+ * @param user_data the data to pass to @a progress
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the file could not be read, ::CORE_ERROR_SYNTAX if the file is not
+ * a valid binary project file, or ::CORE_ERROR_CANCELLED
+ */
+Core_Error
+read_sliwb_project (Wv_Fund_Freq_array * model, const char * filename,
+		    Core_Progress_Func progress, gpointer user_data)
+{
+  GMappedFile *mapped;
+  GError *error = NULL;
+  const guint8 *contents;
+  guint64 length;
+  unsigned num_sets;
+  Core_Error retval = CORE_ERROR_SYNTAX;
+  unsigned i;
+
+  mapped = g_mapped_file_new (filename, FALSE, &error);
+  if (mapped == NULL)
+    {
+      set_errno_from_error (error);
+      g_error_free (error);
+      return CORE_ERROR_IO;
+    }
+  contents = (const guint8 *) g_mapped_file_get_contents (mapped);
+  length = g_mapped_file_get_length (mapped);
+
+  if (length < SLIWB_HEADER_SIZE ||
+      memcmp (contents, SLIWB_MAGIC, SLIWB_MAGIC_SIZE) ||
+      get_le32 (contents + 8) != SLIWB_VERSION)
+    goto cleanup;
+  num_sets = get_le32 (contents + 12);
+  /* A project always has at least one set.  */
+  if (num_sets == 0 ||
+      (length - SLIWB_HEADER_SIZE) / SLIWB_INDEX_SIZE < num_sets)
+    goto cleanup;
+
+  for (i = 0; i < num_sets; i++)
+    {
+      const guint8 *entry =
+	contents + SLIWB_HEADER_SIZE + SLIWB_INDEX_SIZE * i;
+      const guint8 *harmc_nums;
+      const guint8 *amplitudes;
+      Wv_Fund_Freq *cur_fund;
+      guint32 count = get_le32 (entry + 8);
+      guint64 offset = get_le32 (entry + 16) |
+	((guint64) get_le32 (entry + 20) << 32);
+      gboolean sorted = TRUE;
+      guint32 j;
+
+      if (offset % 4 != 0 || offset > length ||
+	  (length - offset) / 8 < count)
+	goto cleanup;
+      harmc_nums = contents + offset;
+      amplitudes = harmc_nums + 4 * (gsize) count;
+
+      cur_fund = model_array_add_fund_freq (model);
+      cur_fund->fund_freq = get_le_float (entry);
+      cur_fund->amplitude = get_le_float (entry + 4);
+      g_array_set_size ((GArray *) cur_fund->harmonics, count);
+      for (j = 0; j < count; j++)
+	{
+	  Wv_Data *cur_harmonic = &cur_fund->harmonics->d[j];
+	  if (progress != NULL && j % PROGRESS_INTERVAL == 0 &&
+	      !progress ((double) (offset + 4 * (guint64) j) / length,
+			 user_data))
+	    {
+	      retval = CORE_ERROR_CANCELLED;
+	      goto cleanup;
+	    }
+	  cur_harmonic->harmc_num = get_le32 (harmc_nums + 4 * j);
+	  cur_harmonic->amplitude = get_le_float (amplitudes + 4 * j);
+	  cur_harmonic->group_idx = j;
+	  if (j > 0 && cur_harmonic->harmc_num <= cur_harmonic[-1].harmc_num)
+	    sorted = FALSE;
+	}
+      /* Slider always writes sorted harmonics, but other programs
+	 might not.  */
+      if (!sorted)
+	harmonics_sort (cur_fund->harmonics);
+    }
+  retval = CORE_OK;
+  if (progress != NULL && !progress (1.0, user_data))
+    retval = CORE_ERROR_CANCELLED;
+
+ cleanup:
+#if GLIB_CHECK_VERSION (2, 22, 0)
+  g_mapped_file_unref (mapped);
+#else
+  g_mapped_file_free (mapped);
+#endif
+  return retval;
+}
+
+/**
+ * Formats a project in the format that matches a file name.
+ *
+ * Files that end in ::SLIWB_SUFFIX are written in the binary format,
+ * and all others in the text format.
+ * @param model the project to format
+ * @param filename the file name that the project will be saved to
+ * @return a new buffer with the contents of the project file
+ */
+GString *
+format_project (const Wv_Fund_Freq_array * model, const char * filename)
+{
+  GString *out = g_string_new (NULL);
+  if (g_str_has_suffix (filename, SLIWB_SUFFIX))
+    format_sliwb_project (out, model);
+  else
+    format_sliw_project (out, model);
+  return out;
+}
+
+/**
+ * Saves a project file in the format that matches its name.
+ *
+ * The whole file is formatted in memory first, and then written with
+ * write_file_atomic(), so a failed save never damages the old file.
+ * @param model the project to save
+ * @param filename the file name to save to
+ * @param sync whether to flush the file to the disk before replacing
+ * the old one
+ * @return ::CORE_OK on success, or ::CORE_ERROR_IO with @c errno set
+ */
+Core_Error
+write_project_from (const Wv_Fund_Freq_array * model, const char * filename,
+		    gboolean sync)
+{
+  GString *contents = format_project (model, filename);
+  Core_Error error;
+  int saved_errno;
+
+  error = write_file_atomic (filename, contents->str, contents->len, sync);
+  saved_errno = errno;
+  g_string_free (contents, TRUE);
+  errno = saved_errno;
+  return error;
+}
+
+/**
+ * Saves ::wv_all_freqs with write_project_from(), flushing it to the
+ * disk.
+ *
+ * @param filename the file name to save to
+ * @return ::CORE_OK on success, or ::CORE_ERROR_IO with @c errno set
+ */
+Core_Error
+write_project (const char * filename)
+{
+  return write_project_from (wv_all_freqs, filename, TRUE);
+}
+
+/**
+ * Reads a project file in either format into an empty project.
+ *
+ * The format is told from the contents of the file rather than its
+ * name.  Nothing here touches ::wv_all_freqs unless it is @a model,
+ * so a separate project can be read on another thread while the
+ * current one is in use.
+ * @param model the project to read into
+ * @param filename the name of the file to load
+ * @param error_loc where to store the position of a syntax error, or
+ * NULL
+ * @param progress the function to call from time to time with the
+ * fraction of the file that was read, or NULL
+ * @param user_data the data to pass to @a progress
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the file could not be read, ::CORE_ERROR_SYNTAX, or
+ * ::CORE_ERROR_CANCELLED if @a progress asked to stop
+ */
+Core_Error
+read_project_into (Wv_Fund_Freq_array * model, const char * filename,
+		   Core_Location * error_loc, Core_Progress_Func progress,
+		   gpointer user_data)
+{
+  FILE *fp;
+  char magic[SLIWB_MAGIC_SIZE];
+  size_t num_read;
+
+  fp = fopen (filename, "rb");
+  if (fp == NULL)
+    return CORE_ERROR_IO;
+  num_read = fread (magic, 1, SLIWB_MAGIC_SIZE, fp);
+  fclose (fp);
+
+  if (num_read == SLIWB_MAGIC_SIZE &&
+      !memcmp (magic, SLIWB_MAGIC, SLIWB_MAGIC_SIZE))
+    {
+      if (error_loc != NULL)
+	error_loc->line = error_loc->column = 0;
+      return read_sliwb_project (model, filename, progress, user_data);
+    }
+  return read_sliw_project (model, filename, error_loc,
+			    progress, user_data);
+}
+
+/**
+ * Reads a project file in either format into an empty
+ * ::wv_all_freqs with read_project_into().
+ *
+ * @param filename the name of the file to load
+ * @param error_loc where to store the position of a syntax error, or
+ * NULL
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the file could not be read, or ::CORE_ERROR_SYNTAX
+ */
+Core_Error
+read_project (const char * filename, Core_Location * error_loc)
+{
+  return read_project_into (wv_all_freqs, filename, error_loc, NULL, NULL);
+}
+
+/**
+ * @name Autosave journals
+ *
+ * An autosave journal records the changes to a project since it was
+ * last saved, so that they can be recovered after a crash.  It is
+ * only ever appended to, and it uses the same number formats as a
+ * binary project file.  The journal starts with a header:
+ *
+ * - 8 bytes: ::JOURNAL_MAGIC
+ * - 32 bits: format version, ::JOURNAL_VERSION
+ * - 32 bits: length of the project file name in bytes, followed by
+ *   the name, which is empty for a project that was never saved, and
+ *   zeros up to a multiple of four bytes
+ *
+ * The header is followed by blocks, each of which brings the project
+ * up to date with the time it was written:
+ *
+ * - 32 bits: length of the block contents in bytes
+ * - the block contents:
+ *   - 32 bits: number of sets in the project
+ *   - 32 bits: number of set records that follow
+ *   - for each set record: 32 bits set index, float frequency, float
+ *     amplitude, 32 bits number of harmonics, and that many pairs of
+ *     a 32-bit harmonic number and a float amplitude
+ * - 32 bits: checksum of the block contents
+ *
+ * Only the sets that changed since the previous block are recorded,
+ * but the first block holds every set.  A block that was only partly
+ * written when the program crashed fails its checksum, so it and
+ * everything after it is ignored.
+ */
+/*@{*/
+
+/** Identifies an autosave journal.  */
+#define JOURNAL_MAGIC "SLIWJ\r\n\032"
+/** Length of ::JOURNAL_MAGIC.  */
+#define JOURNAL_MAGIC_SIZE 8
+/** Version of the autosave journal format that is written.  */
+#define JOURNAL_VERSION 1
+
+/*@}*/
+
+/**
+ * Adds bytes to a 32-bit FNV-1a hash.
+ */
+static guint32
+hash_bytes (guint32 hash, const void * data, gsize length)
+{
+  const guint8 *bytes = (const guint8 *) data;
+  gsize i;
+  for (i = 0; i < length; i++)
+    hash = (hash ^ bytes[i]) * 16777619;
+  return hash;
+}
+
+/** Starting value of a hash for hash_bytes().  */
+#define HASH_INIT 2166136261U
+
+/**
+ * Computes a hash of the data of a fundamental frequency set, to tell
+ * cheaply whether it changed.
+ */
+guint32
+hash_fund_freq (const Wv_Fund_Freq * fund)
+{
+  guint32 hash = HASH_INIT;
+  hash = hash_bytes (hash, &fund->fund_freq, sizeof (float));
+  hash = hash_bytes (hash, &fund->amplitude, sizeof (float));
+  return hash_bytes (hash, fund->harmonics->d,
+		     sizeof (Wv_Data) * fund->harmonics->len);
+}
+
+/**
+ * Formats the header of an autosave journal.
+ *
+ * @param out the buffer to append the header to
+ * @param project_name the file name of the project, or NULL if it
+ * was never saved
+ */
+void
+journal_format_header (GString * out, const char * project_name)
+{
+  gsize name_len = (project_name != NULL) ? strlen (project_name) : 0;
+  gsize start = out->len;
+  guint8 *dest;
+
+  g_string_set_size (out, start + 16 + (name_len + 3) / 4 * 4);
+  dest = (guint8 *) out->str + start;
+  memcpy (dest, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+  put_le32 (dest + 8, JOURNAL_VERSION);
+  put_le32 (dest + 12, (guint32) name_len);
+  memset (dest + 16, 0, (name_len + 3) / 4 * 4);
+  if (name_len > 0)
+    memcpy (dest + 16, project_name, name_len);
+}
+
+/**
+ * Formats a block of an autosave journal.
+ *
+ * @param out the buffer to append the block to
+ * @param model the current project
+ * @param changed for each set of @a model, whether to record it, or
+ * NULL to record every set
+ */
+void
+journal_format_block (GString * out, const Wv_Fund_Freq_array * model,
+		      const gboolean * changed)
+{
+  gsize start = out->len;
+  gsize size = 8;
+  guint32 num_records = 0;
+  guint8 *block;
+  guint8 *dest;
+  unsigned i, j;
+
+  for (i = 0; i < model->len; i++)
+    {
+      if (changed != NULL && !changed[i])
+	continue;
+      size += 16 + 8 * (gsize) model->d[i].harmonics->len;
+      num_records++;
+    }
+  g_string_set_size (out, start + 4 + size + 4);
+  block = (guint8 *) out->str + start + 4;
+  put_le32 (block - 4, (guint32) size);
+  put_le32 (block, model->len);
+  put_le32 (block + 4, num_records);
+
+  dest = block + 8;
+  for (i = 0; i < model->len; i++)
+    {
+      const Wv_Data_array *harmonics = model->d[i].harmonics;
+      if (changed != NULL && !changed[i])
+	continue;
+      put_le32 (dest, i);
+      put_le_float (dest + 4, model->d[i].fund_freq);
+      put_le_float (dest + 8, model->d[i].amplitude);
+      put_le32 (dest + 12, harmonics->len);
+      dest += 16;
+      for (j = 0; j < harmonics->len; j++)
+	{
+	  put_le32 (dest, harmonics->d[j].harmc_num);
+	  put_le_float (dest + 4, harmonics->d[j].amplitude);
+	  dest += 8;
+	}
+    }
+  put_le32 (dest, hash_bytes (HASH_INIT, block, size));
+}
+
+/**
+ * Appends data to the end of an existing file.
+ *
+ * @param filename the file to append to, which must exist
+ * @param contents the data to append
+ * @param length the length of @a contents in bytes
+ * @param sync if TRUE, the data is flushed to the disk before
+ * returning
+ * @return ::CORE_OK on success, or ::CORE_ERROR_IO with @c errno set
+ */
+Core_Error
+append_file (const char * filename, const gchar * contents, gsize length,
+	     gboolean sync)
+{
+  int fd;
+  int saved_errno;
+
+  fd = g_open (filename, O_WRONLY | O_APPEND | O_BINARY, 0);
+  if (fd == -1)
+    return CORE_ERROR_IO;
+  if (!write_all (fd, contents, length) || (sync && fsync (fd) != 0))
+    {
+      saved_errno = errno;
+      close (fd);
+      errno = saved_errno;
+      return CORE_ERROR_IO;
+    }
+  if (close (fd) != 0)
+    return CORE_ERROR_IO;
+  return CORE_OK;
+}
+
+/**
+ * Changes the number of sets in a project that is not shown in a
+ * user interface, adding default sets or removing sets from the end.
+ */
+static void
+resize_model (Wv_Fund_Freq_array * model, unsigned num_sets)
+{
+  while (model->len < num_sets)
+    model_array_add_fund_freq (model);
+  while (model->len > num_sets)
+    {
+      g_array_free ((GArray *) model->d[model->len-1].harmonics, TRUE);
+      g_array_set_size ((GArray *) model, model->len - 1);
+    }
+}
+
+/**
+ * Applies one block of an autosave journal whose checksum was already
+ * verified.
+ *
+ * @return TRUE on success, FALSE if the block does not make sense
+ */
+static gboolean
+apply_journal_block (Wv_Fund_Freq_array * model, const guint8 * block,
+		     gsize size)
+{
+  const guint8 *end = block + size;
+  guint32 num_sets, num_records;
+  guint32 i, j;
+
+  if (size < 8)
+    return FALSE;
+  num_sets = get_le32 (block);
+  num_records = get_le32 (block + 4);
+  if (num_sets == 0)
+    return FALSE;
+  resize_model (model, num_sets);
+
+  block += 8;
+  for (i = 0; i < num_records; i++)
+    {
+      Wv_Fund_Freq *cur_fund;
+      guint32 index, count;
+      if (end - block < 16)
+	return FALSE;
+      index = get_le32 (block);
+      count = get_le32 (block + 12);
+      if (index >= num_sets || (gsize) (end - block - 16) / 8 < count)
+	return FALSE;
+      cur_fund = &model->d[index];
+      cur_fund->fund_freq = get_le_float (block + 4);
+      cur_fund->amplitude = get_le_float (block + 8);
+      block += 16;
+      g_array_set_size ((GArray *) cur_fund->harmonics, count);
+      for (j = 0; j < count; j++)
+	{
+	  cur_fund->harmonics->d[j].harmc_num = get_le32 (block);
+	  cur_fund->harmonics->d[j].amplitude = get_le_float (block + 4);
+	  block += 8;
+	}
+      harmonics_sort (cur_fund->harmonics);
+    }
+  return block == end;
+}
+
+/**
+ * Recovers a project from an autosave journal into an empty project.
+ *
+ * Every complete block is applied in order.  Reading stops quietly at
+ * a block that was cut short or fails its checksum, since that is
+ * what a crash in the middle of writing leaves behind.
+ * @param model the project to read into
+ * @param filename the name of the journal
+ * @param project_name where to store the file name of the project
+ * that the journal belongs to, which is NULL if it was never saved
+ * and must be freed with g_free() otherwise
+ * @return ::CORE_OK on success, ::CORE_ERROR_IO with @c errno set if
+ * the journal could not be read, or ::CORE_ERROR_SYNTAX if it does
+ * not hold a single complete block
+ */
+Core_Error
+read_journal (Wv_Fund_Freq_array * model, const char * filename,
+	      gchar ** project_name)
+{
+  gchar *contents;
+  gsize length;
+  GError *error = NULL;
+  const guint8 *pos;
+  const guint8 *end;
+  guint32 name_len;
+  unsigned num_blocks = 0;
+
+  *project_name = NULL;
+  if (!g_file_get_contents (filename, &contents, &length, &error))
+    {
+      set_errno_from_error (error);
+      g_error_free (error);
+      return CORE_ERROR_IO;
+    }
+  pos = (const guint8 *) contents;
+  end = pos + length;
+
+  if (length < 16 || memcmp (pos, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE) ||
+      get_le32 (pos + 8) != JOURNAL_VERSION)
+    goto cleanup;
+  name_len = get_le32 (pos + 12);
+  if ((gsize) (end - pos - 16) < (name_len + (guint64) 3) / 4 * 4)
+    goto cleanup;
+  if (name_len > 0)
+    *project_name = g_strndup ((const gchar *) pos + 16, name_len);
+  pos += 16 + (name_len + (gsize) 3) / 4 * 4;
+
+  while (end - pos >= 8)
+    {
+      guint32 size = get_le32 (pos);
+      if ((gsize) (end - pos - 8) < size ||
+	  get_le32 (pos + 4 + size) != hash_bytes (HASH_INIT, pos + 4, size) ||
+	  !apply_journal_block (model, pos + 4, size))
+	break;
+      pos += 8 + size;
+      num_blocks++;
+    }
+
+ cleanup:
+  g_free (contents);
+  if (num_blocks == 0)
+    {
+      g_free (*project_name);
+      *project_name = NULL;
+      return CORE_ERROR_SYNTAX;
+    }
+  return CORE_OK;
+}
@@ -0,0 +1,428 @@
+/* Rendering of the composite waveform.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <glib.h>
+
+#include "slidercore.h"
+#include "tile_pool.h"
+
+/** Contains the maximum y-point that is set during wave rendering.  */
+float max_ypt;
+
+/**
+ * Calculates the maximum frequency extent of the interesting parts of
+ * a composite waveform.
+ *
+ * This function calculates the reciprocal of the maximum time extent
+ * needed to view the interesting parts of the current sound effect in
+ * ::wv_all_freqs.
+ * @return the reciprocal of the time extent
+ */
+float calc_freq_extent (void)
+{
+  unsigned i;
+  float most_fnd_frq;
+  float next_most_fnd_frq;
+  float least_fnd_frq;
+  float freq_ext;
+
+  /* Find the highest, next highest, and lowest fundamental
+     frequencies in a single pass.  The next highest frequency is the
+     highest one that is different from the highest frequency, or zero
+     if all of the fundamental frequencies are equal.  */
+  most_fnd_frq = wv_all_freqs->d[0].fund_freq;
+  next_most_fnd_frq = 0;
+  least_fnd_frq = most_fnd_frq;
+  for (i = 1; i < wv_all_freqs->len; i++)
+    {
+      float fund_freq = wv_all_freqs->d[i].fund_freq;
+      if (fund_freq > most_fnd_frq)
+	{
+	  next_most_fnd_frq = most_fnd_frq;
+	  most_fnd_frq = fund_freq;
+	}
+      else if (fund_freq < most_fnd_frq && fund_freq > next_most_fnd_frq)
+	next_most_fnd_frq = fund_freq;
+      least_fnd_frq = MIN (fund_freq, least_fnd_frq);
+    }
+
+  freq_ext = most_fnd_frq - next_most_fnd_frq;
+  /* When the frequency difference is greater than 100%, then the
+     display window should only reach to the extent of the component
+     with the longest wavelength.  */
+  if (freq_ext / next_most_fnd_frq > 1.00)
+    freq_ext = least_fnd_frq;
+  return freq_ext;
+}
+
+/** Shared state for rendering the tiles of a composite waveform.  */
+typedef struct _Render_Job Render_Job;
+struct _Render_Job
+{
+  float *ypts;
+  unsigned num_samples;
+  float x_max;
+  float *tile_maxs; /**< Peak displacement of each tile */
+};
+
+static void
+render_tile (unsigned start, unsigned end, unsigned tile_idx, gpointer data)
+{
+  Render_Job *job = (Render_Job *) data;
+  float tile_max = 0.0;
+  unsigned i;
+  for (i = start; i < end; i++)
+    job->ypts[i] = 0.0; /* Don't use memset ().  That will not set the
+			   actual value to "0.0".  */
+
+  for (i = 0; i < wv_all_freqs->len; i++)
+    plot_waveform_range (job->ypts, job->num_samples, job->x_max, i, 1,
+			 start, end);
+
+  for (i = start; i < end; i++)
+    tile_max = MAX(ABS(job->ypts[i]), tile_max);
+  job->tile_maxs[tile_idx] = tile_max;
+}
+
+/**
+ * Renders a composite waveform.
+ *
+ * Renders a waveform composed of all the fundamental frequency sets.
+ * The samples are split into tiles that are rendered in parallel.
+ * Every sample is computed by exactly the same operations as in a
+ * serial render, so the result does not depend on the number of
+ * threads.
+ * @param ypts the array that will hold the rendered samples, which
+ * must be sufficiently allocated
+ * @param num_samples the number of points to plot
+ * @param x_max the maximum x-axis extent for rendering
+ */
+void
+render_waves (float * ypts, unsigned num_samples, float x_max)
+{
+  float pre_max_ypt = 0.0;
+  Render_Job job;
+  unsigned num_tiles = tile_pool_num_tiles (num_samples);
+  unsigned i;
+
+  job.ypts = ypts;
+  job.num_samples = num_samples;
+  job.x_max = x_max;
+  job.tile_maxs = (float *) g_malloc (sizeof (float) * MAX (num_tiles, 1));
+  tile_pool_run (num_samples, render_tile, &job);
+
+  for (i = 0; i < num_tiles; i++)
+    pre_max_ypt = MAX(job.tile_maxs[i], pre_max_ypt);
+  max_ypt = pre_max_ypt;
+  g_free (job.tile_maxs);
+}
+
+/**
+ * Chooses the number of samples to render per pixel column.
+ *
+ * When the time extent of the display covers many cycles of the
+ * highest frequency component, sampling once per column aliases into
+ * a meaningless picture.  The oversampling factor is picked from the
+ * highest active frequency so that each cycle gets about four
+ * samples.  It is capped by #MAX_OVERSAMPLE and #RENDER_WORK_BUDGET
+ * so that rendering time stays bounded.
+ * @param num_cols the number of pixel columns to render
+ * @param x_max the maximum x-axis extent for rendering
+ * @return the number of samples per column, at least one
+ */
+unsigned
+calc_oversample (unsigned num_cols, float x_max)
+{
+  float high_freq = 0.0;
+  unsigned num_partials = 0;
+  unsigned oversample;
+  float cycles_per_col;
+  guint64 work_per_sample;
+  unsigned max_by_budget;
+  unsigned i;
+
+  if (num_cols == 0)
+    return 1;
+
+  /* Find the highest frequency that actually contributes to the
+     waveform.  */
+  for (i = 0; i < wv_all_freqs->len; i++)
+    {
+      Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[i];
+      unsigned j;
+      if (cur_fund->amplitude != 0.0)
+	high_freq = MAX (cur_fund->fund_freq, high_freq);
+      /* Harmonics are sorted, so the first audible one from the top
+	 is the highest.  */
+      for (j = cur_fund->harmonics->len; j > 0; j--)
+	{
+	  if (cur_fund->harmonics->d[j-1].amplitude == 0.0)
+	    continue;
+	  high_freq = MAX (cur_fund->fund_freq *
+			   cur_fund->harmonics->d[j-1].harmc_num, high_freq);
+	  break;
+	}
+      num_partials += 1 + cur_fund->harmonics->len;
+    }
+
+  cycles_per_col = high_freq * x_max / num_cols;
+  oversample = (unsigned) ceilf (cycles_per_col * 4);
+  oversample = CLAMP (oversample, 1, MAX_OVERSAMPLE);
+  /* The product can exceed the range of an unsigned int for very wide
+     renders of large projects.  */
+  work_per_sample = (guint64) num_cols * MAX (num_partials, 1);
+  max_by_budget = (unsigned) (RENDER_WORK_BUDGET / work_per_sample);
+  oversample = MIN (oversample, MAX (max_by_budget, 1));
+  return oversample;
+}
+
+/**
+ * Reduces oversampled points to the minimum and maximum of each pixel
+ * column.
+ *
+ * @param ypts the rendered points, @a oversample for each column
+ * @param ymins the array that will hold the minimum of each column
+ * @param ymaxs the array that will hold the maximum of each column
+ * @param num_cols the number of pixel columns
+ * @param oversample the number of points per column
+ */
+void
+reduce_columns (const float * ypts, float * ymins, float * ymaxs,
+		unsigned num_cols, unsigned oversample)
+{
+  unsigned i;
+  for (i = 0; i < num_cols; i++)
+    {
+      const float *col = &ypts[i*oversample];
+      float col_min = col[0];
+      float col_max = col[0];
+      unsigned j;
+      for (j = 1; j < oversample; j++)
+	{
+	  col_min = MIN (col[j], col_min);
+	  col_max = MAX (col[j], col_max);
+	}
+      ymins[i] = col_min;
+      ymaxs[i] = col_max;
+    }
+}
+
+/**
+ * Renders the minimum and maximum of a composite waveform for each
+ * pixel column.
+ *
+ * The waveform is oversampled as chosen by calc_oversample() and each
+ * column's samples are reduced to an envelope.  When no oversampling
+ * is needed, the result is identical to render_waves().
+ * @param ymins the array that will hold the minimum of each column
+ * @param ymaxs the array that will hold the maximum of each column
+ * @param num_cols the number of pixel columns to render
+ * @param x_max the maximum x-axis extent for rendering
+ */
+void
+render_waves_minmax (float * ymins, float * ymaxs, unsigned num_cols,
+		     float x_max)
+{
+  unsigned oversample = calc_oversample (num_cols, x_max);
+  float *ypts;
+
+  ypts = (float *) g_malloc (sizeof (float) * num_cols * oversample);
+  render_waves (ypts, num_cols * oversample, x_max);
+  reduce_columns (ypts, ymins, ymaxs, num_cols, oversample);
+  g_free (ypts);
+}
+
+/**
+ * Lists every sine wave component of the composite waveform.
+ *
+ * Each fundamental frequency set contributes its fundamental followed
+ * by its harmonics in array order, so the position of a partial in
+ * the list stays the same as long as no harmonics or sets are added
+ * or removed.
+ * @param num_partials location to store the number of partials
+ * @return a newly allocated array of partials, which must be freed
+ * with g_free()
+ */
+Partial *
+gather_partials (unsigned * num_partials)
+{
+  Partial *partials;
+  unsigned count = 0;
+  unsigned i;
+  unsigned j;
+
+  for (i = 0; i < wv_all_freqs->len; i++)
+    count += 1 + wv_all_freqs->d[i].harmonics->len;
+  partials = (Partial *) g_malloc (sizeof (Partial) * MAX (count, 1));
+  count = 0;
+  for (i = 0; i < wv_all_freqs->len; i++)
+    {
+      Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[i];
+      partials[count].freq = cur_fund->fund_freq;
+      partials[count].fund_freq = cur_fund->fund_freq;
+      partials[count].harmc_num = 1;
+      partials[count++].amplitude = cur_fund->amplitude;
+      for (j = 0; j < cur_fund->harmonics->len; j++)
+	{
+	  unsigned harmc_num = cur_fund->harmonics->d[j].harmc_num;
+	  partials[count].freq = cur_fund->fund_freq * harmc_num;
+	  partials[count].fund_freq = cur_fund->fund_freq;
+	  partials[count].harmc_num = harmc_num;
+	  partials[count++].amplitude = cur_fund->harmonics->d[j].amplitude;
+	}
+    }
+  *num_partials = count;
+  return partials;
+}
+
+/** qsort() comparison function that sorts partials by decreasing
+    magnitude of amplitude.  */
+static int
+partial_amp_cmp (const void * a, const void * b)
+{
+  float amp_a = ABS (((const Partial *) a)->amplitude);
+  float amp_b = ABS (((const Partial *) b)->amplitude);
+  if (amp_a > amp_b)
+    return -1;
+  if (amp_a < amp_b)
+    return 1;
+  return 0;
+}
+
+/**
+ * Renders a cheap approximation of a waveform.
+ *
+ * Only the @a max_partials partials with the largest amplitudes are
+ * summed.  Unlike render_waves(), this function does not update
+ * ::max_ypt, since the approximation should not influence the audio
+ * level.  It also does not read ::wv_all_freqs, so it may be called
+ * from any thread.
+ * @param ypts the array that will hold the rendered samples, which
+ * must be sufficiently allocated
+ * @param num_samples the number of points to plot
+ * @param x_max the maximum x-axis extent for rendering
+ * @param partials the partials of the waveform, as returned by
+ * gather_partials().  This array is reordered.
+ * @param num_partials the number of elements in @a partials
+ * @param max_partials the maximum number of partials to render
+ * @return the peak displacement of the rendered samples
+ */
+float
+render_waves_coarse (float * ypts, unsigned num_samples, float x_max,
+		     Partial * partials, unsigned num_partials,
+		     unsigned max_partials)
+{
+  float inv_num_samp = 1.0 / num_samples;
+  float peak = 0.0;
+  unsigned i;
+  unsigned j;
+
+  if (num_partials > max_partials)
+    {
+      qsort (partials, num_partials, sizeof (Partial), partial_amp_cmp);
+      num_partials = max_partials;
+    }
+
+  for (i = 0; i < num_samples; i++)
+    {
+      float ypt = 0.0;
+      for (j = 0; j < num_partials; j++)
+	{
+	  ypt += sinf ((float) (i + 1) * inv_num_samp * 2 * G_PI *
+		       partials[j].freq * x_max) * partials[j].amplitude;
+	}
+      ypts[i] = ypt;
+      peak = MAX (ABS (ypt), peak);
+    }
+
+  return peak;
+}
+
+/**
+ * Plots a single fundamental frequency set.
+ *
+ * @param ypts the array that will hold the plotted points, which must
+ * be sufficiently allocated.  The plotted waveform will be added to
+ * the current values.
+ * @param num_samples the number of points to plot
+ * @param x_max the maximum x-axis extent for rendering
+ * @param fund_freq_idx the fundamental frequency set to work with
+ * @param ofs offset in samples from the beginning of the sine wave
+ * cycle
+ */
+void
+plot_waveform (float * ypts, unsigned num_samples, float x_max,
+	       unsigned fund_freq_idx, unsigned ofs)
+{
+  plot_waveform_range (ypts, num_samples, x_max, fund_freq_idx, ofs,
+		       0, num_samples);
+}
+
+/**
+ * Plots part of a single fundamental frequency set.
+ *
+ * This is the same as plot_waveform(), except that only the points
+ * from @a start up to but not including @a end are plotted.
+ */
+void
+plot_waveform_range (float * ypts, unsigned num_samples, float x_max,
+		     unsigned fund_freq_idx, unsigned ofs,
+		     unsigned start, unsigned end)
+{
+  float inv_num_samp = 1.0 / num_samples;
+  float fund_freq = wv_all_freqs->d[fund_freq_idx].fund_freq;
+  float fund_amplitude = wv_all_freqs->d[fund_freq_idx].amplitude;
+  Wv_Data *harmonics = wv_all_freqs->d[fund_freq_idx].harmonics->d;
+  unsigned num_harmonics = wv_all_freqs->d[fund_freq_idx].harmonics->len;
+  unsigned i;
+  unsigned j;
+
+  for (i = start; i < end; i++)
+    {
+      float freq_mult;
+      freq_mult = fund_freq * x_max;
+      ypts[i] += sinf ((float) (i + ofs) * inv_num_samp * 2 * G_PI *
+		       freq_mult) * fund_amplitude;
+      for (j = 0; j < num_harmonics; j++)
+	{
+	  unsigned harmc_num = harmonics[j].harmc_num;
+	  ypts[i] += sinf ((float) (i + ofs) * harmc_num * inv_num_samp *
+			   2 * G_PI * freq_mult) *
+	    harmonics[j].amplitude;
+	}
+    }
+}
@@ -72,18 +72,18 @@ DAMAGE.  */
  *
  * The editing area contains one window that is used to edit the
  * fundamental frequency, and a series of one or more other windows
- * that can be used to edit harmonics.  Both such types of windows are
- * generated from a single function, create_wvedit_holder(), and the
- * parameter @a first_type specifies if a fundamental editor should be
- * returned.
+ * that can be used to edit harmonics.  The fundamental editor is
+ * created by create_fund_editor().  The harmonic windows are managed
+ * by the editor strip in editor_strip.c, which only creates widgets
+ * for the windows that are scrolled into view and recycles them as
+ * the user scrolls.
  *
  * On the top of the main window is a combo box that is used to select
  * the current fundamental frequency being edited.  When a different
- * fundamental frequency is selected, all of the windows currently in
- * the editing area are destroyed and new windows corresponding to the
- * selected fundamental set are created.  Data is stored within the
- * program's data model to save the state of the previous editor
- * windows.
+ * fundamental frequency is selected, the fundamental editor is
+ * recreated and the harmonic windows' widgets are rebound to the
+ * selected fundamental set.  Data is stored within the program's data
+ * model to save the state of the previous editor windows.
  *
  * Moving on from here, you should be able to look at the source code
  * in interface.h and wv_editors.h for the implementation of the user
@@ -126,6 +126,43 @@ wv_all_freqs->d[i].harmonics->d[j].harmc_num;
  * allows them to work with a fundamental frequency other than the one
  * which is currently selected.  This is important for file loading.
  *
+ * The wave editor windows and precision sliders referenced from the
+ * data model are allocated from pools in model_pool.c rather than
+ * individually, so that closing a project releases them all at once.
+ * Use alloc_slide_data() and free_slide_data() for precision sliders.
+ *
+ * Every edit to the data model must call undo_record() first, as
+ * described in undo.h.
+ *
+ * The data model itself, the waveform renderer, and project file
+ * input and output are declared in slidercore.h and built into the
+ * libslidercore.a static library, which depends only on GLib.  The
+ * model_*() functions in core_model.c change only the model.  Every
+ * fundamental set has a @a ui pointer to its ::Wv_Fund_Ui, which holds
+ * the wave editor windows and other user interface state, and the
+ * functions in wv_editors.h keep that state in step with the model.
+ * The core reports errors as ::Core_Error values, and it is up to the
+ * caller to tell the user.
+ *
+ * Project files are opened by project_loader.c, which reads them on a
+ * worker thread into a separate model from model_array_new().  Only
+ * when the whole file has been read is the model swapped in with
+ * model_swap(), on the main thread.  The user interface state is then
+ * created with create_fund_uis() a batch of sets at a time.
+ *
+ * Saving works the other way around: project_saver.c takes a copy of
+ * the model with model_copy(), and a worker thread formats it into
+ * memory with format_project() and writes it with
+ * write_file_atomic().  Meanwhile, autosave.c appends the sets that
+ * changed to an autosave journal, which read_journal() can recover
+ * the project from after a crash.
+ *
+ * Playback in audio.c keeps a running phase for every set, so that
+ * the sound follows edits smoothly.  Rendering to a file with
+ * write_wav_file() in core_audio.c instead computes every sample from
+ * its absolute index with render_samples(), so that it can be done in
+ * parallel on the tile pool.  Both share apply_agc() for the volume.
+ *
  * Moving on from here, you should be able to look at the source code
  * in the rest of this program.  I hope you found this document
  * useful.
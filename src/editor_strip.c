@@ -0,0 +1,587 @@
+/* Virtualized strip of harmonic wave editor windows.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "editor_strip.h"
+#include "callbacks.h"
+#include "interface.h"
+#include "wv_editors.h"
+
+/** Pixels above and below the visible area whose wave editor windows
+    are bound as well, so that small scrolls do not bind anything.  */
+#define STRIP_OVERSCAN 64
+
+static GtkAdjustment *strip_vadj = NULL;
+static GtkWidget *strip_cntr = NULL;
+static GtkWidget *top_spacer = NULL;
+static GtkWidget *bottom_spacer = NULL;
+/** Views that are not bound to any wave editor window.  */
+static Harmc_View_Ptr_array *view_pool = NULL;
+/** Views that are bound, in the order of their wave editor windows.  */
+static Harmc_View_Ptr_array *bound_views = NULL;
+/** Height of a view without any precision sliders.  */
+static gint base_height = 0;
+/** Height added to a view by each precision slider.  */
+static gint slider_height = 0;
+static guint update_source = 0;
+
+static gboolean update_idle (gpointer data);
+
+/**
+ * Gets the widget that each signal handler in @a handlers of a view
+ * is connected to.
+ *
+ * @param view the view to work with
+ * @param owners array of ::HARMC_VIEW_HANDLERS entries to fill
+ */
+static void
+get_handler_owners (Harmc_View * view, GtkWidget ** owners)
+{
+  owners[0] = view->harmc_sel;
+  owners[1] = view->harmc_win_add;
+  owners[2] = view->harmc_win_remove;
+  owners[3] = view->harmc_add;
+  owners[4] = view->harmc_remove;
+  owners[5] = view->amp_mntisa;
+  owners[6] = view->amp_mntisa;
+  owners[7] = view->amp_exp;
+  owners[8] = view->amp_precslid_add;
+  owners[9] = view->amp_precslid_remove;
+}
+
+/**
+ * Signal handler for when the bottom pane is scrolled or resized.
+ */
+static void
+vadj_changed (GtkAdjustment * adjustment, gpointer user_data)
+{
+  /* Bind the new windows before GTK+ gets a chance to resize or
+     redraw anything, so that empty space never shows up.  */
+  if (update_source == 0)
+    update_source = g_idle_add_full (G_PRIORITY_HIGH_IDLE, update_idle,
+				     NULL, NULL);
+}
+
+/**
+ * Sets up the editor strip.
+ *
+ * @param scrolled_window the scrolled window of the bottom pane
+ * @param container the box that holds the wave editor windows
+ */
+void
+editor_strip_init (GtkWidget * scrolled_window, GtkWidget * container)
+{
+  strip_cntr = container;
+  strip_vadj = gtk_scrolled_window_get_vadjustment
+    (GTK_SCROLLED_WINDOW (scrolled_window));
+  view_pool = (Harmc_View_Ptr_array *)
+    g_array_new (FALSE, FALSE, sizeof (Harmc_View_Ptr));
+  bound_views = (Harmc_View_Ptr_array *)
+    g_array_new (FALSE, FALSE, sizeof (Harmc_View_Ptr));
+
+  top_spacer = gtk_alignment_new (0, 0, 0, 0);
+  gtk_box_pack_start (GTK_BOX (container), top_spacer, FALSE, FALSE, 0);
+  bottom_spacer = gtk_alignment_new (0, 0, 0, 0);
+  gtk_box_pack_start (GTK_BOX (container), bottom_spacer, FALSE, FALSE, 0);
+
+  g_signal_connect ((gpointer) strip_vadj, "value_changed",
+		    G_CALLBACK (vadj_changed), NULL);
+  g_signal_connect ((gpointer) strip_vadj, "changed",
+		    G_CALLBACK (vadj_changed), NULL);
+}
+
+/**
+ * Gets an unused view, creating one if the pool is empty.
+ */
+static Harmc_View *
+get_view (void)
+{
+  Harmc_View *view;
+  if (view_pool->len > 0)
+    {
+      view = view_pool->d[view_pool->len-1];
+      g_array_set_size ((GArray *) view_pool, view_pool->len - 1);
+      return view;
+    }
+  view = create_harmc_view ();
+  gtk_box_pack_start (GTK_BOX (strip_cntr), view->widget, FALSE, FALSE, 0);
+  return view;
+}
+
+/**
+ * Measures the height of the views.
+ *
+ * Every harmonic wave editor window has the same widgets apart from
+ * its number of precision sliders, so measuring a single view once
+ * is enough to know the height of every window.
+ */
+static void
+measure_views (void)
+{
+  Harmc_View *view;
+  GtkWidget *hscrollbar;
+  GtkRequisition req;
+
+  if (base_height > 0)
+    return;
+
+  /* Use a new view so that its slider box is empty.  */
+  view = create_harmc_view ();
+  gtk_box_pack_start (GTK_BOX (strip_cntr), view->widget, FALSE, FALSE, 0);
+  gtk_widget_size_request (view->widget, &req);
+  base_height = req.height;
+
+  hscrollbar = gtk_hscrollbar_new (NULL);
+  gtk_widget_show (hscrollbar);
+  gtk_box_pack_start (GTK_BOX (view->amp_sliders_vbox), hscrollbar,
+		      TRUE, TRUE, 0);
+  gtk_widget_size_request (view->widget, &req);
+  slider_height = req.height - base_height;
+  gtk_widget_destroy (hscrollbar);
+
+  g_array_append_val ((GArray *) view_pool, view);
+}
+
+/**
+ * Gets the height that a wave editor window takes up in the strip.
+ */
+static gint
+editor_height (Wv_Editor_Data * editor)
+{
+  return base_height + editor->amp_sliders.len * slider_height;
+}
+
+/**
+ * Gets the offsets of the wave editor windows of a fundamental
+ * frequency set, computing them if they are out of date.
+ *
+ * The views must have been measured already.
+ * @return the field @a editor_tops of the set
+ */
+static const gint *
+get_editor_tops (Wv_Fund_Ui * ui)
+{
+  Wv_Editor_Data_Ptr_array *editors = ui->wv_editors;
+  unsigned i;
+
+  if (ui->editor_tops != NULL)
+    return ui->editor_tops;
+  ui->editor_tops = g_new (gint, editors->len + 1);
+  ui->editor_tops[0] = 0;
+  for (i = 0; i < editors->len; i++)
+    ui->editor_tops[i+1] = ui->editor_tops[i] + editor_height (editors->d[i]);
+  return ui->editor_tops;
+}
+
+/**
+ * Finds the first offset in a range of @a tops that is greater than
+ * @a pos.
+ *
+ * @return the index of the offset, or @a end if there is none
+ */
+static unsigned
+bisect_tops (const gint * tops, unsigned begin, unsigned end, gint pos)
+{
+  while (begin < end)
+    {
+      unsigned mid = begin + (end - begin) / 2;
+      if (tops[mid] > pos)
+	end = mid;
+      else
+	begin = mid + 1;
+    }
+  return begin;
+}
+
+/**
+ * Marks the offsets of the wave editor windows of a fundamental
+ * frequency set as out of date.
+ *
+ * This must be called whenever wave editor windows or their
+ * precision sliders are added or removed.
+ * @param fund_freq the fundamental frequency set to work with
+ */
+void
+editor_strip_invalidate (unsigned fund_freq)
+{
+  Wv_Fund_Ui *ui = wv_all_freqs->d[fund_freq].ui;
+  g_free (ui->editor_tops);
+  ui->editor_tops = NULL;
+}
+
+/**
+ * Binds a view to a wave editor window.
+ *
+ * All of the widgets are set to the window's values before any
+ * signal handlers are connected, so binding does not change the data
+ * model.  The window already has the data of its precision sliders,
+ * and only their scrollbars are created here.
+ * @param view an unused view
+ * @param editor the wave editor window to bind it to
+ */
+static void
+bind_view (Harmc_View * view, Wv_Editor_Data * editor)
+{
+  Slide_Data_List *sliders = &editor->amp_sliders;
+  GList *children;
+  GList *child;
+  unsigned j;
+
+  view->editor = editor;
+  editor->view = view;
+  editor->widget = view->widget;
+  editor->harmc_sel = view->harmc_sel;
+  editor->harmc_win_rm_btn = view->harmc_win_remove;
+  editor->amp_mntisa = view->amp_mntisa;
+  editor->amp_exp = view->amp_exp;
+  editor->amp_slid_rm_btn = view->amp_precslid_remove;
+  editor->amp_sliders_vbox = view->amp_sliders_vbox;
+
+  gtk_combo_box_set_model (GTK_COMBO_BOX (view->harmc_sel),
+			   GTK_TREE_MODEL (get_harmc_store (g_fund_set)));
+  gtk_combo_box_set_active (GTK_COMBO_BOX (view->harmc_sel),
+			    editor->data->group_idx);
+  sci_notation_set_values (GTK_ENTRY (view->amp_mntisa),
+			   GTK_SPIN_BUTTON (view->amp_exp),
+			   editor->data->amplitude);
+
+  /* Reuse the scrollbars left over from the last window that was
+     bound to this view.  */
+  children =
+    gtk_container_get_children (GTK_CONTAINER (view->amp_sliders_vbox));
+  child = children;
+  for (j = 0; j < sliders->len; j++)
+    {
+      Slide_Data *sd_block = sliders->d[j];
+      GtkWidget *hscrollbar;
+      if (child != NULL)
+	{
+	  hscrollbar = GTK_WIDGET (child->data);
+	  child = child->next;
+	  gtk_range_set_value (GTK_RANGE (hscrollbar), sd_block->last_value);
+	}
+      else
+	{
+	  hscrollbar =
+	    gtk_hscrollbar_new (GTK_ADJUSTMENT
+		(gtk_adjustment_new (sd_block->last_value,
+				     0, 21, 0.1, 1.0, 1.0)));
+	  gtk_widget_show (hscrollbar);
+	  gtk_box_pack_start (GTK_BOX (view->amp_sliders_vbox), hscrollbar,
+			      TRUE, TRUE, 0);
+	}
+      sd_block->widget = hscrollbar;
+      g_signal_connect ((gpointer) hscrollbar, "value_changed",
+			G_CALLBACK (precslid_value_changed),
+			(gpointer) sd_block);
+    }
+  for (; child != NULL; child = child->next)
+    gtk_widget_destroy (GTK_WIDGET (child->data));
+  g_list_free (children);
+
+  view->handlers[0] =
+    g_signal_connect ((gpointer) view->harmc_sel, "changed",
+		      G_CALLBACK (harmc_sel_changed), (gpointer) editor);
+  view->handlers[1] =
+    g_signal_connect ((gpointer) view->harmc_win_add, "clicked",
+		      G_CALLBACK (harmc_win_add_clicked), (gpointer) editor);
+  view->handlers[2] =
+    g_signal_connect ((gpointer) view->harmc_win_remove, "clicked",
+		      G_CALLBACK (harmc_win_remove_clicked),
+		      (gpointer) editor);
+  view->handlers[3] =
+    g_signal_connect ((gpointer) view->harmc_add, "clicked",
+		      G_CALLBACK (harmc_add_clicked), (gpointer) editor);
+  view->handlers[4] =
+    g_signal_connect ((gpointer) view->harmc_remove, "clicked",
+		      G_CALLBACK (harmc_remove_clicked), (gpointer) editor);
+  view->handlers[5] =
+    g_signal_connect ((gpointer) view->amp_mntisa, "activate",
+		      G_CALLBACK (amp_mntisa_activate), (gpointer) editor);
+  view->handlers[6] =
+    g_signal_connect ((gpointer) view->amp_mntisa, "focus-out-event",
+		      G_CALLBACK (amp_mntisa_focus_out), (gpointer) editor);
+  view->handlers[7] =
+    g_signal_connect ((gpointer) view->amp_exp, "value_changed",
+		      G_CALLBACK (amp_exp_value_changed), (gpointer) editor);
+  view->handlers[8] =
+    g_signal_connect ((gpointer) view->amp_precslid_add, "clicked",
+		      G_CALLBACK (precslid_add_clicked),
+		      (gpointer) sliders->d[0]);
+  view->handlers[9] =
+    g_signal_connect ((gpointer) view->amp_precslid_remove, "clicked",
+		      G_CALLBACK (precslid_remove_clicked),
+		      (gpointer) sliders->d[0]);
+
+  gtk_widget_set_sensitive (view->amp_precslid_remove, sliders->len > 1);
+  update_slider_bases (GTK_ENTRY (view->amp_mntisa), editor, FALSE);
+  gtk_widget_show (view->widget);
+}
+
+/**
+ * Unbinds a view from its wave editor window and returns it to the
+ * pool.
+ */
+static void
+unbind_view (Harmc_View * view)
+{
+  Wv_Editor_Data *editor = view->editor;
+  GtkWidget *owners[HARMC_VIEW_HANDLERS];
+  unsigned i;
+
+  /* Hide the view before disconnecting anything, so that an amplitude
+     entry that loses the focus still stores its value.  */
+  precslid_flush ();
+  gtk_widget_hide (view->widget);
+
+  get_handler_owners (view, owners);
+  for (i = 0; i < HARMC_VIEW_HANDLERS; i++)
+    g_signal_handler_disconnect ((gpointer) owners[i], view->handlers[i]);
+  for (i = 0; i < editor->amp_sliders.len; i++)
+    {
+      Slide_Data *sd_block = editor->amp_sliders.d[i];
+      g_signal_handlers_disconnect_by_func
+	((gpointer) sd_block->widget, G_CALLBACK (precslid_value_changed),
+	 (gpointer) sd_block);
+      sd_block->widget = NULL;
+    }
+
+  editor->view = NULL;
+  editor->widget = NULL;
+  editor->harmc_sel = NULL;
+  editor->harmc_win_rm_btn = NULL;
+  editor->amp_mntisa = NULL;
+  editor->amp_exp = NULL;
+  editor->amp_slid_rm_btn = NULL;
+  editor->amp_sliders_vbox = NULL;
+  view->editor = NULL;
+  g_array_append_val ((GArray *) view_pool, view);
+}
+
+/**
+ * Resizes a spacer, hiding it when it should take up no space.
+ */
+static void
+set_spacer_height (GtkWidget * spacer, gint height)
+{
+  gint last_height;
+  if (height <= 0)
+    {
+      gtk_widget_hide (spacer);
+      return;
+    }
+  gtk_widget_get_size_request (spacer, NULL, &last_height);
+  if (last_height != height)
+    gtk_widget_set_size_request (spacer, -1, height);
+  gtk_widget_show (spacer);
+}
+
+/**
+ * Binds views to the wave editor windows that are scrolled into view.
+ *
+ * This must be called whenever wave editor windows are added or
+ * removed or the selected fundamental frequency set changes.
+ * Scrolling and resizing the bottom pane calls this automatically.
+ */
+void
+editor_strip_update (void)
+{
+  Wv_Editor_Data_Ptr_array *editors;
+  const gint *tops;
+  GtkWidget *fund_widget;
+  gint fund_height = 0;
+  gint top, bottom;
+  gint pos;
+  gint top_height, bottom_height;
+  unsigned first, last;
+  unsigned i;
+
+  if (update_source != 0)
+    {
+      g_source_remove (update_source);
+      update_source = 0;
+    }
+  if (strip_cntr == NULL || wv_all_freqs == NULL)
+    return;
+  editors = wv_all_freqs->d[g_fund_set].ui->wv_editors;
+  fund_widget = wv_all_freqs->d[g_fund_set].ui->fund_editor.widget;
+
+  measure_views ();
+  tops = get_editor_tops (wv_all_freqs->d[g_fund_set].ui);
+  if (fund_widget != NULL)
+    {
+      GtkRequisition req;
+      gtk_widget_size_request (fund_widget, &req);
+      fund_height = req.height;
+    }
+
+  /* Find the windows that overlap the visible area.  */
+  top = (gint) strip_vadj->value - STRIP_OVERSCAN - fund_height;
+  bottom = (gint) (strip_vadj->value + strip_vadj->page_size) +
+    STRIP_OVERSCAN - fund_height;
+  first = bisect_tops (tops, 1, editors->len + 1, top) - 1;
+  last = bisect_tops (tops, first, editors->len, bottom - 1);
+  top_height = tops[first];
+  bottom_height = tops[editors->len] - tops[last];
+
+  /* Recycle the views that went out of range, then bind the windows
+     that came into range.  */
+  for (i = 0; i < bound_views->len; i++)
+    {
+      unsigned index = bound_views->d[i]->editor->index;
+      if (index < first || index >= last)
+	unbind_view (bound_views->d[i]);
+    }
+  g_array_set_size ((GArray *) bound_views, 0);
+  for (i = first; i < last; i++)
+    {
+      Wv_Editor_Data *cur_editor = editors->d[i];
+      if (cur_editor->view == NULL)
+	bind_view (get_view (), cur_editor);
+      gtk_widget_set_sensitive (cur_editor->harmc_win_rm_btn,
+				editors->len > 1);
+      g_array_append_val ((GArray *) bound_views, cur_editor->view);
+    }
+
+  set_spacer_height (top_spacer, top_height);
+  set_spacer_height (bottom_spacer, bottom_height);
+  pos = 0;
+  if (fund_widget != NULL)
+    gtk_box_reorder_child (GTK_BOX (strip_cntr), fund_widget, pos++);
+  gtk_box_reorder_child (GTK_BOX (strip_cntr), top_spacer, pos++);
+  for (i = 0; i < bound_views->len; i++)
+    gtk_box_reorder_child (GTK_BOX (strip_cntr), bound_views->d[i]->widget,
+			   pos++);
+  gtk_box_reorder_child (GTK_BOX (strip_cntr), bottom_spacer, pos++);
+}
+
+/**
+ * Idle callback that runs a queued editor_strip_update().
+ */
+static gboolean
+update_idle (gpointer data)
+{
+  update_source = 0;
+  editor_strip_update ();
+  return FALSE;
+}
+
+/**
+ * Updates the harmonic selection and amplitude shown by every bound
+ * view.
+ *
+ * This is needed when wave editor windows are moved to a different
+ * harmonic by something other than their own combo box, such as when
+ * a harmonic is removed.
+ */
+void
+editor_strip_refresh (void)
+{
+  unsigned i;
+  for (i = 0; i < bound_views->len; i++)
+    {
+      Harmc_View *view = bound_views->d[i];
+      Wv_Editor_Data *editor = view->editor;
+      g_signal_handler_block ((gpointer) view->harmc_sel, view->handlers[0]);
+      g_signal_handler_block ((gpointer) view->amp_exp, view->handlers[7]);
+      gtk_combo_box_set_active (GTK_COMBO_BOX (view->harmc_sel),
+				editor->data->group_idx);
+      sci_notation_set_values (GTK_ENTRY (view->amp_mntisa),
+			       GTK_SPIN_BUTTON (view->amp_exp),
+			       editor->data->amplitude);
+      g_signal_handler_unblock ((gpointer) view->amp_exp, view->handlers[7]);
+      g_signal_handler_unblock ((gpointer) view->harmc_sel,
+				view->handlers[0]);
+    }
+}
+
+/**
+ * Returns the view bound to a wave editor window to the pool.
+ *
+ * This must be called before the wave editor window is freed.
+ */
+void
+editor_strip_release (Wv_Editor_Data * editor)
+{
+  unsigned i;
+  for (i = 0; i < bound_views->len; i++)
+    {
+      if (bound_views->d[i] == editor->view)
+	{
+	  g_array_remove_index ((GArray *) bound_views, i);
+	  break;
+	}
+    }
+  unbind_view (editor->view);
+}
+
+/**
+ * Returns all bound views to the pool.
+ *
+ * This must be called before a different fundamental frequency set
+ * is selected.
+ */
+void
+editor_strip_release_all (void)
+{
+  unsigned i;
+  for (i = 0; i < bound_views->len; i++)
+    unbind_view (bound_views->d[i]);
+  g_array_set_size ((GArray *) bound_views, 0);
+}
+
+/**
+ * Frees the editor strip's data structures.
+ *
+ * The widgets themselves are destroyed along with the main window.
+ */
+void
+editor_strip_shutdown (void)
+{
+  unsigned i;
+  if (update_source != 0)
+    g_source_remove (update_source);
+  for (i = 0; i < bound_views->len; i++)
+    {
+      bound_views->d[i]->editor->view = NULL;
+      g_slice_free1 (sizeof (Harmc_View), bound_views->d[i]);
+    }
+  for (i = 0; i < view_pool->len; i++)
+    g_slice_free1 (sizeof (Harmc_View), view_pool->d[i]);
+  g_array_free ((GArray *) bound_views, TRUE);
+  g_array_free ((GArray *) view_pool, TRUE);
+  bound_views = NULL;
+  view_pool = NULL;
+}
@@ -0,0 +1,89 @@
+/* Virtualized strip of harmonic wave editor windows.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Virtualized strip of harmonic wave editor windows.
+ *
+ * A project can have many harmonic wave editor windows, but only a
+ * few of them fit in the bottom pane at once.  Rather than creating
+ * widgets for every window, the editor strip keeps a pool of widget
+ * groups (::Harmc_View) and binds them only to the windows that are
+ * scrolled into view.  The space taken up by the windows above and
+ * below the visible ones is filled with two spacers, so the scroll
+ * bar behaves as if all the windows were present.  The offset of every
+ * window is kept as a running sum of the window heights, so the
+ * visible windows are found by a binary search.
+ */
+
+#ifndef EDITOR_STRIP_H
+#define EDITOR_STRIP_H
+
+#include "wv_editors.h"
+
+/** Number of signal handlers connected when a view is bound.  */
+#define HARMC_VIEW_HANDLERS 10
+
+typedef struct _Harmc_View Harmc_View;
+
+/**
+ * A recyclable group of widgets for a harmonic wave editor window.
+ */
+struct _Harmc_View
+{
+  GtkWidget *widget; /**< Frame holding all of the other widgets */
+  GtkWidget *harmc_sel;
+  GtkWidget *harmc_win_add;
+  GtkWidget *harmc_win_remove;
+  GtkWidget *harmc_add;
+  GtkWidget *harmc_remove;
+  GtkWidget *amp_mntisa;
+  GtkWidget *amp_exp;
+  GtkWidget *amp_precslid_add;
+  GtkWidget *amp_precslid_remove;
+  GtkWidget *amp_sliders_vbox;
+  /** The wave editor window this is bound to, or NULL if unused */
+  Wv_Editor_Data *editor;
+  /** Signal handlers connected for @a editor */
+  gulong handlers[HARMC_VIEW_HANDLERS];
+};
+
+typedef Harmc_View* Harmc_View_Ptr;
+GA_WTYPE(Harmc_View_Ptr);
+
+void editor_strip_init (GtkWidget * scrolled_window, GtkWidget * container);
+void editor_strip_update (void);
+void editor_strip_invalidate (unsigned fund_freq);
+void editor_strip_refresh (void);
+void editor_strip_release (Wv_Editor_Data * editor);
+void editor_strip_release_all (void);
+void editor_strip_shutdown (void);
+
+#endif /* not EDITOR_STRIP_H */
@@ -0,0 +1,195 @@
+/* Fast Fourier transform of real signals.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "fft.h"
+
+struct _Fft_Plan
+{
+  /** Number of real input samples, which is a power of two */
+  unsigned size;
+  /** Size of the half-length complex transform */
+  unsigned half;
+  /** Bit reversal permutation of the half-length transform */
+  unsigned *bitrev;
+  /** Real and imaginary parts of exp(-2 pi i k / size) for
+      0 <= k < size / 2 */
+  float *tw_re;
+  float *tw_im;
+  /** Working memory for the half-length transform */
+  float *z_re;
+  float *z_im;
+};
+
+/**
+ * Creates a plan for transforming real signals.
+ *
+ * @param size the number of samples in a signal, which must be a
+ * power of two no less than 4
+ */
+Fft_Plan *
+fft_plan_new (unsigned size)
+{
+  Fft_Plan *plan;
+  unsigned half = size / 2;
+  unsigned bits = 0;
+  unsigned i;
+
+  g_return_val_if_fail (size >= 4 && (size & (size - 1)) == 0, NULL);
+  plan = g_new (Fft_Plan, 1);
+  while ((1u << bits) < half)
+    bits++;
+
+  plan->size = size;
+  plan->half = half;
+  plan->bitrev = g_new (unsigned, half);
+  plan->tw_re = g_new (float, half);
+  plan->tw_im = g_new (float, half);
+  plan->z_re = g_new (float, half);
+  plan->z_im = g_new (float, half);
+  for (i = 0; i < half; i++)
+    {
+      unsigned rev = 0;
+      unsigned b;
+      for (b = 0; b < bits; b++)
+	rev |= ((i >> b) & 1) << (bits - 1 - b);
+      plan->bitrev[i] = rev;
+      plan->tw_re[i] = (float) cos (2 * G_PI * i / size);
+      plan->tw_im[i] = (float) -sin (2 * G_PI * i / size);
+    }
+  return plan;
+}
+
+void
+fft_plan_free (Fft_Plan * plan)
+{
+  if (plan == NULL)
+    return;
+  g_free (plan->bitrev);
+  g_free (plan->tw_re);
+  g_free (plan->tw_im);
+  g_free (plan->z_re);
+  g_free (plan->z_im);
+  g_free (plan);
+}
+
+/** Transforms the working memory of a plan in place.  */
+static void
+complex_forward (Fft_Plan * plan)
+{
+  float *z_re = plan->z_re;
+  float *z_im = plan->z_im;
+  unsigned half = plan->half;
+  unsigned len;
+  unsigned i;
+  unsigned j;
+
+  for (len = 2; len <= half; len <<= 1)
+    {
+      /* The twiddle factors of this stage are every step'th factor
+	 of the full-length table.  */
+      unsigned step = plan->size / len;
+      unsigned mid = len / 2;
+      for (i = 0; i < half; i += len)
+	{
+	  for (j = 0; j < mid; j++)
+	    {
+	      float w_re = plan->tw_re[j*step];
+	      float w_im = plan->tw_im[j*step];
+	      unsigned a = i + j;
+	      unsigned b = a + mid;
+	      float v_re = z_re[b] * w_re - z_im[b] * w_im;
+	      float v_im = z_re[b] * w_im + z_im[b] * w_re;
+	      z_re[b] = z_re[a] - v_re;
+	      z_im[b] = z_im[a] - v_im;
+	      z_re[a] += v_re;
+	      z_im[a] += v_im;
+	    }
+	}
+    }
+}
+
+/**
+ * Computes the discrete Fourier transform of a real signal.
+ *
+ * A plan may only be used by one thread at a time.
+ * @param plan the plan for the size of @a in
+ * @param in the signal
+ * @param re the array that will hold the real parts of bins 0 through
+ * size / 2
+ * @param im the array that will hold the imaginary parts of bins 0
+ * through size / 2
+ */
+void
+fft_real_forward (Fft_Plan * plan, const float * in, float * re, float * im)
+{
+  unsigned half = plan->half;
+  unsigned k;
+
+  /* Pack even samples into the real parts and odd samples into the
+     imaginary parts, in bit reversed order.  */
+  for (k = 0; k < half; k++)
+    {
+      unsigned n = plan->bitrev[k];
+      plan->z_re[k] = in[2*n];
+      plan->z_im[k] = in[2*n+1];
+    }
+  complex_forward (plan);
+
+  /* Separate the transforms of the even and odd samples and combine
+     them into the transform of the whole signal.  */
+  re[0] = plan->z_re[0] + plan->z_im[0];
+  im[0] = 0.0;
+  re[half] = plan->z_re[0] - plan->z_im[0];
+  im[half] = 0.0;
+  for (k = 1; k < half; k++)
+    {
+      float a_re = plan->z_re[k];
+      float a_im = plan->z_im[k];
+      float b_re = plan->z_re[half-k];
+      float b_im = -plan->z_im[half-k];
+      float even_re = (a_re + b_re) / 2;
+      float even_im = (a_im + b_im) / 2;
+      /* (a - b) / 2i */
+      float odd_re = (a_im - b_im) / 2;
+      float odd_im = -(a_re - b_re) / 2;
+      float w_re = plan->tw_re[k];
+      float w_im = plan->tw_im[k];
+      re[k] = even_re + odd_re * w_re - odd_im * w_im;
+      im[k] = even_im + odd_re * w_im + odd_im * w_re;
+    }
+}
@@ -0,0 +1,53 @@
+/* Fast Fourier transform of real signals.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Fast Fourier transform of real signals.
+ *
+ * A plan holds the bit reversal permutation, the twiddle factors, and
+ * the working memory for one transform size, so that repeated
+ * transforms do no allocation and no trigonometry.  A real signal of
+ * N samples is transformed as a complex signal of N/2 samples
+ * followed by a split step, which takes about half the work of a
+ * complex transform of N samples.
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+typedef struct _Fft_Plan Fft_Plan;
+
+Fft_Plan *fft_plan_new (unsigned size);
+void fft_plan_free (Fft_Plan * plan);
+void fft_real_forward (Fft_Plan * plan, const float * in,
+		       float * re, float * im);
+
+#endif /* not FFT_H */
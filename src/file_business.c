@@ -34,54 +34,35 @@ DAMAGE.  */
 #endif
 
 #include <stdio.h>
-#include <gtk/gtk.h>
+#include <glib.h>
 
-#include "wv_editors.h"
+#include "slidercore.h"
 #include "file_business.h"
 
-/**
- * Isolates fprintf functions from save_sliw_project().
- */
-void
-do_save_printing (FILE * fp)
-{
-  unsigned i;
-  unsigned j;
-  for (i = 0; i < wv_all_freqs->len; i++)
-    {
-      fprintf (fp, "\nFundamental %u\n", i + 1);
-      fprintf (fp, "Frequency: %g\n", wv_all_freqs->d[i].fund_freq);
-      fprintf (fp, "Amplitude: %g\n", wv_all_freqs->d[i].amplitude);
-      fputs ("Harmonics:", fp);
-      for (j = 0; j < wv_all_freqs->d[i].harmonics->len; j++)
-	{
-	  fprintf (fp, " %u, %g;", wv_all_freqs->d[i].
-		   harmonics->d[j].harmc_num,
-		   wv_all_freqs->d[i].harmonics->d[j].amplitude);
-	}
-      fputs ("\n", fp);
-    }
-}
-
 /**
  * Isolates fprintf functions from export_sliw_project().
  */
 void
 do_export_printing (FILE * fp)
 {
+  gchar amp_buf[FLOAT_STR_SIZE];
+  gchar freq_buf[FLOAT_STR_SIZE];
   unsigned i;
   unsigned j;
   for (i = 0; i < wv_all_freqs->len; i++)
     {
       float fund_freq;
       fund_freq = wv_all_freqs->d[i].fund_freq;
-      fprintf (fp, " (mult %g (hzosc %g))", wv_all_freqs->d[i].amplitude,
-	       fund_freq);
+      fprintf (fp, " (mult %s (hzosc %s))",
+	       format_float (amp_buf, wv_all_freqs->d[i].amplitude),
+	       format_float (freq_buf, fund_freq));
       for (j = 0; j < wv_all_freqs->d[i].harmonics->len; j++)
 	{
-	  fprintf(fp, " (mult %g (hzosc %g))",
-		  wv_all_freqs->d[i].harmonics->d[j].amplitude, fund_freq *
-		  wv_all_freqs->d[i].harmonics->d[j].harmc_num);
+	  fprintf(fp, " (mult %s (hzosc %s))",
+		  format_float (amp_buf,
+				wv_all_freqs->d[i].harmonics->d[j].amplitude),
+		  format_float (freq_buf, fund_freq *
+				wv_all_freqs->d[i].harmonics->d[j].harmc_num));
 	}
       if (i < wv_all_freqs->len - 1)
 	fputs("\n", fp);
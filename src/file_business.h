@@ -41,14 +41,14 @@ DAMAGE.  */
  * functions, using these routines can result in file descriptors that
  * are valid in one C runtime library to be passed to another C
  * runtime library which they are invalid in.  It is for this reason
- * that all fprintf functions involved in file saving and exporting
- * are isolated in this file that does not include <libintl.h>.
+ * that all fprintf functions involved in file exporting are isolated
+ * in this file that does not include <libintl.h>.  Project files are
+ * formatted into a GString instead, so they do not need this.
  */
 
 #ifndef FILE_BUSINESS_H
 #define FILE_BUSINESS_H
 
-void do_save_printing (FILE * fp);
 void do_export_printing (FILE * fp);
 
 #endif /* FILE_BUSINESS_H */
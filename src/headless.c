@@ -0,0 +1,413 @@
+/* Running Slider without its user interface.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#  include <io.h>
+#endif
+
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
+
+#include "headless.h"
+#include "support.h"
+#include "slidercore.h"
+#include "audio.h"
+#include "tile_pool.h"
+
+/** Number of pixel columns of the waveform display that playback
+    levels are found with.  This is the default width of the main
+    window.  */
+#define PEAK_COLUMNS 600
+
+/**
+ * Prints an error returned by the Slider core to standard error.
+ *
+ * @param filename the file that the error happened on
+ * @param error the error to print, which must not be ::CORE_OK
+ * @param error_loc the position of a syntax error, or NULL
+ */
+static void
+print_core_error (const gchar * filename, Core_Error error,
+		  const Core_Location * error_loc)
+{
+  if (error == CORE_ERROR_IO)
+    g_printerr (_("%s: %s: %s\n"), g_get_prgname (), filename,
+		strerror (errno));
+  else if (error_loc != NULL && error_loc->line != 0)
+    g_printerr (_("%s: %s:%u:%u: syntax error\n"), g_get_prgname (),
+		filename, error_loc->line, error_loc->column);
+  else
+    g_printerr (_("%s: %s: syntax error\n"), g_get_prgname (), filename);
+}
+
+/**
+ * Parses a harmonic series specification.
+ *
+ * The specification has the form
+ * <code>SERIES:COUNT[:ROLLOFF]</code>, where @a SERIES is one of
+ * ::harmc_series_names.
+ * @return TRUE if the specification is valid, FALSE otherwise
+ */
+static gboolean
+parse_series_spec (const gchar * spec, Harmc_Series * series,
+		   unsigned * count, float * rolloff)
+{
+  gchar **fields;
+  gboolean retval = FALSE;
+  gchar *end;
+  long num;
+
+  fields = g_strsplit (spec, ":", 3);
+  if (fields[0] == NULL || fields[1] == NULL ||
+      !harmc_series_from_name (fields[0], series))
+    goto cleanup;
+  num = strtol (fields[1], &end, 10);
+  if (*end != '\0' || num <= 0)
+    goto cleanup;
+  *count = (unsigned) num;
+  *rolloff = 0.5;
+  if (fields[2] != NULL)
+    {
+      *rolloff = (float) g_ascii_strtod (fields[2], &end);
+      if (*end != '\0' || *rolloff <= 0)
+	goto cleanup;
+    }
+  retval = TRUE;
+ cleanup:
+  g_strfreev (fields);
+  return retval;
+}
+
+/**
+ * Generates a harmonic series for every fundamental frequency set of
+ * a project and saves the result.
+ *
+ * @param in_file the project file to start from, or NULL to start
+ * from a new project
+ * @param out_file the file to save to, or NULL to save over @a
+ * in_file
+ * @param spec the harmonic series specification, as described in
+ * parse_series_spec()
+ * @return the exit status for the program
+ */
+int
+headless_generate (const gchar * in_file, const gchar * out_file,
+		   const gchar * spec)
+{
+  Harmc_Series series;
+  unsigned count;
+  float rolloff;
+  unsigned i;
+  Core_Error error;
+  Core_Location error_loc;
+  if (!parse_series_spec (spec, &series, &count, &rolloff))
+    {
+      g_printerr (_("%s: invalid harmonic series `%s'\n"),
+		  g_get_prgname (), spec);
+      g_printerr (_("Use SERIES:COUNT[:ROLLOFF], where SERIES is one of:"));
+      for (i = 0; i < HARMC_SERIES_COUNT; i++)
+	g_printerr (" %s", harmc_series_names[i]);
+      g_printerr ("\n");
+      return EXIT_FAILURE;
+    }
+  if (out_file == NULL)
+    out_file = in_file;
+  if (out_file == NULL)
+    {
+      g_printerr (_("%s: no output file was given\n"), g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+
+  model_init ();
+  if (in_file != NULL)
+    {
+      error = read_project (in_file, &error_loc);
+      if (error != CORE_OK)
+	{
+	  print_core_error (in_file, error, &error_loc);
+	  model_free ();
+	  return EXIT_FAILURE;
+	}
+    }
+  else
+    model_new_project ();
+
+  for (i = 0; i < wv_all_freqs->len; i++)
+    model_generate_harmonics (i, series, count, rolloff);
+  error = write_project (out_file);
+  if (error != CORE_OK)
+    print_core_error (out_file, error, NULL);
+  model_free ();
+  return (error == CORE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Converts a project file to another file.
+ *
+ * Each file is read or written in the format that read_project() and
+ * write_project() choose, so this converts between text and binary
+ * project files without any loss.
+ * @param in_file the project file to read
+ * @param out_file the file to write
+ * @return the exit status for the program
+ */
+int
+headless_convert (const gchar * in_file, const gchar * out_file)
+{
+  Core_Error error;
+  Core_Location error_loc;
+
+  if (in_file == NULL)
+    {
+      g_printerr (_("%s: no input file was given\n"), g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+
+  model_init ();
+  error = read_project (in_file, &error_loc);
+  if (error != CORE_OK)
+    print_core_error (in_file, error, &error_loc);
+  else
+    {
+      error = write_project (out_file);
+      if (error != CORE_OK)
+	print_core_error (out_file, error, NULL);
+    }
+  model_free ();
+  return (error == CORE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Parses a sample format name, and prints an error if it is invalid.
+ *
+ * @return TRUE if @a format_name is valid, FALSE otherwise
+ */
+static gboolean
+parse_sample_format (const gchar * format_name, Sample_Format * format)
+{
+  unsigned i;
+  if (sample_format_from_name (format_name, format))
+    return TRUE;
+  g_printerr (_("%s: invalid sample format `%s'\n"),
+	      g_get_prgname (), format_name);
+  g_printerr (_("Use one of:"));
+  for (i = 0; i < SAMPLE_FORMAT_COUNT; i++)
+    g_printerr (" %s", sample_format_names[i]);
+  g_printerr ("\n");
+  return FALSE;
+}
+
+/**
+ * Finds the level that the current project is played back at.
+ *
+ * During playback, samples are scaled by the peak of the waveform
+ * display.  This renders the same samples as a full quality frame of
+ * a display that is #PEAK_COLUMNS wide, with the automatic time scale
+ * and the oversampling of calc_oversample().  If the main window has
+ * been resized, the display samples the waveform more or less
+ * densely and its peak can be slightly different.
+ * @return the displacement that is scaled to ::agc_volume
+ */
+static float
+find_playback_peak (void)
+{
+  float x_max = 1.0 / calc_freq_extent ();
+  unsigned num_samples = PEAK_COLUMNS * calc_oversample (PEAK_COLUMNS,
+							 x_max);
+  float *ypts = (float *) g_malloc (sizeof (float) * num_samples);
+  render_waves (ypts, num_samples, x_max);
+  g_free (ypts);
+  return max_ypt;
+}
+
+/**
+ * Renders a project file to a WAVE file.
+ *
+ * The audio is rendered at the same level as playback, and it uses
+ * every processor.
+ * @param in_file the project file to render
+ * @param out_file the WAVE file to write
+ * @param duration the length of the WAVE file in seconds
+ * @param rate the sample rate in Hertz
+ * @param format_name the name of the sample format, one of
+ * ::sample_format_names
+ * @return the exit status for the program
+ */
+int
+headless_render_wav (const gchar * in_file, const gchar * out_file,
+		     double duration, int rate, const gchar * format_name)
+{
+  Sample_Format format;
+  Core_Error error;
+  Core_Location error_loc;
+
+  if (in_file == NULL)
+    {
+      g_printerr (_("%s: no input file was given\n"), g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+  if (rate <= 0 || duration <= 0)
+    {
+      g_printerr (_("%s: the sample rate and length must be positive\n"),
+		  g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+  if (!parse_sample_format (format_name, &format))
+    return EXIT_FAILURE;
+
+  model_init ();
+  error = read_project (in_file, &error_loc);
+  if (error != CORE_OK)
+    print_core_error (in_file, error, &error_loc);
+  else
+    {
+      error = write_wav_file (wv_all_freqs, out_file, (unsigned) rate,
+			      (guint64) (duration * rate + 0.5), format,
+			      agc_volume, find_playback_peak (), NULL, NULL);
+      if (error != CORE_OK)
+	print_core_error (out_file, error, NULL);
+    }
+  model_free ();
+  tile_pool_shutdown ();
+  return (error == CORE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Streams raw samples of a project file to standard output or to a
+ * file, such as a named pipe.
+ *
+ * The samples are rendered like in headless_render_wav() and written
+ * as a single channel without a header, so that other programs can
+ * read them directly.  It is not an error for the reader to go
+ * away.
+ * @param in_file the project file to render
+ * @param out_file the file to write, or NULL or "-" for standard
+ * output
+ * @param duration the length of the stream in seconds, or zero or
+ * less to keep going until the reader goes away
+ * @param rate the sample rate in Hertz
+ * @param format_name the name of the sample format, one of
+ * ::sample_format_names
+ * @param realtime whether to write no faster than the samples would
+ * be played
+ * @return the exit status for the program
+ */
+int
+headless_stream (const gchar * in_file, const gchar * out_file,
+		 double duration, int rate, const gchar * format_name,
+		 gboolean realtime)
+{
+  Sample_Format format;
+  Core_Error error;
+  Core_Location error_loc;
+  guint64 num_samples;
+  int fd;
+
+  if (in_file == NULL)
+    {
+      g_printerr (_("%s: no input file was given\n"), g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+  if (rate <= 0)
+    {
+      g_printerr (_("%s: the sample rate must be positive\n"),
+		  g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+  if (!parse_sample_format (format_name, &format))
+    return EXIT_FAILURE;
+  /* Rounding must not turn a short stream into an endless one.  */
+  num_samples = (duration > 0) ?
+    MAX ((guint64) (duration * rate + 0.5), 1) : 0;
+
+  model_init ();
+  error = read_project (in_file, &error_loc);
+  if (error != CORE_OK)
+    {
+      print_core_error (in_file, error, &error_loc);
+      model_free ();
+      return EXIT_FAILURE;
+    }
+
+  if (out_file == NULL || !strcmp (out_file, "-"))
+    {
+      out_file = _("standard output");
+      fd = 1;
+#ifdef G_OS_WIN32
+      _setmode (fd, _O_BINARY);
+#endif
+    }
+  else
+    fd = g_open (out_file, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  if (fd == -1)
+    error = CORE_ERROR_IO;
+  else
+    {
+#ifdef SIGPIPE
+      /* Find out about a reader that went away from write() instead
+	 of being killed.  */
+      signal (SIGPIPE, SIG_IGN);
+#endif
+      error = stream_audio (wv_all_freqs, fd, (unsigned) rate, num_samples,
+			    format, agc_volume, find_playback_peak (),
+			    realtime);
+      if (fd != 1 && close (fd) != 0 && error == CORE_OK)
+	error = CORE_ERROR_IO;
+    }
+#ifdef EPIPE
+  if (error == CORE_ERROR_IO && errno == EPIPE)
+    error = CORE_OK;
+#endif
+  if (error != CORE_OK)
+    print_core_error (out_file, error, NULL);
+  model_free ();
+  tile_pool_shutdown ();
+  return (error == CORE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,53 @@
+/* Running Slider without its user interface.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Running Slider without its user interface.
+ *
+ * Some operations, such as generating harmonic series, are useful to
+ * script.  When the corresponding command line options are given,
+ * main() hands over to this module instead of creating any windows,
+ * and no display is needed.
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+int headless_generate (const gchar * in_file, const gchar * out_file,
+		       const gchar * spec);
+int headless_convert (const gchar * in_file, const gchar * out_file);
+int headless_render_wav (const gchar * in_file, const gchar * out_file,
+			 double duration, int rate, const gchar * format_name);
+int headless_stream (const gchar * in_file, const gchar * out_file,
+		     double duration, int rate, const gchar * format_name,
+		     gboolean realtime);
+
+#endif /* not HEADLESS_H */
@@ -48,6 +48,7 @@ DAMAGE.  */
 #include "interface.h"
 #include "support.h"
 #include "wv_editors.h"
+#include "editor_strip.h"
 
 #define GLADE_HOOKUP_OBJECT(component,widget,name) \
   g_object_set_data_full (G_OBJECT (component), name, \
@@ -76,6 +77,10 @@ GtkWidget *play_image;
 GtkWidget *stop_image;
 /** The window that displays the documentation manual.  */
 GtkWidget *manual_window = NULL;
+/** The "Undo" and "Redo" actions, whose sensitivity is updated by
+    undo.c.  */
+GtkAction *undo_action = NULL;
+GtkAction *redo_action = NULL;
 
 static const gchar *ui_info =
 "<ui>"
@@ -86,10 +91,24 @@ static const gchar *ui_info =
 "      <menuitem action='Save'/>"
 "      <menuitem action='SaveAs'/>"
 "      <menuitem action='Export'/>"
+"      <menuitem action='Render'/>"
 /* "      <menuitem action='Preferences'/>" */
 "      <separator/>"
 "      <menuitem action='Quit'/>"
 "    </menu>"
+"    <menu action='EditMenu'>"
+"      <menuitem action='Undo'/>"
+"      <menuitem action='Redo'/>"
+"    </menu>"
+"    <menu action='ViewMenu'>"
+"      <menuitem action='SetOverlays'/>"
+"      <menuitem action='ShowScope'/>"
+"      <menuitem action='ShowSpectrum'/>"
+"      <separator/>"
+"      <menuitem action='ZoomIn'/>"
+"      <menuitem action='ZoomOut'/>"
+"      <menuitem action='ZoomAuto'/>"
+"    </menu>"
 "    <menu action='TransportMenu'>"
 "      <menuitem action='Play'/>"
 "      <menuitem action='Stop'/>"
@@ -121,6 +140,8 @@ create_main_window (void)
      Any parts not specified take on default zero values.  */
   GtkActionEntry entries[] = {
     { "FileMenu", NULL, _("_File") },
+    { "EditMenu", NULL, _("_Edit") },
+    { "ViewMenu", NULL, _("_View") },
     { "TransportMenu", NULL, _("_Transport") },
     { "HelpMenu", NULL, _("_Help") },
     { "New", GTK_STOCK_NEW, _("_New"), "<control>N",
@@ -138,12 +159,32 @@ create_main_window (void)
     { "Export", NULL, _("_Export..."), NULL,
       _("Export a Nyquist script that generates this waveform"),
       G_CALLBACK (activate_action) },
+    { "Render", NULL, _("_Render Audio..."), NULL,
+      _("Render this waveform to a WAVE audio file"),
+      G_CALLBACK (activate_action) },
     /* { "Preferences", NULL, _("_Preferences"), NULL,
        _("Preferences"),
        G_CALLBACK (activate_action) }, */
     { "Quit", GTK_STOCK_QUIT, _("_Quit"), "<control>Q",
       _("Leave Slider Wave Editor"),
       G_CALLBACK (activate_action) },
+    /* <control>Z is already taken by "Stop".  */
+    { "Undo", GTK_STOCK_UNDO, _("_Undo"), "<alt>BackSpace",
+      _("Undo the last change"),
+      G_CALLBACK (activate_action) },
+    { "Redo", GTK_STOCK_REDO, _("_Redo"), "<shift><alt>BackSpace",
+      _("Redo the last undone change"),
+      G_CALLBACK (activate_action) },
+    { "ZoomIn", GTK_STOCK_ZOOM_IN, _("Zoom _In"), "<control>plus",
+      _("Show a shorter span of time in the waveform display"),
+      G_CALLBACK (activate_action) },
+    { "ZoomOut", GTK_STOCK_ZOOM_OUT, _("Zoom _Out"), "<control>minus",
+      _("Show a longer span of time in the waveform display"),
+      G_CALLBACK (activate_action) },
+    { "ZoomAuto", GTK_STOCK_ZOOM_FIT, _("_Automatic Time Scale"),
+      "<control>0",
+      _("Return the waveform display to the automatic time scale"),
+      G_CALLBACK (activate_action) },
     { "Play", GTK_STOCK_MEDIA_PLAY, _("_Play"), "<control>X",
       _("Enable playback of the current waveform"),
       G_CALLBACK (activate_action) },
@@ -158,6 +199,19 @@ create_main_window (void)
       G_CALLBACK (activate_action) },
   };
   guint n_entries = G_N_ELEMENTS (entries);
+  /* Toggle entries have an additional is_active field.  */
+  GtkToggleActionEntry toggle_entries[] = {
+    { "SetOverlays", NULL, _("Set _Overlays"), NULL,
+      _("Draw each fundamental set's part of the waveform in its own color"),
+      G_CALLBACK (activate_action), FALSE },
+    { "ShowScope", NULL, _("O_scilloscope"), NULL,
+      _("Show the audio output as it is played"),
+      G_CALLBACK (activate_action), FALSE },
+    { "ShowSpectrum", NULL, _("Spectrum _Analyzer"), NULL,
+      _("Show the spectrum of the audio output as it is played"),
+      G_CALLBACK (activate_action), FALSE },
+  };
+  guint n_toggle_entries = G_N_ELEMENTS (toggle_entries);
 
   main_window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
   /* gtk_container_set_border_width (GTK_CONTAINER (main_window), 8); */
@@ -177,10 +231,17 @@ create_main_window (void)
     gtk_action_group_add_actions (action_group,
 				  entries, n_entries,
 				  main_window);
+    gtk_action_group_add_toggle_actions (action_group,
+					 toggle_entries, n_toggle_entries,
+					 main_window);
     merge = gtk_ui_manager_new ();
     g_object_set_data_full (G_OBJECT (main_window), "ui-manager", merge,
 			    g_object_unref);
     gtk_ui_manager_insert_action_group (merge, action_group, 0);
+    undo_action = gtk_action_group_get_action (action_group, "Undo");
+    redo_action = gtk_action_group_get_action (action_group, "Redo");
+    gtk_action_set_sensitive (undo_action, FALSE);
+    gtk_action_set_sensitive (redo_action, FALSE);
     gtk_window_add_accel_group (GTK_WINDOW (main_window),
 				gtk_ui_manager_get_accel_group (merge));
     if (!gtk_ui_manager_add_ui_from_string (merge, ui_info, -1, &error))
@@ -239,7 +300,20 @@ create_main_window (void)
   gtk_box_pack_start (GTK_BOX (fundset_sel_hbox), fundset_label, FALSE,
 		      FALSE, 0);
 
-  cb_fund_set = gtk_combo_box_new_text ();
+  /* A project can have thousands of fundamental sets, so show them as
+     a list rather than as a menu that needs a menu item per set.  The
+     model is filled by select_fund_freq().  */
+  gtk_rc_parse_string ("style \"slider-fund-set\"\n"
+		       "{ GtkComboBox::appears-as-list = 1 }\n"
+		       "widget \"*.cb_fund_set\" style \"slider-fund-set\"\n");
+  cb_fund_set = gtk_combo_box_new ();
+  gtk_widget_set_name (cb_fund_set, "cb_fund_set");
+  {
+    GtkCellRenderer *cell = gtk_cell_renderer_text_new ();
+    gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (cb_fund_set), cell, TRUE);
+    gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (cb_fund_set), cell,
+				    "text", 0, NULL);
+  }
   gtk_widget_show (cb_fund_set);
   gtk_box_pack_start (GTK_BOX (fundset_sel_hbox), cb_fund_set, TRUE, TRUE, 0);
   gtk_widget_set_size_request (cb_fund_set, 100, -1);
@@ -251,6 +325,9 @@ create_main_window (void)
   wave_render = gtk_drawing_area_new ();
   gtk_widget_show (wave_render);
   gtk_paned_pack1 (GTK_PANED (wv_edit_div), wave_render, FALSE, TRUE);
+  gtk_widget_add_events (wave_render, GDK_BUTTON_PRESS_MASK |
+			 GDK_BUTTON_RELEASE_MASK | GDK_BUTTON1_MOTION_MASK |
+			 GDK_SCROLL_MASK);
 
   wave_editors_sb = gtk_scrolled_window_new (NULL, NULL);
   gtk_widget_show (wave_editors_sb);
@@ -280,7 +357,16 @@ create_main_window (void)
 		    G_CALLBACK (cb_fund_set_changed), NULL);
   g_signal_connect ((gpointer) wave_render, "expose_event",
 		    G_CALLBACK (wavrnd_expose), NULL);
-
+  g_signal_connect ((gpointer) wave_render, "button_press_event",
+		    G_CALLBACK (wavrnd_button_press), NULL);
+  g_signal_connect ((gpointer) wave_render, "button_release_event",
+		    G_CALLBACK (wavrnd_button_release), NULL);
+  g_signal_connect ((gpointer) wave_render, "motion_notify_event",
+		    G_CALLBACK (wavrnd_motion_notify), NULL);
+  g_signal_connect ((gpointer) wave_render, "scroll_event",
+		    G_CALLBACK (wavrnd_scroll), NULL);
+
+  editor_strip_init (wave_editors_sb, wave_edit_cntr);
   select_fund_freq (g_fund_set);
 
   /* Store pointers to all widgets, for use by lookup_widget().  */
@@ -304,79 +390,18 @@ create_main_window (void)
 }
 
 /**
- * Create the widgets for a wave editor window.
- *
- * When a different fundamental frequency set is selected or a new
- * project is created or opened, the widgets for the wave editors need
- * to be recreated.  This function only creates the widgets for a wave
- * editor window and does not update the data model.  In order to
- * properly add a new wave editor window for harmonics, you should
- * also call add_wv_editor().  If the fundamental frequency set being
- * worked with is currently selected, then you will need to update
- * other information as is done in harmc_win_add_clicked().
+ * Creates the frame that holds a wave editor window.
  *
- * @param first_type if TRUE then a fundamental frequency wave editor
- * window will be created.  If FALSE, a harmonic wave editor window
- * will be created.
- * @param index if first_type is TRUE, then this specifies which
- * fundamental frequency set should be worked with; otherwise, it
- * specifies which harmonic wave editor of the current fundamental
- * frequency set to work with from the data model.
+ * @param holder_vbox where to store the box that the rows of the wave
+ * editor window should be packed into
  */
-GtkWidget *
-create_wvedit_holder (gboolean first_type, unsigned index)
+static GtkWidget *
+create_holder_frame (GtkWidget ** holder_vbox)
 {
   GtkWidget *wvedit_holder_frame;
   GtkWidget *wvedit_holder_vbox;
-  GtkWidget *fund_editor_hbox;
-  GtkWidget *fund_editor_left_hbox;
-  GtkWidget *harmc_one_drop;
-  GtkWidget *mult_amps;
-  GtkWidget *fundset_hbox;
-  GtkWidget *fundset_label;
-  GtkWidget *fundset_add;
-  GtkWidget *fundset_remove;
-  GtkWidget *fund_freq_hbox;
-  GtkWidget *fund_freq_left_hbox;
-  GtkWidget *fndfrq_label;
-  GtkWidget *fndfrq_mntisa;
-  GtkWidget *fndfrq_exp_label;
-  GtkObject *fndfrq_exp_adj;
-  GtkWidget *fndfrq_exp;
-  GtkWidget *fndfrq_precslid_change;
-  GtkWidget *fndfrq_precslid_label;
-  GtkWidget *fndfrq_precslid_add;
-  GtkWidget *fndfrq_precslid_remove;
-  GtkWidget *fund_freq_slider_vbox;
-  /* GtkWidget *hscrollbar2; */
-  GtkWidget *harmc_editor_hbox;
-  GtkWidget *harmc_editor_left_hbox;
-  GtkWidget *harmc_sel_label;
-  GtkWidget *harmc_sel;
-  GtkWidget *harmc_window_hbox;
-  GtkWidget *harmc_win_label;
-  GtkWidget *harmc_win_add;
-  GtkWidget *harmc_win_remove;
-  GtkWidget *harmc_change_hbox;
-  GtkWidget *harmc_add_label;
-  GtkWidget *harmc_add;
-  GtkWidget *harmc_remove;
-  GtkWidget *amp_hbox;
-  GtkWidget *amp_left_hbox;
-  GtkWidget *amp_set_label;
-  GtkWidget *amp_mntisa;
-  GtkWidget *amp_exp_label;
-  GtkObject *amp_exp_adj;
-  GtkWidget *amp_exp;
-  GtkWidget *amp_precslid_change;
-  GtkWidget *amp_precslid_label;
-  GtkWidget *amp_precslid_add;
-  GtkWidget *amp_precslid_remove;
-  GtkWidget *amp_slider_vbox;
-  /* GtkWidget *hscrollbar1; */
 
   wvedit_holder_frame = gtk_frame_new (NULL);
-  gtk_widget_show (wvedit_holder_frame);
   gtk_container_set_border_width (GTK_CONTAINER (wvedit_holder_frame), 5);
   gtk_frame_set_label_align (GTK_FRAME (wvedit_holder_frame), 0, 0);
   gtk_frame_set_shadow_type (GTK_FRAME (wvedit_holder_frame), GTK_SHADOW_OUT);
@@ -386,197 +411,38 @@ create_wvedit_holder (gboolean first_type, unsigned index)
   gtk_container_add (GTK_CONTAINER (wvedit_holder_frame), wvedit_holder_vbox);
   gtk_container_set_border_width (GTK_CONTAINER (wvedit_holder_vbox), 5);
 
-  if (first_type)
-    {
-      fund_editor_hbox = gtk_hbox_new (FALSE, 5);
-      gtk_widget_show (fund_editor_hbox);
-      gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_editor_hbox,
-			  TRUE, FALSE, 0);
-
-      fund_editor_left_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (fund_editor_left_hbox);
-      gtk_box_pack_start (GTK_BOX (fund_editor_hbox), fund_editor_left_hbox,
-			  FALSE, FALSE, 0);
-
-      harmc_one_drop = gtk_button_new_with_mnemonic (_("1st Harmonic Drop"));
-      /* Don't discourage the user by displaying something that can
-	 never be clicked on.  */
-      /* gtk_widget_show (harmc_one_drop); */
-      gtk_box_pack_start (GTK_BOX (fund_editor_left_hbox), harmc_one_drop,
-			  FALSE, FALSE, 0);
-      gtk_widget_set_sensitive (harmc_one_drop, FALSE);
-
-      mult_amps = gtk_button_new_with_mnemonic (_("Multiply Amplitudes"));
-      gtk_widget_show (mult_amps);
-      gtk_box_pack_start (GTK_BOX (fund_editor_left_hbox), mult_amps, FALSE,
-			  FALSE, 0);
-
-      fundset_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (fundset_hbox);
-      gtk_box_pack_end (GTK_BOX (fund_editor_hbox), fundset_hbox, FALSE,
-			FALSE, 0);
-
-      fundset_label = gtk_label_new (_("Fundamental Set: "));
-      gtk_widget_show (fundset_label);
-      gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_label, FALSE,
-			  FALSE, 0);
-
-      fundset_add = gtk_button_new_with_mnemonic (_("Add"));
-      gtk_widget_show (fundset_add);
-      gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_add, FALSE,
-			  FALSE, 0);
-
-      fundset_remove = gtk_button_new_with_mnemonic (_("Remove"));
-      gtk_widget_show (fundset_remove);
-      gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_remove, FALSE,
-			  FALSE, 0);
-      /* If there is only one fundamental left, disable this button.  */
-      if (wv_all_freqs->len == 1)
-	gtk_widget_set_sensitive (fundset_remove, FALSE);
-
-      fund_freq_hbox = gtk_hbox_new (FALSE, 5);
-      gtk_widget_show (fund_freq_hbox);
-      gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_freq_hbox, TRUE,
-			  FALSE, 0);
-
-      fund_freq_left_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (fund_freq_left_hbox);
-      gtk_box_pack_start (GTK_BOX (fund_freq_hbox), fund_freq_left_hbox,
-			  FALSE, FALSE, 0);
-
-      fndfrq_label = gtk_label_new (_("Fundamental Frequency: "));
-      gtk_widget_show (fndfrq_label);
-      gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_label, FALSE,
-			  FALSE, 0);
-
-      fndfrq_mntisa = gtk_entry_new ();
-      gtk_widget_show (fndfrq_mntisa);
-      gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_mntisa, TRUE,
-			  TRUE, 0);
-
-      fndfrq_exp_label = gtk_label_new (" \303 10^");
-      gtk_widget_show (fndfrq_exp_label);
-      gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_exp_label,
-			  FALSE, FALSE, 0);
-
-      fndfrq_exp_adj = gtk_adjustment_new (0, -100, 100, 1, 10, 0);
-      fndfrq_exp = gtk_spin_button_new (GTK_ADJUSTMENT (fndfrq_exp_adj), 1, 0);
-      gtk_widget_show (fndfrq_exp);
-      gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_exp, TRUE,
-			  TRUE, 0);
-
-      fndfrq_precslid_change = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (fndfrq_precslid_change);
-      gtk_box_pack_end (GTK_BOX (fund_freq_hbox), fndfrq_precslid_change,
-			FALSE, FALSE, 0);
-
-      fndfrq_precslid_label = gtk_label_new (_("Precision Slider: "));
-      gtk_widget_show (fndfrq_precslid_label);
-      gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
-			  fndfrq_precslid_label, FALSE, FALSE, 0);
-
-      fndfrq_precslid_add = gtk_button_new_with_mnemonic (_("Add"));
-      gtk_widget_show (fndfrq_precslid_add);
-      gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
-			  fndfrq_precslid_add, FALSE, FALSE, 0);
-
-      fndfrq_precslid_remove = gtk_button_new_with_mnemonic (_("Remove"));
-      gtk_widget_show (fndfrq_precslid_remove);
-      gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
-			  fndfrq_precslid_remove, FALSE, FALSE, 0);
-      if (wv_all_freqs->d[index].fund_editor.freq_sliders->len <= 1)
-	gtk_widget_set_sensitive (fndfrq_precslid_remove, FALSE);
-
-      fund_freq_slider_vbox = gtk_vbox_new (FALSE, 0);
-      gtk_widget_show (fund_freq_slider_vbox);
-      gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_freq_slider_vbox,
-			  TRUE, FALSE, 0);
-
-      /* hscrollbar2 =
-	gtk_hscrollbar_new (GTK_ADJUSTMENT
-			    (gtk_adjustment_new (10, 0, 21, 0.1, 1, 1)));
-      gtk_widget_show (hscrollbar2);
-      gtk_box_pack_start (GTK_BOX (fund_freq_slider_vbox), hscrollbar2, TRUE,
-			  TRUE, 0); */
-    }
-  else
-    {
-      harmc_editor_hbox = gtk_hbox_new (FALSE, 5);
-      gtk_widget_show (harmc_editor_hbox);
-      gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), harmc_editor_hbox,
-			  TRUE, FALSE, 0);
-
-      harmc_editor_left_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (harmc_editor_left_hbox);
-      gtk_box_pack_start (GTK_BOX (harmc_editor_hbox), harmc_editor_left_hbox,
-			  FALSE, FALSE, 0);
-
-      harmc_sel_label = gtk_label_new (_("Harmonic "));
-      gtk_widget_show (harmc_sel_label);
-      gtk_box_pack_start (GTK_BOX (harmc_editor_left_hbox), harmc_sel_label,
-			  FALSE, FALSE, 0);
-
-      harmc_sel = gtk_combo_box_new_text ();
-      gtk_widget_show (harmc_sel);
-      gtk_box_pack_start (GTK_BOX (harmc_editor_left_hbox), harmc_sel, TRUE,
-			  TRUE, 0);
-      gtk_widget_set_size_request (harmc_sel, 75, -1);
-
-      harmc_window_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (harmc_window_hbox);
-      gtk_box_pack_start (GTK_BOX (harmc_editor_hbox), harmc_window_hbox, TRUE,
-			  FALSE, 0);
-
-      harmc_win_label = gtk_label_new (_("Harmonic Window: "));
-      gtk_widget_show (harmc_win_label);
-      gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_label, FALSE,
-			  FALSE, 0);
-
-      harmc_win_add = gtk_button_new_with_mnemonic (_("Add"));
-      gtk_widget_show (harmc_win_add);
-      gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_add, FALSE,
-			  FALSE, 0);
-
-      harmc_win_remove = gtk_button_new_with_mnemonic (_("Remove"));
-      gtk_widget_show (harmc_win_remove);
-      gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_remove, FALSE,
-			  FALSE, 0);
-      if (wv_all_freqs->d[g_fund_set].wv_editors->len == 1)
-	gtk_widget_set_sensitive (harmc_win_remove, FALSE);
-      /* We must make sure that the widget we might reference in the
-	 data model will be valid.  */
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->harmc_win_rm_btn =
-	harmc_win_remove;
-      if (wv_all_freqs->d[g_fund_set].wv_editors->len == 2)
-	{
-	  gtk_widget_set_sensitive ((wv_all_freqs->d[g_fund_set].wv_editors->
-				     d[0]->harmc_win_rm_btn), TRUE);
-	}
+  *holder_vbox = wvedit_holder_vbox;
+  return wvedit_holder_frame;
+}
 
-      harmc_change_hbox = gtk_hbox_new (FALSE, 0);
-      gtk_widget_show (harmc_change_hbox);
-      gtk_box_pack_end (GTK_BOX (harmc_editor_hbox), harmc_change_hbox, FALSE,
-			FALSE, 0);
-
-      harmc_add_label = gtk_label_new (_("Harmonic: "));
-      gtk_widget_show (harmc_add_label);
-      gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_add_label, FALSE,
-			  FALSE, 0);
-
-      harmc_add = gtk_button_new_with_mnemonic (_("Add"));
-      gtk_widget_show (harmc_add);
-      gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_add, FALSE, FALSE,
-			  0);
-
-      harmc_remove = gtk_button_new_with_mnemonic (_("Remove"));
-      gtk_widget_show (harmc_remove);
-      gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_remove, FALSE,
-			  FALSE, 0);
-    }
+/**
+ * Creates the amplitude rows of a wave editor window.
+ *
+ * Both kinds of wave editor windows end with a row for entering the
+ * amplitude, followed by the amplitude precision sliders.
+ * @param holder_vbox the box to pack the rows into
+ * @param view the structure whose amplitude widget fields will be
+ * set to the new widgets
+ */
+static void
+create_amp_rows (GtkWidget * holder_vbox, Harmc_View * view)
+{
+  GtkWidget *amp_hbox;
+  GtkWidget *amp_left_hbox;
+  GtkWidget *amp_set_label;
+  GtkWidget *amp_mntisa;
+  GtkWidget *amp_exp_label;
+  GtkObject *amp_exp_adj;
+  GtkWidget *amp_exp;
+  GtkWidget *amp_precslid_change;
+  GtkWidget *amp_precslid_label;
+  GtkWidget *amp_precslid_add;
+  GtkWidget *amp_precslid_remove;
+  GtkWidget *amp_slider_vbox;
 
   amp_hbox = gtk_hbox_new (FALSE, 5);
   gtk_widget_show (amp_hbox);
-  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), amp_hbox, TRUE, FALSE, 0);
+  gtk_box_pack_start (GTK_BOX (holder_vbox), amp_hbox, TRUE, FALSE, 0);
 
   amp_left_hbox = gtk_hbox_new (FALSE, 0);
   gtk_widget_show (amp_left_hbox);
@@ -619,254 +485,356 @@ create_wvedit_holder (gboolean first_type, unsigned index)
   gtk_widget_show (amp_precslid_remove);
   gtk_box_pack_start (GTK_BOX (amp_precslid_change), amp_precslid_remove,
 		      FALSE, FALSE, 0);
-  if ((first_type &&
-       wv_all_freqs->d[g_fund_set].fund_editor.amp_sliders->len <= 1) ||
-      (!first_type &&
-       wv_all_freqs->d[g_fund_set].wv_editors->d[index]->
-       amp_sliders->len <= 1))
-    gtk_widget_set_sensitive (amp_precslid_remove, FALSE);
 
   amp_slider_vbox = gtk_vbox_new (FALSE, 0);
   gtk_widget_show (amp_slider_vbox);
-  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), amp_slider_vbox, TRUE,
+  gtk_box_pack_start (GTK_BOX (holder_vbox), amp_slider_vbox, TRUE,
 		      FALSE, 0);
 
-  /* hscrollbar1 =
-    gtk_hscrollbar_new (GTK_ADJUSTMENT
-			(gtk_adjustment_new (10, 0, 21, 0.1, 1, 1)));
-  gtk_widget_show (hscrollbar1);
-  gtk_box_pack_start (GTK_BOX (amp_slider_vbox), hscrollbar1, TRUE, TRUE,
-		      0); */
+  view->amp_mntisa = amp_mntisa;
+  view->amp_exp = amp_exp;
+  view->amp_precslid_add = amp_precslid_add;
+  view->amp_precslid_remove = amp_precslid_remove;
+  view->amp_sliders_vbox = amp_slider_vbox;
+}
 
-  if (first_type)
-    {
-      wv_all_freqs->d[index].fund_editor.fndfrq_mntisa = fndfrq_mntisa;
-      wv_all_freqs->d[index].fund_editor.fndfrq_exp = fndfrq_exp;
-      wv_all_freqs->d[index].fund_editor.amp_mntisa = amp_mntisa;
-      wv_all_freqs->d[index].fund_editor.amp_exp = amp_exp;
-      wv_all_freqs->d[index].fund_editor.freq_slid_rm_btn =
-	fndfrq_precslid_remove;
-      wv_all_freqs->d[index].fund_editor.freq_sliders_vbox =
-	fund_freq_slider_vbox;
-      wv_all_freqs->d[index].fund_editor.amp_slid_rm_btn =
-	amp_precslid_remove;
-      wv_all_freqs->d[index].fund_editor.amp_sliders_vbox = amp_slider_vbox;
-
-      if (wv_all_freqs->d[index].fund_editor.freq_sliders->len == 0 &&
-	  wv_all_freqs->d[index].fund_editor.amp_sliders->len == 0)
-	{
-	  add_prec_slider (TRUE, 0);
-	  add_prec_slider (TRUE, 1);
-	}
+/**
+ * Create the widgets for the fundamental frequency wave editor window.
+ *
+ * When a different fundamental frequency set is selected or a new
+ * project is created or opened, the widgets for the fundamental
+ * frequency editor need to be recreated.  The harmonic wave editor
+ * windows are managed separately by the editor strip.
+ *
+ * @param index the fundamental frequency set to work with
+ */
+GtkWidget *
+create_fund_editor (unsigned index)
+{
+  GtkWidget *wvedit_holder_frame;
+  GtkWidget *wvedit_holder_vbox;
+  GtkWidget *fund_editor_hbox;
+  GtkWidget *fund_editor_left_hbox;
+  GtkWidget *harmc_one_drop;
+  GtkWidget *mult_amps;
+  GtkWidget *gen_harmcs;
+  GtkWidget *fundset_hbox;
+  GtkWidget *fundset_label;
+  GtkWidget *fundset_add;
+  GtkWidget *fundset_remove;
+  GtkWidget *fund_freq_hbox;
+  GtkWidget *fund_freq_left_hbox;
+  GtkWidget *fndfrq_label;
+  GtkWidget *fndfrq_mntisa;
+  GtkWidget *fndfrq_exp_label;
+  GtkObject *fndfrq_exp_adj;
+  GtkWidget *fndfrq_exp;
+  GtkWidget *fndfrq_precslid_change;
+  GtkWidget *fndfrq_precslid_label;
+  GtkWidget *fndfrq_precslid_add;
+  GtkWidget *fndfrq_precslid_remove;
+  GtkWidget *fund_freq_slider_vbox;
+  /* Only the amplitude fields of this structure are used.  */
+  Harmc_View amp;
+  Wv_Editor_Data *cur_editor = &wv_all_freqs->d[index].ui->fund_editor;
 
-      g_signal_connect ((gpointer) harmc_one_drop, "clicked",
-			G_CALLBACK (harmc_one_drop_clicked), NULL);
-      g_signal_connect ((gpointer) mult_amps, "clicked",
-			G_CALLBACK (mult_amps_clicked), NULL);
-      g_signal_connect ((gpointer) fundset_add, "clicked",
-			G_CALLBACK (fundset_add_clicked),
-			(gpointer)(index));
-      g_signal_connect ((gpointer) fundset_remove, "clicked",
-			G_CALLBACK (fundset_remove_clicked),
-			(gpointer)(index));
-      g_signal_connect ((gpointer) fndfrq_mntisa, "activate",
-			G_CALLBACK (fndfrq_mntisa_activate), 
-			(gpointer)(index));
-      g_signal_connect ((gpointer) fndfrq_mntisa, "focus-out-event",
-			G_CALLBACK (fndfrq_mntisa_focus_out),
-			(gpointer)(index));
-      g_signal_connect ((gpointer) fndfrq_exp, "value_changed",
-			G_CALLBACK (fndfrq_exp_value_changed),
-			(gpointer)(index));
-      sci_notation_set_values (GTK_ENTRY (fndfrq_mntisa),
-			       GTK_SPIN_BUTTON (fndfrq_exp),
-			       wv_all_freqs->d[index].fund_freq);
-      g_signal_connect ((gpointer) fndfrq_precslid_add, "clicked",
-	      G_CALLBACK (precslid_add_clicked),
-	      (gpointer)(wv_all_freqs->d[index].fund_editor.
-			 freq_sliders->d[0]));
-      g_signal_connect ((gpointer) fndfrq_precslid_remove, "clicked",
-	      G_CALLBACK (precslid_remove_clicked),
-	      (gpointer)(wv_all_freqs->d[index].fund_editor.
-			 freq_sliders->d[0]));
-
-      g_signal_connect ((gpointer) amp_mntisa, "activate",
-			G_CALLBACK (fndamp_mntisa_activate),
-			(gpointer)(&wv_all_freqs->d[index].fund_editor));
-      g_signal_connect ((gpointer) amp_mntisa, "focus-out-event",
-			G_CALLBACK (fndamp_mntisa_focus_out),
-			(gpointer)(&wv_all_freqs->d[index].fund_editor));
-      g_signal_connect ((gpointer) amp_exp, "value_changed",
-			G_CALLBACK (fndamp_exp_value_changed),
-			(gpointer)(&wv_all_freqs->d[index].fund_editor));
-      sci_notation_set_values (GTK_ENTRY (amp_mntisa),
-		 GTK_SPIN_BUTTON (amp_exp), wv_all_freqs->d[index].amplitude);
-      g_signal_connect ((gpointer) amp_precslid_add, "clicked",
-	      G_CALLBACK (precslid_add_clicked),
-	      (gpointer)(wv_all_freqs->d[index].fund_editor.
-			 amp_sliders->d[0]));
-      g_signal_connect ((gpointer) amp_precslid_remove, "clicked",
-	      G_CALLBACK (precslid_remove_clicked),
-	      (gpointer)(wv_all_freqs->d[index].fund_editor.
-			 amp_sliders->d[0]));
-    }
-  else
-    {
-      Wv_Editor_Data *cur_editor;
-      Wv_Data *cur_data;
-      cur_editor = wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-      cur_data = cur_editor->data;
-
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->amp_mntisa =
-	amp_mntisa;
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->amp_exp = amp_exp;
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->harmc_sel =
-	harmc_sel;
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->amp_slid_rm_btn =
-	amp_precslid_remove;
-      wv_all_freqs->d[g_fund_set].wv_editors->d[index]->amp_sliders_vbox =
-	amp_slider_vbox;
-      /* We already called the following statement earlier in the
-	 function to fix a bug.  (It would make more sense to put it
-	 here though...)  */
-      /* wv_all_freqs->d[g_fund_set].wv_editors->d[index]->harmc_win_rm_btn =
-	harmc_win_remove; */
-
-      if (wv_all_freqs->d[g_fund_set].wv_editors->d[index]->
-	  amp_sliders->len == 0)
-	add_prec_slider (FALSE, index);
-
-      g_signal_connect ((gpointer) harmc_sel, "changed",
-			G_CALLBACK (harmc_sel_changed),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) harmc_win_add, "clicked",
-			G_CALLBACK (harmc_win_add_clicked),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) harmc_win_remove, "clicked",
-			G_CALLBACK (harmc_win_remove_clicked),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) harmc_add, "clicked",
-			G_CALLBACK (harmc_add_clicked),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) harmc_remove, "clicked",
-			G_CALLBACK (harmc_remove_clicked),
-			(gpointer)(cur_editor));
+  wvedit_holder_frame = create_holder_frame (&wvedit_holder_vbox);
+  gtk_widget_show (wvedit_holder_frame);
 
-      {
-	unsigned i;
-	for (i = 0; i < wv_all_freqs->d[g_fund_set].harmonics->len; i++)
-	  {
-	    gchar cb_text[11];
-	    unsigned harmc_num;
-	    harmc_num = wv_all_freqs->d[g_fund_set].harmonics->d[i].harmc_num;
-	    sprintf (cb_text, "%u", harmc_num);
-	    gtk_combo_box_append_text (GTK_COMBO_BOX (harmc_sel), cb_text);
-	  }
-	gtk_combo_box_set_active (GTK_COMBO_BOX (harmc_sel),
-	     cur_data->group_idx);
-      }
+  fund_editor_hbox = gtk_hbox_new (FALSE, 5);
+  gtk_widget_show (fund_editor_hbox);
+  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_editor_hbox,
+		      TRUE, FALSE, 0);
 
-      g_signal_connect ((gpointer) amp_mntisa, "activate",
-			G_CALLBACK (amp_mntisa_activate),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) amp_mntisa, "focus-out-event",
-			G_CALLBACK (amp_mntisa_focus_out),
-			(gpointer)(cur_editor));
-      g_signal_connect ((gpointer) amp_exp, "value_changed",
-			G_CALLBACK (amp_exp_value_changed),
-			(gpointer)(cur_editor));
-      sci_notation_set_values (GTK_ENTRY (amp_mntisa),
-			       GTK_SPIN_BUTTON (amp_exp),
-			       cur_data->amplitude);
-      g_signal_connect ((gpointer) amp_precslid_add, "clicked",
-			G_CALLBACK (precslid_add_clicked),
-			(gpointer)(wv_all_freqs->d[g_fund_set].
-				   wv_editors->d[index]->amp_sliders->d[0]));
-      g_signal_connect ((gpointer) amp_precslid_remove, "clicked",
-			G_CALLBACK (precslid_remove_clicked),
-			(gpointer)(wv_all_freqs->d[g_fund_set].
-				   wv_editors->d[index]->amp_sliders->d[0]));
-    }
+  fund_editor_left_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (fund_editor_left_hbox);
+  gtk_box_pack_start (GTK_BOX (fund_editor_hbox), fund_editor_left_hbox,
+		      FALSE, FALSE, 0);
 
-  if (first_type)
-    {
-      Wv_Editor_Data *cur_editor = &(wv_all_freqs->d[index].fund_editor);
-      update_slider_bases (GTK_ENTRY (fndfrq_mntisa), cur_editor, TRUE);
-      update_slider_bases (GTK_ENTRY (amp_mntisa), cur_editor, FALSE);
-    }
-  else
+  harmc_one_drop = gtk_button_new_with_mnemonic (_("1st Harmonic Drop"));
+  /* Don't discourage the user by displaying something that can
+     never be clicked on.  */
+  /* gtk_widget_show (harmc_one_drop); */
+  gtk_box_pack_start (GTK_BOX (fund_editor_left_hbox), harmc_one_drop,
+		      FALSE, FALSE, 0);
+  gtk_widget_set_sensitive (harmc_one_drop, FALSE);
+
+  mult_amps = gtk_button_new_with_mnemonic (_("Multiply Amplitudes"));
+  gtk_widget_show (mult_amps);
+  gtk_box_pack_start (GTK_BOX (fund_editor_left_hbox), mult_amps, FALSE,
+		      FALSE, 0);
+
+  gen_harmcs = gtk_button_new_with_mnemonic (_("Generate Harmonics"));
+  gtk_widget_show (gen_harmcs);
+  gtk_box_pack_start (GTK_BOX (fund_editor_left_hbox), gen_harmcs, FALSE,
+		      FALSE, 0);
+
+  fundset_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (fundset_hbox);
+  gtk_box_pack_end (GTK_BOX (fund_editor_hbox), fundset_hbox, FALSE,
+		    FALSE, 0);
+
+  fundset_label = gtk_label_new (_("Fundamental Set: "));
+  gtk_widget_show (fundset_label);
+  gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_label, FALSE,
+		      FALSE, 0);
+
+  fundset_add = gtk_button_new_with_mnemonic (_("Add"));
+  gtk_widget_show (fundset_add);
+  gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_add, FALSE,
+		      FALSE, 0);
+
+  fundset_remove = gtk_button_new_with_mnemonic (_("Remove"));
+  gtk_widget_show (fundset_remove);
+  gtk_box_pack_start (GTK_BOX (fundset_hbox), fundset_remove, FALSE,
+		      FALSE, 0);
+  /* If there is only one fundamental left, disable this button.  */
+  if (wv_all_freqs->len == 1)
+    gtk_widget_set_sensitive (fundset_remove, FALSE);
+
+  fund_freq_hbox = gtk_hbox_new (FALSE, 5);
+  gtk_widget_show (fund_freq_hbox);
+  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_freq_hbox, TRUE,
+		      FALSE, 0);
+
+  fund_freq_left_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (fund_freq_left_hbox);
+  gtk_box_pack_start (GTK_BOX (fund_freq_hbox), fund_freq_left_hbox,
+		      FALSE, FALSE, 0);
+
+  fndfrq_label = gtk_label_new (_("Fundamental Frequency: "));
+  gtk_widget_show (fndfrq_label);
+  gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_label, FALSE,
+		      FALSE, 0);
+
+  fndfrq_mntisa = gtk_entry_new ();
+  gtk_widget_show (fndfrq_mntisa);
+  gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_mntisa, TRUE,
+		      TRUE, 0);
+
+  fndfrq_exp_label = gtk_label_new (" \303 10^");
+  gtk_widget_show (fndfrq_exp_label);
+  gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_exp_label,
+		      FALSE, FALSE, 0);
+
+  fndfrq_exp_adj = gtk_adjustment_new (0, -100, 100, 1, 10, 0);
+  fndfrq_exp = gtk_spin_button_new (GTK_ADJUSTMENT (fndfrq_exp_adj), 1, 0);
+  gtk_widget_show (fndfrq_exp);
+  gtk_box_pack_start (GTK_BOX (fund_freq_left_hbox), fndfrq_exp, TRUE,
+		      TRUE, 0);
+
+  fndfrq_precslid_change = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (fndfrq_precslid_change);
+  gtk_box_pack_end (GTK_BOX (fund_freq_hbox), fndfrq_precslid_change,
+		    FALSE, FALSE, 0);
+
+  fndfrq_precslid_label = gtk_label_new (_("Precision Slider: "));
+  gtk_widget_show (fndfrq_precslid_label);
+  gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
+		      fndfrq_precslid_label, FALSE, FALSE, 0);
+
+  fndfrq_precslid_add = gtk_button_new_with_mnemonic (_("Add"));
+  gtk_widget_show (fndfrq_precslid_add);
+  gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
+		      fndfrq_precslid_add, FALSE, FALSE, 0);
+
+  fndfrq_precslid_remove = gtk_button_new_with_mnemonic (_("Remove"));
+  gtk_widget_show (fndfrq_precslid_remove);
+  gtk_box_pack_start (GTK_BOX (fndfrq_precslid_change),
+		      fndfrq_precslid_remove, FALSE, FALSE, 0);
+  if (cur_editor->freq_sliders.len <= 1)
+    gtk_widget_set_sensitive (fndfrq_precslid_remove, FALSE);
+
+  fund_freq_slider_vbox = gtk_vbox_new (FALSE, 0);
+  gtk_widget_show (fund_freq_slider_vbox);
+  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), fund_freq_slider_vbox,
+		      TRUE, FALSE, 0);
+
+  create_amp_rows (wvedit_holder_vbox, &amp);
+  if (cur_editor->amp_sliders.len <= 1)
+    gtk_widget_set_sensitive (amp.amp_precslid_remove, FALSE);
+
+  cur_editor->fndfrq_mntisa = fndfrq_mntisa;
+  cur_editor->fndfrq_exp = fndfrq_exp;
+  cur_editor->amp_mntisa = amp.amp_mntisa;
+  cur_editor->amp_exp = amp.amp_exp;
+  cur_editor->freq_slid_rm_btn = fndfrq_precslid_remove;
+  cur_editor->freq_sliders_vbox = fund_freq_slider_vbox;
+  cur_editor->amp_slid_rm_btn = amp.amp_precslid_remove;
+  cur_editor->amp_sliders_vbox = amp.amp_sliders_vbox;
+
+  if (cur_editor->freq_sliders.len == 0 &&
+      cur_editor->amp_sliders.len == 0)
     {
-      Wv_Editor_Data *cur_editor =
-	wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-      update_slider_bases (GTK_ENTRY (amp_mntisa), cur_editor, FALSE);
+      add_prec_slider (TRUE, 0);
+      add_prec_slider (TRUE, 1);
     }
 
-  /* Store pointers to all widgets, for use by lookup_widget().  */
-  /* GLADE_HOOKUP_OBJECT_NO_REF (wvedit_holder, wvedit_holder,
-				 "wvedit_holder");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, wvedit_holder_frame,
-		       "wvedit_holder_frame");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, wvedit_holder_vbox,
-		       "wvedit_holder_vbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fund_editor_hbox, "fund_editor_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fund_editor_left_hbox,
-		       "fund_editor_left_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_one_drop, "harmc_one_drop");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, mult_amps, "mult_amps");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fundset_hbox, "fundset_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fundset_label, "fundset_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fundset_add, "fundset_add");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fundset_remove, "fundset_remove");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fund_freq_hbox, "fund_freq_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fund_freq_left_hbox,
-		       "fund_freq_left_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_label, "fndfrq_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_mntisa, "fndfrq_mntisa");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_exp_label, "fndfrq_exp_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_exp, "fndfrq_exp");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_precslid_change,
-		       "fndfrq_precslid_change");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_precslid_label,
-		       "fndfrq_precslid_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_precslid_add,
-		       "fndfrq_precslid_add");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fndfrq_precslid_remove,
-		       "fndfrq_precslid_remove");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, fund_freq_slider_vbox,
-		       "fund_freq_slider_vbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, hscrollbar2, "hscrollbar2");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_editor_hbox, "harmc_editor_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_editor_left_hbox,
-		       "harmc_editor_left_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_sel_label, "harmc_sel_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_sel, "harmc_sel");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_window_hbox, "harmc_window_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_win_label, "harmc_win_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_win_add, "harmc_win_add");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_win_remove, "harmc_win_remove");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_change_hbox, "harmc_change_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_add_label, "harmc_add_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_add, "harmc_add");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, harmc_remove, "harmc_remove");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_hbox, "amp_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_left_hbox, "amp_left_hbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_set_label, "amp_set_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_mntisa, "amp_mntisa");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_exp_label, "amp_exp_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_exp, "amp_exp");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_precslid_change,
-		       "amp_precslid_change");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_precslid_label,
-		       "amp_precslid_label");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_precslid_add, "amp_precslid_add");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_precslid_remove,
-		       "amp_precslid_remove");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, amp_slider_vbox, "amp_slider_vbox");
-  GLADE_HOOKUP_OBJECT (wvedit_holder, hscrollbar1, "hscrollbar1"); */
+  g_signal_connect ((gpointer) harmc_one_drop, "clicked",
+		    G_CALLBACK (harmc_one_drop_clicked), NULL);
+  g_signal_connect ((gpointer) mult_amps, "clicked",
+		    G_CALLBACK (mult_amps_clicked), NULL);
+  g_signal_connect ((gpointer) gen_harmcs, "clicked",
+		    G_CALLBACK (gen_harmcs_clicked), NULL);
+  g_signal_connect ((gpointer) fundset_add, "clicked",
+		    G_CALLBACK (fundset_add_clicked),
+		    (gpointer)(index));
+  g_signal_connect ((gpointer) fundset_remove, "clicked",
+		    G_CALLBACK (fundset_remove_clicked),
+		    (gpointer)(index));
+  g_signal_connect ((gpointer) fndfrq_mntisa, "activate",
+		    G_CALLBACK (fndfrq_mntisa_activate),
+		    (gpointer)(index));
+  g_signal_connect ((gpointer) fndfrq_mntisa, "focus-out-event",
+		    G_CALLBACK (fndfrq_mntisa_focus_out),
+		    (gpointer)(index));
+  g_signal_connect ((gpointer) fndfrq_exp, "value_changed",
+		    G_CALLBACK (fndfrq_exp_value_changed),
+		    (gpointer)(index));
+  sci_notation_set_values (GTK_ENTRY (fndfrq_mntisa),
+			   GTK_SPIN_BUTTON (fndfrq_exp),
+			   wv_all_freqs->d[index].fund_freq);
+  g_signal_connect ((gpointer) fndfrq_precslid_add, "clicked",
+		    G_CALLBACK (precslid_add_clicked),
+		    (gpointer)(cur_editor->freq_sliders.d[0]));
+  g_signal_connect ((gpointer) fndfrq_precslid_remove, "clicked",
+		    G_CALLBACK (precslid_remove_clicked),
+		    (gpointer)(cur_editor->freq_sliders.d[0]));
+
+  g_signal_connect ((gpointer) amp.amp_mntisa, "activate",
+		    G_CALLBACK (fndamp_mntisa_activate),
+		    (gpointer)(cur_editor));
+  g_signal_connect ((gpointer) amp.amp_mntisa, "focus-out-event",
+		    G_CALLBACK (fndamp_mntisa_focus_out),
+		    (gpointer)(cur_editor));
+  g_signal_connect ((gpointer) amp.amp_exp, "value_changed",
+		    G_CALLBACK (fndamp_exp_value_changed),
+		    (gpointer)(cur_editor));
+  sci_notation_set_values (GTK_ENTRY (amp.amp_mntisa),
+			   GTK_SPIN_BUTTON (amp.amp_exp),
+			   wv_all_freqs->d[index].amplitude);
+  g_signal_connect ((gpointer) amp.amp_precslid_add, "clicked",
+		    G_CALLBACK (precslid_add_clicked),
+		    (gpointer)(cur_editor->amp_sliders.d[0]));
+  g_signal_connect ((gpointer) amp.amp_precslid_remove, "clicked",
+		    G_CALLBACK (precslid_remove_clicked),
+		    (gpointer)(cur_editor->amp_sliders.d[0]));
+
+  update_slider_bases (GTK_ENTRY (fndfrq_mntisa), cur_editor, TRUE);
+  update_slider_bases (GTK_ENTRY (amp.amp_mntisa), cur_editor, FALSE);
 
   return wvedit_holder_frame;
 }
 
+/**
+ * Create the widgets for a harmonic wave editor window.
+ *
+ * The widgets are not bound to any wave editor window in the data
+ * model, and no signals are connected.  The editor strip binds them
+ * to whichever wave editor window they are recycled for.  The frame
+ * is not shown.
+ */
+Harmc_View *
+create_harmc_view (void)
+{
+  Harmc_View *view;
+  GtkWidget *wvedit_holder_vbox;
+  GtkWidget *harmc_editor_hbox;
+  GtkWidget *harmc_editor_left_hbox;
+  GtkWidget *harmc_sel_label;
+  GtkWidget *harmc_sel;
+  GtkCellRenderer *harmc_sel_cell;
+  GtkWidget *harmc_window_hbox;
+  GtkWidget *harmc_win_label;
+  GtkWidget *harmc_win_add;
+  GtkWidget *harmc_win_remove;
+  GtkWidget *harmc_change_hbox;
+  GtkWidget *harmc_add_label;
+  GtkWidget *harmc_add;
+  GtkWidget *harmc_remove;
+
+  view = (Harmc_View *) g_slice_alloc0 (sizeof (Harmc_View));
+  view->widget = create_holder_frame (&wvedit_holder_vbox);
+
+  harmc_editor_hbox = gtk_hbox_new (FALSE, 5);
+  gtk_widget_show (harmc_editor_hbox);
+  gtk_box_pack_start (GTK_BOX (wvedit_holder_vbox), harmc_editor_hbox,
+		      TRUE, FALSE, 0);
+
+  harmc_editor_left_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (harmc_editor_left_hbox);
+  gtk_box_pack_start (GTK_BOX (harmc_editor_hbox), harmc_editor_left_hbox,
+		      FALSE, FALSE, 0);
+
+  harmc_sel_label = gtk_label_new (_("Harmonic "));
+  gtk_widget_show (harmc_sel_label);
+  gtk_box_pack_start (GTK_BOX (harmc_editor_left_hbox), harmc_sel_label,
+		      FALSE, FALSE, 0);
+
+  /* The model is shared by all of the harmonic selection combo boxes
+     of a fundamental set, and it is set when the view is bound.  */
+  harmc_sel = gtk_combo_box_new ();
+  harmc_sel_cell = gtk_cell_renderer_text_new ();
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (harmc_sel), harmc_sel_cell,
+			      TRUE);
+  gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (harmc_sel), harmc_sel_cell,
+				  "text", 0, NULL);
+  gtk_widget_show (harmc_sel);
+  gtk_box_pack_start (GTK_BOX (harmc_editor_left_hbox), harmc_sel, TRUE,
+		      TRUE, 0);
+  gtk_widget_set_size_request (harmc_sel, 75, -1);
+
+  harmc_window_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (harmc_window_hbox);
+  gtk_box_pack_start (GTK_BOX (harmc_editor_hbox), harmc_window_hbox, TRUE,
+		      FALSE, 0);
+
+  harmc_win_label = gtk_label_new (_("Harmonic Window: "));
+  gtk_widget_show (harmc_win_label);
+  gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_label, FALSE,
+		      FALSE, 0);
+
+  harmc_win_add = gtk_button_new_with_mnemonic (_("Add"));
+  gtk_widget_show (harmc_win_add);
+  gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_add, FALSE,
+		      FALSE, 0);
+
+  harmc_win_remove = gtk_button_new_with_mnemonic (_("Remove"));
+  gtk_widget_show (harmc_win_remove);
+  gtk_box_pack_start (GTK_BOX (harmc_window_hbox), harmc_win_remove, FALSE,
+		      FALSE, 0);
+
+  harmc_change_hbox = gtk_hbox_new (FALSE, 0);
+  gtk_widget_show (harmc_change_hbox);
+  gtk_box_pack_end (GTK_BOX (harmc_editor_hbox), harmc_change_hbox, FALSE,
+		    FALSE, 0);
+
+  harmc_add_label = gtk_label_new (_("Harmonic: "));
+  gtk_widget_show (harmc_add_label);
+  gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_add_label, FALSE,
+		      FALSE, 0);
+
+  harmc_add = gtk_button_new_with_mnemonic (_("Add"));
+  gtk_widget_show (harmc_add);
+  gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_add, FALSE, FALSE,
+		      0);
+
+  harmc_remove = gtk_button_new_with_mnemonic (_("Remove"));
+  gtk_widget_show (harmc_remove);
+  gtk_box_pack_start (GTK_BOX (harmc_change_hbox), harmc_remove, FALSE,
+		      FALSE, 0);
+
+  create_amp_rows (wvedit_holder_vbox, view);
+
+  view->harmc_sel = harmc_sel;
+  view->harmc_win_add = harmc_win_add;
+  view->harmc_win_remove = harmc_win_remove;
+  view->harmc_add = harmc_add;
+  view->harmc_remove = harmc_remove;
+  view->editor = NULL;
+  return view;
+}
+
 /**
  * Creates the "Multiply Amplitudes" dialog.
  */
@@ -925,6 +893,245 @@ create_mult_amps_dialog (void)
   return mult_amps_dialog;
 }
 
+/**
+ * Creates the "Generate Harmonics" dialog.
+ */
+GtkWidget *
+create_gen_harmcs_dialog (void)
+{
+  GtkWidget *gen_harmcs_dialog;
+  GtkWidget *dialog_main_vbox;
+  GtkWidget *gen_table;
+  GtkWidget *series_label;
+  GtkWidget *series_combo;
+  GtkWidget *count_label;
+  GtkObject *count_adj;
+  GtkWidget *count_spin;
+  GtkWidget *rolloff_label;
+  GtkObject *rolloff_adj;
+  GtkWidget *rolloff_spin;
+
+  gen_harmcs_dialog = gtk_dialog_new_with_buttons (_("Generate Harmonics"),
+			  GTK_WINDOW (main_window),
+			  GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+			  GTK_STOCK_CANCEL, GTK_RESPONSE_REJECT,
+			  GTK_STOCK_OK, GTK_RESPONSE_ACCEPT, NULL);
+
+  dialog_main_vbox = GTK_DIALOG (gen_harmcs_dialog)->vbox;
+  gtk_widget_show (dialog_main_vbox);
+
+  gen_table = gtk_table_new (3, 2, FALSE);
+  gtk_widget_show (gen_table);
+  gtk_box_pack_start (GTK_BOX (dialog_main_vbox), gen_table, TRUE, TRUE, 0);
+  gtk_container_set_border_width (GTK_CONTAINER (gen_table), 5);
+  gtk_table_set_row_spacings (GTK_TABLE (gen_table), 5);
+  gtk_table_set_col_spacings (GTK_TABLE (gen_table), 5);
+
+  series_label = gtk_label_new (_("Series: "));
+  gtk_widget_show (series_label);
+  gtk_misc_set_alignment (GTK_MISC (series_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (gen_table), series_label, 0, 1, 0, 1,
+		    GTK_FILL, 0, 0, 0);
+
+  /* The entries must be in the order of Harmc_Series.  */
+  series_combo = gtk_combo_box_new_text ();
+  gtk_combo_box_append_text (GTK_COMBO_BOX (series_combo),
+			     _("Sawtooth (1/n)"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (series_combo),
+			     _("Square (odd, 1/n)"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (series_combo),
+			     _("Triangle (odd, 1/n\302\262)"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (series_combo),
+			     _("Inverse square (1/n\302\262)"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (series_combo),
+			     _("Exponential rolloff"));
+  gtk_combo_box_set_active (GTK_COMBO_BOX (series_combo),
+			    HARMC_SERIES_SAWTOOTH);
+  gtk_widget_show (series_combo);
+  gtk_table_attach (GTK_TABLE (gen_table), series_combo, 1, 2, 0, 1,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+
+  count_label = gtk_label_new (_("Number of harmonics: "));
+  gtk_widget_show (count_label);
+  gtk_misc_set_alignment (GTK_MISC (count_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (gen_table), count_label, 0, 1, 1, 2,
+		    GTK_FILL, 0, 0, 0);
+
+  count_adj = gtk_adjustment_new (20, 1, 10000, 1, 10, 0);
+  count_spin = gtk_spin_button_new (GTK_ADJUSTMENT (count_adj), 1, 0);
+  gtk_widget_show (count_spin);
+  gtk_table_attach (GTK_TABLE (gen_table), count_spin, 1, 2, 1, 2,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+
+  rolloff_label = gtk_label_new (_("Rolloff: "));
+  gtk_widget_show (rolloff_label);
+  gtk_misc_set_alignment (GTK_MISC (rolloff_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (gen_table), rolloff_label, 0, 1, 2, 3,
+		    GTK_FILL, 0, 0, 0);
+
+  rolloff_adj = gtk_adjustment_new (0.5, 0.01, 1, 0.01, 0.1, 0);
+  rolloff_spin = gtk_spin_button_new (GTK_ADJUSTMENT (rolloff_adj), 0.01, 2);
+  gtk_widget_show (rolloff_spin);
+  gtk_table_attach (GTK_TABLE (gen_table), rolloff_spin, 1, 2, 2, 3,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+  gtk_widget_set_sensitive (rolloff_spin, FALSE);
+
+  g_signal_connect ((gpointer) series_combo, "changed",
+		    G_CALLBACK (gen_series_changed), (gpointer) rolloff_spin);
+
+  /* Store pointers to all widgets, for use by lookup_widget().  */
+  GLADE_HOOKUP_OBJECT_NO_REF (gen_harmcs_dialog, gen_harmcs_dialog,
+			      "gen_harmcs_dialog");
+  GLADE_HOOKUP_OBJECT (gen_harmcs_dialog, series_combo, "series_combo");
+  GLADE_HOOKUP_OBJECT (gen_harmcs_dialog, count_spin, "count_spin");
+  GLADE_HOOKUP_OBJECT (gen_harmcs_dialog, rolloff_spin, "rolloff_spin");
+
+  return gen_harmcs_dialog;
+}
+
+/**
+ * Creates a dialog that shows the progress of work that is done on
+ * another thread, such as loading a project file.
+ *
+ * The dialog has a Cancel button but is not run with
+ * gtk_dialog_run(), since the main loop keeps going while the work
+ * is done.
+ * @param title the title of the dialog
+ * @param text the text above the progress bar
+ */
+GtkWidget *
+create_progress_dialog (const gchar * title, const gchar * text)
+{
+  GtkWidget *progress_dialog;
+  GtkWidget *dialog_main_vbox;
+  GtkWidget *progress_label;
+  GtkWidget *progress_bar;
+
+  progress_dialog = gtk_dialog_new_with_buttons (title,
+			  GTK_WINDOW (main_window),
+			  GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+			  GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL, NULL);
+  gtk_window_set_resizable (GTK_WINDOW (progress_dialog), FALSE);
+
+  dialog_main_vbox = GTK_DIALOG (progress_dialog)->vbox;
+  gtk_box_set_spacing (GTK_BOX (dialog_main_vbox), 5);
+  gtk_widget_show (dialog_main_vbox);
+
+  progress_label = gtk_label_new (text);
+  gtk_widget_show (progress_label);
+  gtk_box_pack_start (GTK_BOX (dialog_main_vbox), progress_label,
+		      FALSE, FALSE, 0);
+  gtk_misc_set_alignment (GTK_MISC (progress_label), 0, 0.5);
+  gtk_misc_set_padding (GTK_MISC (progress_label), 5, 5);
+
+  progress_bar = gtk_progress_bar_new ();
+  gtk_widget_set_size_request (progress_bar, 300, -1);
+  gtk_widget_show (progress_bar);
+  gtk_box_pack_start (GTK_BOX (dialog_main_vbox), progress_bar,
+		      FALSE, FALSE, 0);
+
+  /* Store pointers to all widgets, for use by lookup_widget().  */
+  GLADE_HOOKUP_OBJECT_NO_REF (progress_dialog, progress_dialog,
+			      "progress_dialog");
+  GLADE_HOOKUP_OBJECT (progress_dialog, progress_label, "progress_label");
+  GLADE_HOOKUP_OBJECT (progress_dialog, progress_bar, "progress_bar");
+
+  return progress_dialog;
+}
+
+/**
+ * Creates the "Render Audio" dialog, which asks for the file to
+ * render to along with the length, sample rate, and sample format.
+ *
+ * @param rate the sample rate to suggest
+ */
+GtkWidget *
+create_render_dialog (unsigned rate)
+{
+  GtkWidget *render_dialog;
+  GtkWidget *render_table;
+  GtkWidget *duration_label;
+  GtkObject *duration_adj;
+  GtkWidget *duration_spin;
+  GtkWidget *rate_label;
+  GtkObject *rate_adj;
+  GtkWidget *rate_spin;
+  GtkWidget *format_label;
+  GtkWidget *format_combo;
+  GtkFileFilter *filter;
+
+  render_dialog = gtk_file_chooser_dialog_new (_("Render Audio"),
+				 GTK_WINDOW (main_window),
+				 GTK_FILE_CHOOSER_ACTION_SAVE,
+				 GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+				 _("_Render"), GTK_RESPONSE_ACCEPT,
+				 NULL);
+  filter = gtk_file_filter_new ();
+  gtk_file_filter_set_name (filter, _("WAVE Audio Files"));
+  gtk_file_filter_add_pattern (filter, "*.wav");
+  gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (render_dialog), filter);
+
+  render_table = gtk_table_new (3, 2, FALSE);
+  gtk_widget_show (render_table);
+  gtk_table_set_row_spacings (GTK_TABLE (render_table), 5);
+  gtk_table_set_col_spacings (GTK_TABLE (render_table), 5);
+  gtk_file_chooser_set_extra_widget (GTK_FILE_CHOOSER (render_dialog),
+				     render_table);
+
+  duration_label = gtk_label_new (_("Length in seconds: "));
+  gtk_widget_show (duration_label);
+  gtk_misc_set_alignment (GTK_MISC (duration_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (render_table), duration_label, 0, 1, 0, 1,
+		    GTK_FILL, 0, 0, 0);
+
+  duration_adj = gtk_adjustment_new (10, 0.1, 36000, 1, 10, 0);
+  duration_spin = gtk_spin_button_new (GTK_ADJUSTMENT (duration_adj), 1, 1);
+  gtk_widget_show (duration_spin);
+  gtk_table_attach (GTK_TABLE (render_table), duration_spin, 1, 2, 0, 1,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+
+  rate_label = gtk_label_new (_("Sample rate: "));
+  gtk_widget_show (rate_label);
+  gtk_misc_set_alignment (GTK_MISC (rate_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (render_table), rate_label, 0, 1, 1, 2,
+		    GTK_FILL, 0, 0, 0);
+
+  rate_adj = gtk_adjustment_new (rate, 1000, 384000, 100, 1000, 0);
+  rate_spin = gtk_spin_button_new (GTK_ADJUSTMENT (rate_adj), 100, 0);
+  gtk_widget_show (rate_spin);
+  gtk_table_attach (GTK_TABLE (render_table), rate_spin, 1, 2, 1, 2,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+
+  format_label = gtk_label_new (_("Sample format: "));
+  gtk_widget_show (format_label);
+  gtk_misc_set_alignment (GTK_MISC (format_label), 0, 0.5);
+  gtk_table_attach (GTK_TABLE (render_table), format_label, 0, 1, 2, 3,
+		    GTK_FILL, 0, 0, 0);
+
+  /* The entries must be in the order of Sample_Format.  */
+  format_combo = gtk_combo_box_new_text ();
+  gtk_combo_box_append_text (GTK_COMBO_BOX (format_combo),
+			     _("32-bit float"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (format_combo),
+			     _("16-bit integer"));
+  gtk_combo_box_append_text (GTK_COMBO_BOX (format_combo),
+			     _("24-bit integer"));
+  gtk_combo_box_set_active (GTK_COMBO_BOX (format_combo),
+			    SAMPLE_FORMAT_S16);
+  gtk_widget_show (format_combo);
+  gtk_table_attach (GTK_TABLE (render_table), format_combo, 1, 2, 2, 3,
+		    GTK_EXPAND | GTK_FILL, 0, 0, 0);
+
+  /* Store pointers to all widgets, for use by lookup_widget().  */
+  GLADE_HOOKUP_OBJECT_NO_REF (render_dialog, render_dialog,
+			      "render_dialog");
+  GLADE_HOOKUP_OBJECT (render_dialog, duration_spin, "duration_spin");
+  GLADE_HOOKUP_OBJECT (render_dialog, rate_spin, "rate_spin");
+  GLADE_HOOKUP_OBJECT (render_dialog, format_combo, "format_combo");
+
+  return render_dialog;
+}
+
 /**
  * Adds a precision slider to the given editor.
  *
@@ -940,85 +1147,38 @@ add_prec_slider (gboolean fund_editor, unsigned index)
   GtkWidget *hscrollbar;
   GtkWidget *parent_box;
   Slide_Data *sd_block;
+  Wv_Fund_Ui *ui = wv_all_freqs->d[g_fund_set].ui;
+  Slide_Data_List *sliders;
+
+  if (fund_editor && index == 0)
+    {
+      sliders = &ui->fund_editor.freq_sliders;
+      parent_box = ui->fund_editor.freq_sliders_vbox;
+    }
+  else if (fund_editor)
+    {
+      sliders = &ui->fund_editor.amp_sliders;
+      parent_box = ui->fund_editor.amp_sliders_vbox;
+    }
+  else
+    {
+      sliders = &ui->wv_editors->d[index]->amp_sliders;
+      parent_box = ui->wv_editors->d[index]->amp_sliders_vbox;
+    }
+  /* Further sliders could not change the value anyway.  */
+  if (sliders->len == MAX_PREC_SLIDERS)
+    return;
 
   hscrollbar =
     gtk_hscrollbar_new (GTK_ADJUSTMENT
 			(gtk_adjustment_new (10, 0, 21, 0.1, 1.0, 1.0)));
   gtk_widget_show (hscrollbar);
 
-  sd_block = (Slide_Data *) g_slice_alloc (sizeof (Slide_Data));
+  sd_block = append_slide_data (sliders, fund_editor, index);
   sd_block->widget = hscrollbar;
-  sd_block->last_value = 10;
-
-  if (fund_editor)
-    {
-      if (index == 0)
-	{
-	  Wv_Editor_Data *cur_editor =
-	    &wv_all_freqs->d[g_fund_set].fund_editor;
-	  parent_box = cur_editor->freq_sliders_vbox;
-
-	  sd_block->index = cur_editor->freq_sliders->len;
-	  sd_block->fund_assoc = TRUE;
-	  sd_block->parent_index = 0;
-	  sd_block->base = -10.0 * pow(100, -((gdouble) sd_block->index));
-	  if (sd_block->index > 0)
-	    {
-	      Slide_Data *last_slider =
-		cur_editor->freq_sliders->d[sd_block->index-1];
-	      gdouble value_mult =
-		pow(100, -((gdouble) (sd_block->index - 1)));
-	      sd_block->base +=
-		last_slider->base + last_slider->last_value * value_mult;
-	    }
-
-	  g_array_append_val ((GArray *) cur_editor->freq_sliders, sd_block);
-	}
-      else
-	{
-	  Wv_Editor_Data *cur_editor =
-	    &wv_all_freqs->d[g_fund_set].fund_editor;
-	  parent_box = cur_editor->amp_sliders_vbox;
-
-	  sd_block->index = cur_editor->amp_sliders->len;
-	  sd_block->fund_assoc = TRUE;
-	  sd_block->parent_index = 1;
-	  sd_block->base = -10.0 * pow(100, -((gdouble) sd_block->index));
-	  if (sd_block->index > 0)
-	    {
-	      Slide_Data *last_slider =
-		cur_editor->amp_sliders->d[sd_block->index-1];
-	      gdouble value_mult =
-		pow(100, -((gdouble) (sd_block->index - 1)));
-	      sd_block->base +=
-		last_slider->base + last_slider->last_value * value_mult;
-	    }
+  if (!fund_editor)
+    editor_strip_invalidate (g_fund_set);
 
-	  g_array_append_val ((GArray *) cur_editor->amp_sliders, sd_block);
-	}
-    }
-  else
-    {
-      Wv_Editor_Data *cur_editor =
-	wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-      parent_box = cur_editor->amp_sliders_vbox;
-
-      sd_block->index = cur_editor->amp_sliders->len;
-      sd_block->fund_assoc = FALSE;
-      sd_block->parent_index = index;
-      sd_block->base = -10.0 * pow(100, -((gdouble) sd_block->index));
-      if (sd_block->index > 0)
-	{
-	  Slide_Data *last_slider =
-	    cur_editor->amp_sliders->d[sd_block->index-1];
-	  gdouble value_mult =
-	    pow(100, -((gdouble) (sd_block->index - 1)));
-	  sd_block->base +=
-	    last_slider->base + last_slider->last_value * value_mult;
-	}
-
-      g_array_append_val ((GArray *) cur_editor->amp_sliders, sd_block);
-    }
   gtk_box_pack_start (GTK_BOX (parent_box), hscrollbar, TRUE, TRUE, 0);
   g_signal_connect ((gpointer) hscrollbar, "value_changed",
 		    G_CALLBACK (precslid_value_changed),
@@ -1040,40 +1200,42 @@ remove_prec_slider (gboolean fund_editor, unsigned index)
   /* We will assume it to be unnecessary to nullify the pointer to the
      freed array entry, since it will be beyond the bounds of the
      array.  */
+  precslid_flush ();
   if (fund_editor)
     {
       if (index == 0)
 	{
 	  Wv_Editor_Data *cur_editor;
 	  unsigned last_slider;
-	  cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
-	  last_slider = cur_editor->freq_sliders->len - 1;
-	  gtk_widget_destroy (cur_editor->freq_sliders->d[last_slider]->
+	  cur_editor = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+	  last_slider = cur_editor->freq_sliders.len - 1;
+	  gtk_widget_destroy (cur_editor->freq_sliders.d[last_slider]->
 			      widget);
-	  g_slice_free1 (sizeof (Slide_Data), cur_editor->
-		freq_sliders->d[--cur_editor->freq_sliders->len]);
+	  free_slide_data (cur_editor->
+			   freq_sliders.d[--cur_editor->freq_sliders.len]);
 	}
       else
 	{
 	  Wv_Editor_Data *cur_editor;
 	  unsigned last_slider;
-	  cur_editor = &wv_all_freqs->d[g_fund_set].fund_editor;
-	  last_slider = cur_editor->amp_sliders->len - 1;
+	  cur_editor = &wv_all_freqs->d[g_fund_set].ui->fund_editor;
+	  last_slider = cur_editor->amp_sliders.len - 1;
 	  gtk_widget_destroy (cur_editor->
-			      amp_sliders->d[last_slider]->widget);
-	  g_slice_free1 (sizeof (Slide_Data), cur_editor->
-			 amp_sliders->d[--cur_editor->amp_sliders->len]);
+			      amp_sliders.d[last_slider]->widget);
+	  free_slide_data (cur_editor->
+			   amp_sliders.d[--cur_editor->amp_sliders.len]);
 	}
     }
   else
     {
       Wv_Editor_Data *cur_editor;
       unsigned last_slider;
-      cur_editor = wv_all_freqs->d[g_fund_set].wv_editors->d[index];
-      last_slider = cur_editor->amp_sliders->len - 1;
-      gtk_widget_destroy (cur_editor->amp_sliders->d[last_slider]->widget);
-      g_slice_free1 (sizeof (Slide_Data), cur_editor->
-		     amp_sliders->d[--cur_editor->amp_sliders->len]);
+      cur_editor = wv_all_freqs->d[g_fund_set].ui->wv_editors->d[index];
+      last_slider = cur_editor->amp_sliders.len - 1;
+      gtk_widget_destroy (cur_editor->amp_sliders.d[last_slider]->widget);
+      free_slide_data (cur_editor->
+		       amp_sliders.d[--cur_editor->amp_sliders.len]);
+      editor_strip_invalidate (g_fund_set);
     }
 }
 
@@ -1241,4 +1403,6 @@ interface_shutdown (void)
   gtk_widget_destroy (play_image); g_object_unref (play_image);
   gtk_widget_destroy (stop_image); g_object_unref (stop_image);
   g_object_unref (wr_gc);
+  undo_action = NULL;
+  redo_action = NULL;
 }
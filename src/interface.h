@@ -52,10 +52,16 @@ extern GtkWidget *b_play;
 extern GtkWidget *play_image;
 extern GtkWidget *stop_image;
 extern GtkWidget *manual_window;
+extern GtkAction *undo_action;
+extern GtkAction *redo_action;
 
 GtkWidget *create_main_window (void);
-GtkWidget *create_wvedit_holder (gboolean first_type, unsigned index);
+GtkWidget *create_fund_editor (unsigned index);
+struct _Harmc_View *create_harmc_view (void);
 GtkWidget *create_mult_amps_dialog (void);
+GtkWidget *create_gen_harmcs_dialog (void);
+GtkWidget *create_progress_dialog (const gchar * title, const gchar * text);
+GtkWidget *create_render_dialog (unsigned rate);
 void add_prec_slider (gboolean fund_editor, unsigned index);
 void remove_prec_slider (gboolean fund_editor, unsigned index);
 void set_render_colors (GdkColor * foreground, GdkColor * background);
@@ -46,14 +46,90 @@ DAMAGE.  */
 #include "support.h"
 #include "wv_editors.h"
 #include "audio.h"
+#include "tile_pool.h"
+#include "wave_view.h"
+#include "scope_view.h"
+#include "spectrum_view.h"
+#include "editor_strip.h"
+#include "headless.h"
+#include "project_loader.h"
+#include "project_saver.h"
+#include "autosave.h"
+#include "wav_exporter.h"
 
 gchar *package_prefix = PACKAGE_PREFIX;
 gchar *package_data_dir = PACKAGE_DATA_DIR;
 gchar *package_locale_dir = PACKAGE_LOCALE_DIR;
 
+static gchar *opt_generate = NULL;
+static gchar *opt_output = NULL;
+static gchar *opt_render_wav = NULL;
+static gboolean opt_stream = FALSE;
+static gboolean opt_realtime = FALSE;
+/** Length given with --duration, which is positive, or zero if the
+    option was not given.  */
+static gdouble opt_duration = 0.0;
+static gint opt_rate = DEFAULT_SAMPLE_RATE;
+static gchar *opt_format = NULL;
+
+/**
+ * Parses the argument of --duration, which must be a positive number
+ * of seconds.
+ */
+static gboolean
+parse_duration (const gchar * option_name, const gchar * value,
+		gpointer data, GError ** error)
+{
+  gchar *end;
+  gdouble duration = g_ascii_strtod (value, &end);
+
+  /* This also rejects NaN.  */
+  if (end == value || *end != '\0' || !(duration > 0.0) ||
+      duration > G_MAXDOUBLE)
+    {
+      g_set_error (error, G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+		   _("Invalid length `%s' for %s: it must be a positive "
+		     "number of seconds"), value, option_name);
+      return FALSE;
+    }
+  opt_duration = duration;
+  return TRUE;
+}
+
+static GOptionEntry option_entries[] =
+{
+  { "generate", 'g', 0, G_OPTION_ARG_STRING, &opt_generate,
+    N_("Replace the harmonics of every fundamental set with a generated "
+       "series, save, and exit without opening a window"),
+    N_("SERIES:COUNT[:ROLLOFF]") },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &opt_output,
+    N_("Save to FILE rather than over the opened project.  Without "
+       "--generate, convert the opened project to FILE, in the binary "
+       "format if FILE ends in .sliwb, and exit"), N_("FILE") },
+  { "render-wav", 'w', 0, G_OPTION_ARG_FILENAME, &opt_render_wav,
+    N_("Render the opened project to a WAVE file and exit"), N_("FILE") },
+  { "stream", 's', 0, G_OPTION_ARG_NONE, &opt_stream,
+    N_("Write raw samples of the opened project to standard output, or "
+       "to the file or named pipe given with --output, and exit"), NULL },
+  { "realtime", 0, 0, G_OPTION_ARG_NONE, &opt_realtime,
+    N_("With --stream, write samples no faster than they are played"),
+    NULL },
+  { "duration", 'd', 0, G_OPTION_ARG_CALLBACK, parse_duration,
+    N_("Length of the rendered audio in seconds (default 10, or "
+       "until the reader stops with --stream)"), N_("SECONDS") },
+  { "rate", 'r', 0, G_OPTION_ARG_INT, &opt_rate,
+    N_("Sample rate of the rendered audio (default 44100)"), N_("HZ") },
+  { "format", 'f', 0, G_OPTION_ARG_STRING, &opt_format,
+    N_("Sample format of the rendered audio: f32le, s16le, or s24le "
+       "(default s16le)"), N_("FORMAT") },
+  { NULL }
+};
+
 int
 main (int argc, char *argv[])
 {
+  int exit_status = 0;
+
   /* Initialize packge paths.  */
 #ifdef G_OS_WIN32
   package_prefix = g_win32_get_package_installation_directory (NULL, NULL);
@@ -74,6 +150,61 @@ main (int argc, char *argv[])
   textdomain (GETTEXT_PACKAGE);
 #endif
 
+  /* Parse Slider's own options.  GTK+ parses its options later, so
+     unknown options are left alone.  */
+  {
+    GOptionContext *context;
+    GError *error = NULL;
+    context = g_option_context_new (_("[FILE]"));
+    g_option_context_add_main_entries (context, option_entries,
+				       GETTEXT_PACKAGE);
+    g_option_context_set_ignore_unknown_options (context, TRUE);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+      {
+	g_printerr ("%s: %s\n", g_get_prgname (), error->message);
+	g_error_free (error);
+	g_option_context_free (context);
+	exit_status = 1;
+	goto cleanup;
+      }
+    g_option_context_free (context);
+  }
+  /* The waveform display and audio rendering use worker threads, so
+     the GLib thread system must be initialized first.  */
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+
+  if (opt_render_wav != NULL)
+    {
+      exit_status = headless_render_wav ((argc > 1) ? argv[1] : NULL,
+					 opt_render_wav,
+					 (opt_duration != 0.0) ?
+					 opt_duration : 10.0,
+					 opt_rate, (opt_format != NULL) ?
+					 opt_format : "s16le");
+      goto cleanup;
+    }
+  if (opt_stream)
+    {
+      exit_status = headless_stream ((argc > 1) ? argv[1] : NULL,
+				     opt_output, opt_duration, opt_rate,
+				     (opt_format != NULL) ?
+				     opt_format : "s16le", opt_realtime);
+      goto cleanup;
+    }
+  if (opt_generate != NULL)
+    {
+      exit_status = headless_generate ((argc > 1) ? argv[1] : NULL,
+				       opt_output, opt_generate);
+      goto cleanup;
+    }
+  if (opt_output != NULL)
+    {
+      exit_status = headless_convert ((argc > 1) ? argv[1] : NULL,
+				      opt_output);
+      goto cleanup;
+    }
+
   /* Initialize GTK+.  */
   gtk_set_locale ();
   gtk_init (&argc, &argv);
@@ -95,24 +226,17 @@ main (int argc, char *argv[])
     g_list_free (icon_list);
   }
 
-  /* Initialize Slider's data model.  */
+  /* Initialize Slider's data model.  A project file given on the
+     command line is loaded in the background once the main window is
+     up.  */
   init_wv_editors ();
-  if (argc > 1)
-    {
-      if (!load_sliw_project (argv[1]))
-	{
-	  free_wv_editors ();
-	  init_wv_editors ();
-	  new_sliw_project ();
-	}
-      else
-	loaded_fname = g_strdup (argv[1]);
-    }
-  else
-    new_sliw_project ();
+  new_sliw_project ();
 
   /* Initialize audio.  */
+  scope_view_init ();
+  spectrum_view_init ();
   audio_init ();
+  wave_view_init ();
 
   { /* Start everything up.  */
     GdkColor foreground, background;
@@ -126,12 +250,30 @@ main (int argc, char *argv[])
     g_signal_connect ((gpointer) main_window, "destroy",
 		      G_CALLBACK (gtk_main_quit), NULL);
   }
+  autosave_init ();
+  if (!autosave_recover ((argc > 1) ? argv[1] : NULL) && argc > 1)
+    project_loader_start (argv[1]);
+  autosave_start ();
   gtk_main ();
 
   /* Shutdown.  */
+  project_loader_shutdown ();
+  project_saver_shutdown ();
+  wav_exporter_shutdown ();
+  autosave_shutdown ();
+  wave_view_shutdown ();
+  tile_pool_shutdown ();
   interface_shutdown ();
+  editor_strip_shutdown ();
   audio_shutdown ();
+  scope_view_shutdown ();
+  spectrum_view_shutdown ();
   free_wv_editors ();
+ cleanup:
+  g_free (opt_generate);
+  g_free (opt_output);
+  g_free (opt_render_wav);
+  g_free (opt_format);
 #ifdef G_OS_WIN32
   g_free (package_prefix);
   g_free (package_data_dir);
@@ -141,7 +283,7 @@ main (int argc, char *argv[])
   free (package_data_dir);
   free (package_locale_dir);
 #endif
-  return 0;
+  return exit_status;
 }
 
 #ifdef _MSC_VER
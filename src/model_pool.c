@@ -0,0 +1,124 @@
+/* Pool allocator for the data model.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "model_pool.h"
+
+/** Alignment of every object handed out by a pool.  */
+#define POOL_ALIGN MAX (sizeof (gdouble), sizeof (gpointer))
+
+struct _Model_Pool
+{
+  gsize obj_size; /**< Object size, rounded up to ::POOL_ALIGN */
+  unsigned objs_per_block;
+  /** Freed objects, linked through their first word */
+  gpointer free_list;
+  /** Next object that has never been handed out */
+  guint8 *next_obj;
+  /** End of the block that @a next_obj points into */
+  guint8 *block_end;
+  /** Every block allocated by this pool */
+  GPtrArray *blocks;
+};
+
+/**
+ * Creates a pool of fixed-size objects.
+ *
+ * @param obj_size the size of each object
+ * @param objs_per_block the number of objects to allocate from the
+ * system at once
+ */
+Model_Pool *
+model_pool_new (gsize obj_size, unsigned objs_per_block)
+{
+  Model_Pool *pool = g_new (Model_Pool, 1);
+  obj_size = MAX (obj_size, sizeof (gpointer));
+  pool->obj_size = (obj_size + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN;
+  pool->objs_per_block = objs_per_block;
+  pool->free_list = NULL;
+  pool->next_obj = NULL;
+  pool->block_end = NULL;
+  pool->blocks = g_ptr_array_new ();
+  return pool;
+}
+
+/**
+ * Allocates an object from a pool.  The object's contents are
+ * undefined.
+ */
+gpointer
+model_pool_alloc (Model_Pool * pool)
+{
+  gpointer obj;
+  if (pool->free_list != NULL)
+    {
+      obj = pool->free_list;
+      pool->free_list = *(gpointer *) obj;
+      return obj;
+    }
+  if (pool->next_obj == pool->block_end)
+    {
+      gsize block_size = pool->obj_size * pool->objs_per_block;
+      pool->next_obj = (guint8 *) g_malloc (block_size);
+      pool->block_end = pool->next_obj + block_size;
+      g_ptr_array_add (pool->blocks, pool->next_obj);
+    }
+  obj = pool->next_obj;
+  pool->next_obj += pool->obj_size;
+  return obj;
+}
+
+/**
+ * Returns an object to a pool so that it can be reused.
+ */
+void
+model_pool_free (Model_Pool * pool, gpointer obj)
+{
+  *(gpointer *) obj = pool->free_list;
+  pool->free_list = obj;
+}
+
+/**
+ * Frees a pool along with every object that was allocated from it.
+ */
+void
+model_pool_destroy (Model_Pool * pool)
+{
+  unsigned i;
+  for (i = 0; i < pool->blocks->len; i++)
+    g_free (g_ptr_array_index (pool->blocks, i));
+  g_ptr_array_free (pool->blocks, TRUE);
+  g_free (pool);
+}
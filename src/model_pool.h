@@ -0,0 +1,53 @@
+/* Pool allocator for the data model.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Pool allocator for the data model.
+ *
+ * The wave editor windows and precision sliders of a project are
+ * small fixed-size structures whose addresses must never change,
+ * since they are passed as @a user_data to signal handlers.  A pool
+ * hands them out from large blocks, reuses freed structures through
+ * a free list, and releases everything at once when the project is
+ * closed.
+ */
+
+#ifndef MODEL_POOL_H
+#define MODEL_POOL_H
+
+typedef struct _Model_Pool Model_Pool;
+
+Model_Pool *model_pool_new (gsize obj_size, unsigned objs_per_block);
+gpointer model_pool_alloc (Model_Pool * pool);
+void model_pool_free (Model_Pool * pool, gpointer obj);
+void model_pool_destroy (Model_Pool * pool);
+
+#endif /* not MODEL_POOL_H */
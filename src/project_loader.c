@@ -0,0 +1,391 @@
+/* Loading project files in the background.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include "project_loader.h"
+#include "autosave.h"
+#include "callbacks.h"
+#include "interface.h"
+#include "support.h"
+#include "wv_editors.h"
+#include "wave_view.h"
+
+/** Milliseconds between updates of the progress bar.  */
+#define PROGRESS_UPDATE_INTERVAL 100
+/** The progress is shared between threads as an integer fraction of
+    this.  */
+#define PROGRESS_SCALE 10000
+/** Number of sets whose user interface state is created per idle
+    call after a project was swapped in.  */
+#define POPULATE_BATCH 256
+
+typedef struct _Load_Job Load_Job;
+
+/**
+ * State of loading one project file.
+ *
+ * The worker thread only touches @a model, @a error, @a error_loc,
+ * @a saved_errno, and the atomic fields until it has scheduled
+ * load_finished(), and the main thread does not touch those before
+ * then.
+ */
+struct _Load_Job
+{
+  gchar *filename;
+  /** The project that is read into, or NULL once it was swapped in */
+  Wv_Fund_Freq_array *model;
+  Core_Error error;
+  Core_Location error_loc;
+  int saved_errno; /**< @c errno right after the file was read */
+  /** How much of the work is done, out of ::PROGRESS_SCALE */
+  volatile gint progress;
+  /** Set to nonzero to make the worker thread stop */
+  volatile gint cancel;
+  /** The worker thread, or NULL after it was joined */
+  GThread *thread;
+  /** The progress dialog, or NULL if it was destroyed */
+  GtkWidget *dialog;
+  guint timeout_source;
+  /** Next set to create the user interface state of */
+  unsigned next_set;
+};
+
+/** The project file that is being loaded, or NULL if none is.  */
+static Load_Job *cur_job = NULL;
+
+/**
+ * Records the progress of reading the file.  Called on the worker
+ * thread.
+ */
+static gboolean
+load_progress (double fraction, gpointer user_data)
+{
+  Load_Job *job = (Load_Job *) user_data;
+  g_atomic_int_set (&job->progress, (gint) (fraction * PROGRESS_SCALE));
+  return !g_atomic_int_get (&job->cancel);
+}
+
+static gboolean load_finished (gpointer data);
+
+/**
+ * Reads the project file, and then hands the result over to the
+ * main loop.
+ */
+static gpointer
+load_main (gpointer data)
+{
+  Load_Job *job = (Load_Job *) data;
+  job->error = read_project_into (job->model, job->filename,
+				  &job->error_loc, load_progress, job);
+  job->saved_errno = errno;
+  g_idle_add (load_finished, job);
+  return NULL;
+}
+
+/**
+ * Timer that shows the current progress in the dialog.
+ */
+static gboolean
+update_load_progress (gpointer data)
+{
+  Load_Job *job = (Load_Job *) data;
+  if (job->dialog != NULL)
+    {
+      GtkWidget *progress_bar = lookup_widget (job->dialog, "progress_bar");
+      gtk_progress_bar_set_fraction
+	(GTK_PROGRESS_BAR (progress_bar),
+	 (double) g_atomic_int_get (&job->progress) / PROGRESS_SCALE);
+    }
+  return TRUE;
+}
+
+/** Changes the text above the progress bar.  */
+static void
+set_load_label (Load_Job * job, const gchar * text)
+{
+  if (job->dialog != NULL)
+    gtk_label_set_text (GTK_LABEL (lookup_widget (job->dialog,
+						  "progress_label")), text);
+}
+
+/**
+ * Signal handler for the Cancel button of the progress dialog, and
+ * for closing it.
+ */
+static void
+load_dialog_response (GtkDialog * dialog, gint response_id,
+		      gpointer user_data)
+{
+  Load_Job *job = (Load_Job *) user_data;
+  /* Once the new project is swapped in, there is nothing left to
+     cancel.  */
+  if (job->thread == NULL)
+    return;
+  g_atomic_int_set (&job->cancel, 1);
+  gtk_dialog_set_response_sensitive (dialog, GTK_RESPONSE_CANCEL, FALSE);
+  set_load_label (job, _("Cancelling..."));
+}
+
+/**
+ * Signal handler that keeps the window manager from closing the
+ * progress dialog.
+ *
+ * GtkDialog still turns the request into a response, which cancels
+ * reading.  The dialog itself must stay up until free_load_job(),
+ * since it is modal and keeps the user away from the sets that do not
+ * have their user interface state yet.
+ */
+static gboolean
+load_dialog_delete (GtkWidget * widget, GdkEvent * event,
+		    gpointer user_data)
+{
+  return TRUE;
+}
+
+/**
+ * Frees a job after it is done, along with its dialog.
+ */
+static void
+free_load_job (Load_Job * job)
+{
+  if (job->timeout_source != 0)
+    g_source_remove (job->timeout_source);
+  if (job->dialog != NULL)
+    gtk_widget_destroy (job->dialog);
+  if (job->model != NULL)
+    model_array_free (job->model);
+  g_free (job->filename);
+  g_free (job);
+  if (cur_job == job)
+    cur_job = NULL;
+}
+
+/**
+ * Tells the user why a project file could not be loaded.
+ */
+static void
+show_load_error (Load_Job * job)
+{
+  GtkWidget *dialog;
+
+  if (job->error == CORE_ERROR_IO)
+    {
+      dialog = gtk_message_dialog_new_with_markup
+	(GTK_WINDOW (main_window),
+	 GTK_DIALOG_DESTROY_WITH_PARENT,
+	 GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
+	 _("<b><big>Your file could not be opened.</big></b>\n\n" \
+	   "%s"),
+	 strerror (job->saved_errno));
+    }
+  else if (job->error_loc.line == 0)
+    {
+      dialog = gtk_message_dialog_new_with_markup
+	(GTK_WINDOW (main_window),
+	 GTK_DIALOG_DESTROY_WITH_PARENT,
+	 GTK_MESSAGE_ERROR, GTK_BUTTONS_OK,
+	 _("<b><big>Your file is not a valid project file.</big></b>\n\n" \
+	   "A blank template will be loaded instead."));
+    }
+  else
+    {
+      dialog = gtk_message_dialog_new_with_markup
+	(GTK_WINDOW (main_window),
+	 GTK_DIALOG_DESTROY_WITH_PARENT,
+	 GTK_MESSAGE_ERROR, GTK_BUTTONS_OK,
+	 _("<b><big>A syntax error was found in your file.</big></b>\n\n" \
+	   "The error is on line %u, column %u.  " \
+	   "A blank template will be loaded instead."),
+	 job->error_loc.line, job->error_loc.column);
+    }
+  gtk_window_set_title (GTK_WINDOW (dialog), _("Slider Wave Editor"));
+  gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
+}
+
+/**
+ * Idle handler that creates the user interface state of the sets of
+ * the new project a batch at a time.
+ *
+ * The modal progress dialog stays up meanwhile, and cannot be closed,
+ * so the user cannot reach a set that does not have its state yet.
+ */
+static gboolean
+populate_idle (gpointer data)
+{
+  Load_Job *job = (Load_Job *) data;
+  unsigned end = MIN (job->next_set + POPULATE_BATCH, wv_all_freqs->len);
+
+  create_fund_uis (job->next_set, end);
+  job->next_set = end;
+  if (end < wv_all_freqs->len)
+    {
+      g_atomic_int_set (&job->progress, (gint) ((double) end * PROGRESS_SCALE
+						/ wv_all_freqs->len));
+      return TRUE;
+    }
+  free_load_job (job);
+  return FALSE;
+}
+
+/**
+ * Idle handler that takes over the result of the worker thread on
+ * the main loop.
+ *
+ * On success, the current project is freed and the new one is
+ * swapped in, with the first set selected right away.  If the file
+ * could not be read, a blank template is loaded instead, just like
+ * when loading failed before.  If the user cancelled, the current
+ * project is kept as it is.
+ */
+static gboolean
+load_finished (gpointer data)
+{
+  Load_Job *job = (Load_Job *) data;
+
+  g_thread_join (job->thread);
+  job->thread = NULL;
+
+  if (job->error == CORE_ERROR_CANCELLED)
+    {
+      free_load_job (job);
+      return FALSE;
+    }
+  if (job->error != CORE_OK)
+    {
+      /* The error dialog must not come up behind the modal progress
+	 dialog.  The current project stays in place while the error
+	 dialog runs its own main loop.  */
+      if (job->dialog != NULL)
+	gtk_widget_destroy (job->dialog);
+      show_load_error (job);
+    }
+
+  unselect_fund_freq (g_fund_set);
+  free_wv_editors ();
+  init_wv_editors ();
+  g_free (loaded_fname); loaded_fname = NULL;
+  file_modified = FALSE;
+  autosave_reset ();
+
+  if (job->error != CORE_OK)
+    {
+      new_sliw_project ();
+      select_fund_freq (g_fund_set);
+      wave_view_changed (FALSE);
+      free_load_job (job);
+      return FALSE;
+    }
+
+  model_array_free (model_swap (job->model));
+  job->model = NULL;
+  loaded_fname = job->filename;
+  job->filename = NULL;
+  create_fund_uis (0, 1);
+  select_fund_freq (0);
+  wave_view_changed (FALSE);
+
+  job->next_set = 1;
+  g_atomic_int_set (&job->progress, 0);
+  if (job->dialog != NULL)
+    gtk_dialog_set_response_sensitive (GTK_DIALOG (job->dialog),
+				       GTK_RESPONSE_CANCEL, FALSE);
+  set_load_label (job, _("Preparing editors..."));
+  g_idle_add (populate_idle, job);
+  return FALSE;
+}
+
+/**
+ * Starts loading a project file in the background.
+ *
+ * The current project stays in place until the new one has been read
+ * successfully.
+ * @param filename the name of the file to load
+ */
+void
+project_loader_start (const gchar * filename)
+{
+  Load_Job *job;
+  gchar *display_name;
+  gchar *label_text;
+
+  g_return_if_fail (cur_job == NULL);
+  job = g_new0 (Load_Job, 1);
+  job->filename = g_strdup (filename);
+  job->model = model_array_new ();
+
+  display_name = g_filename_display_basename (filename);
+  label_text = g_strdup_printf (_("Loading %s"), display_name);
+  job->dialog = create_progress_dialog (_("Loading Project"), label_text);
+  g_free (label_text);
+  g_free (display_name);
+  g_signal_connect ((gpointer) job->dialog, "destroy",
+		    G_CALLBACK (gtk_widget_destroyed), &job->dialog);
+  g_signal_connect ((gpointer) job->dialog, "response",
+		    G_CALLBACK (load_dialog_response), job);
+  g_signal_connect ((gpointer) job->dialog, "delete-event",
+		    G_CALLBACK (load_dialog_delete), NULL);
+  gtk_widget_show (job->dialog);
+  job->timeout_source = g_timeout_add (PROGRESS_UPDATE_INTERVAL,
+				       update_load_progress, job);
+
+  cur_job = job;
+  job->thread = g_thread_create (load_main, job, TRUE, NULL);
+}
+
+/**
+ * Stops loading, if a project file is being loaded.  This must be
+ * called after the main loop has quit and before the current project
+ * is freed.
+ */
+void
+project_loader_shutdown (void)
+{
+  Load_Job *job = cur_job;
+  if (job == NULL)
+    return;
+  if (job->thread != NULL)
+    {
+      g_atomic_int_set (&job->cancel, 1);
+      g_thread_join (job->thread);
+      job->thread = NULL;
+    }
+  /* This removes either load_finished() or populate_idle().  */
+  g_idle_remove_by_data (job);
+  free_load_job (job);
+}
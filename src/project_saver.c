@@ -0,0 +1,186 @@
+/* Saving project files in the background.
+
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include "project_saver.h"
+#include "callbacks.h"
+#include "interface.h"
+#include "support.h"
+#include "autosave.h"
+
+typedef struct _Save_Job Save_Job;
+
+/**
+ * State of saving one project file.
+ *
+ * The worker thread owns @a model, @a error, and @a saved_errno until
+ * it has scheduled save_finished().
+ */
+struct _Save_Job
+{
+  gchar *filename;
+  /** The copy of the project that is saved */
+  Wv_Fund_Freq_array *model;
+  Core_Error error;
+  int saved_errno; /**< @c errno right after the file was written */
+  GThread *thread;
+};
+
+/** The project file that is being saved, or NULL if none is.  */
+static Save_Job *cur_save = NULL;
+
+static gboolean save_finished (gpointer data);
+
+/**
+ * Formats and writes the copy of the project, and then hands the
+ * result over to the main loop.
+ */
+static gpointer
+save_main (gpointer data)
+{
+  Save_Job *job = (Save_Job *) data;
+  job->error = write_project_from (job->model, job->filename, TRUE);
+  job->saved_errno = errno;
+  model_array_free (job->model);
+  job->model = NULL;
+  g_idle_add (save_finished, job);
+  return NULL;
+}
+
+/**
+ * Joins the worker thread of the current save and frees it.
+ *
+ * @param report whether to tell the user if saving failed
+ * @return TRUE if the file was saved, FALSE otherwise
+ */
+static gboolean
+finish_save (gboolean report)
+{
+  Save_Job *job = cur_save;
+  gboolean result;
+
+  g_thread_join (job->thread);
+  g_idle_remove_by_data (job);
+  cur_save = NULL;
+  result = (job->error == CORE_OK);
+
+  if (result)
+    autosave_reset ();
+  else
+    {
+      /* The changes were not saved after all.  */
+      file_modified = TRUE;
+      if (report)
+	{
+	  GtkWidget *dialog = gtk_message_dialog_new_with_markup
+	    (GTK_WINDOW (main_window),
+	     GTK_DIALOG_DESTROY_WITH_PARENT,
+	     GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
+	     _("<b><big>An error occurred while saving your " \
+	       "file.</big></b>\n\n%s"),
+	     strerror (job->saved_errno));
+	  gtk_dialog_run (GTK_DIALOG (dialog));
+	  gtk_widget_destroy (dialog);
+	}
+    }
+  g_free (job->filename);
+  g_free (job);
+  return result;
+}
+
+/**
+ * Idle handler that reports the result of the worker thread on the
+ * main loop.
+ */
+static gboolean
+save_finished (gpointer data)
+{
+  if (cur_save == (Save_Job *) data)
+    finish_save (TRUE);
+  return FALSE;
+}
+
+/**
+ * Starts saving the current project in the background.
+ *
+ * The caller should clear ::file_modified, which is set again if
+ * saving fails.  A save that is still running is waited for first,
+ * so saves reach the disk in order, and precision slider motion that
+ * is still pending is applied first.
+ * @param filename the file name to save to.  The binary format is
+ * used if it ends in ::SLIWB_SUFFIX.
+ */
+void
+project_saver_start (const gchar * filename)
+{
+  Save_Job *job;
+
+  project_saver_wait ();
+  precslid_flush ();
+  job = g_new0 (Save_Job, 1);
+  job->filename = g_strdup (filename);
+  job->model = model_copy (wv_all_freqs);
+  cur_save = job;
+  job->thread = g_thread_create (save_main, job, TRUE, NULL);
+}
+
+/**
+ * Waits for the current save to finish, if a file is being saved.
+ * If saving failed, the user is told so.
+ *
+ * @return FALSE if saving failed, TRUE otherwise
+ */
+gboolean
+project_saver_wait (void)
+{
+  if (cur_save == NULL)
+    return TRUE;
+  return finish_save (TRUE);
+}
+
+/**
+ * Waits for the current save to finish without reporting errors.
+ * This must be called after the main loop has quit.
+ */
+void
+project_saver_shutdown (void)
+{
+  if (cur_save != NULL)
+    finish_save (FALSE);
+}
@@ -0,0 +1,285 @@
+/* Oscilloscope view of the audio output.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include "scope_view.h"
+#include "audio.h"
+#include "interface.h"
+#include "support.h"
+#include "wave_view.h"
+#include "wv_editors.h"
+
+/** Number of samples that ::scope_ring can hold.  */
+#define SCOPE_RING_SIZE 16384
+/** Number of past samples kept for finding a trigger point.  */
+#define SCOPE_HISTORY 16384
+/** Milliseconds between updates of the oscilloscope.  */
+#define SCOPE_INTERVAL 33
+/** Fraction of the clipping level that the signal must fall below
+    before a zero crossing may trigger the sweep again.  This keeps
+    noise around zero from causing false triggers.  */
+#define TRIGGER_HYSTERESIS 0.02
+
+/** Ring buffer that carries the audio output to the oscilloscope.  */
+Audio_Ring *scope_ring = NULL;
+
+static GtkWidget *scope_window = NULL;
+static GtkWidget *scope_area = NULL;
+static GdkGC *scope_gc = NULL;
+static guint scope_source = 0;
+/** The most recent samples of audio output, oldest first.  */
+static float *history = NULL;
+
+/**
+ * Creates the ring buffer.  This must be called before the audio
+ * callback can run.
+ */
+void
+scope_view_init (void)
+{
+  scope_ring = audio_ring_new (SCOPE_RING_SIZE);
+  history = g_new0 (float, SCOPE_HISTORY);
+}
+
+/**
+ * Moves all new samples from ::scope_ring to the end of ::history.
+ *
+ * @return TRUE if there were new samples
+ */
+static gboolean
+drain_ring (void)
+{
+  unsigned available = audio_ring_available (scope_ring);
+  if (available == 0)
+    return FALSE;
+  if (available > SCOPE_HISTORY)
+    {
+      audio_ring_read (scope_ring, NULL, available - SCOPE_HISTORY);
+      available = SCOPE_HISTORY;
+    }
+  memmove (history, &history[available],
+	   sizeof (float) * (SCOPE_HISTORY - available));
+  audio_ring_read (scope_ring, &history[SCOPE_HISTORY-available], available);
+  return TRUE;
+}
+
+static gboolean
+scope_timeout (gpointer data)
+{
+  if (drain_ring ())
+    gtk_widget_queue_draw (scope_area);
+  return TRUE;
+}
+
+/**
+ * Finds where the sweep should start.
+ *
+ * The sweep starts at the most recent rising zero crossing that still
+ * leaves a full sweep of samples after it, so that a periodic
+ * waveform is drawn at the same place on every update.
+ * @param span the number of samples in a sweep
+ * @return the index in ::history of the first sample of the sweep
+ */
+static unsigned
+find_trigger (unsigned span)
+{
+  unsigned last = SCOPE_HISTORY - span;
+  unsigned trigger = last;
+  float threshold = -agc_volume * TRIGGER_HYSTERESIS;
+  gboolean armed = FALSE;
+  unsigned i;
+
+  for (i = SCOPE_HISTORY - 2 * span; i <= last; i++)
+    {
+      if (history[i] < threshold)
+	armed = TRUE;
+      else if (armed && history[i] >= 0.0)
+	{
+	  trigger = i;
+	  armed = FALSE;
+	}
+    }
+  return trigger;
+}
+
+static gboolean
+scope_expose (GtkWidget * widget, GdkEventExpose * event, gpointer user_data)
+{
+  gint width = widget->allocation.width;
+  gint height = widget->allocation.height;
+  /* The clipping level maps to the top and bottom edges, so clipping
+     shows up as flat tops.  */
+  float scale = (height / 2 - 1) / (agc_volume * 1.25);
+  float extent = calc_freq_extent ();
+  unsigned span;
+  unsigned start;
+  gint i;
+
+  if (scope_gc == NULL)
+    scope_gc = gdk_gc_new (widget->window);
+  gdk_gc_set_rgb_fg_color (scope_gc, &wr_foreground);
+  if (width <= 0 || height <= 2 || sample_rate == 0 || agc_volume <= 0.0)
+    return TRUE;
+
+  /* Sweep across the same time scale as the waveform display.  */
+  span = (extent > 0.0) ? (unsigned) (sample_rate / extent) : 0;
+  span = CLAMP (span, 16, SCOPE_HISTORY / 2);
+  start = find_trigger (span);
+
+  if (span <= (unsigned) width)
+    {
+      GdkPoint *points = g_new (GdkPoint, span);
+      for (i = 0; i < (gint) span; i++)
+	{
+	  points[i].x = i * (width - 1) / (gint) (span - 1);
+	  points[i].y = height / 2 - (gint) (history[start+i] * scale);
+	}
+      gdk_draw_lines (widget->window, scope_gc, points, span);
+      g_free (points);
+    }
+  else
+    {
+      float *ymins = g_new (float, width);
+      float *ymaxs = g_new (float, width);
+      for (i = 0; i < width; i++)
+	{
+	  /* Each column covers its samples plus the first sample of
+	     the next column, so neighboring columns connect.  */
+	  unsigned first = start + (unsigned) i * span / width;
+	  unsigned end = start + (unsigned) (i + 1) * span / width;
+	  unsigned j;
+	  ymins[i] = history[first];
+	  ymaxs[i] = history[first];
+	  for (j = first + 1; j <= end && j < SCOPE_HISTORY; j++)
+	    {
+	      ymins[i] = MIN (ymins[i], history[j]);
+	      ymaxs[i] = MAX (ymaxs[i], history[j]);
+	    }
+	}
+      wave_view_draw_envelope (widget, scope_gc, ymins, ymaxs, width,
+			       (height / 2) / scale);
+      g_free (ymins);
+      g_free (ymaxs);
+    }
+  return TRUE;
+}
+
+/** Unchecks the menu item when the window is closed, which in turn
+    hides the window.  */
+static gboolean
+scope_delete (GtkWidget * widget, GdkEvent * event, gpointer user_data)
+{
+  GtkUIManager *merge = (GtkUIManager *)
+    g_object_get_data (G_OBJECT (main_window), "ui-manager");
+  GtkAction *action =
+    gtk_ui_manager_get_action (merge, "/MenuBar/ViewMenu/ShowScope");
+  gtk_toggle_action_set_active (GTK_TOGGLE_ACTION (action), FALSE);
+  return TRUE;
+}
+
+static void
+create_scope_window (void)
+{
+  scope_window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_title (GTK_WINDOW (scope_window), _("Oscilloscope"));
+  gtk_window_set_transient_for (GTK_WINDOW (scope_window),
+				GTK_WINDOW (main_window));
+  gtk_window_set_default_size (GTK_WINDOW (scope_window), 400, 200);
+
+  scope_area = gtk_drawing_area_new ();
+  gtk_widget_modify_bg (scope_area, GTK_STATE_NORMAL, &wr_background);
+  gtk_widget_show (scope_area);
+  gtk_container_add (GTK_CONTAINER (scope_window), scope_area);
+
+  g_signal_connect ((gpointer) scope_window, "delete-event",
+		    G_CALLBACK (scope_delete), NULL);
+  g_signal_connect ((gpointer) scope_area, "expose_event",
+		    G_CALLBACK (scope_expose), NULL);
+}
+
+/**
+ * Shows or hides the oscilloscope window.
+ *
+ * The ring is only drained while the window is shown.  Otherwise, it
+ * fills up and the audio callback drops its samples.
+ */
+void
+scope_view_show (gboolean visible)
+{
+  if (visible)
+    {
+      if (scope_window == NULL)
+	create_scope_window ();
+      gtk_widget_show (scope_window);
+      gtk_window_present (GTK_WINDOW (scope_window));
+      if (scope_source == 0)
+	scope_source = g_timeout_add (SCOPE_INTERVAL, scope_timeout, NULL);
+    }
+  else
+    {
+      if (scope_window != NULL)
+	gtk_widget_hide (scope_window);
+      if (scope_source != 0)
+	{
+	  g_source_remove (scope_source);
+	  scope_source = 0;
+	}
+    }
+}
+
+/**
+ * Frees the ring buffer.  This must be called after the audio
+ * callback has been stopped for good.
+ */
+void
+scope_view_shutdown (void)
+{
+  if (scope_source != 0)
+    {
+      g_source_remove (scope_source);
+      scope_source = 0;
+    }
+  if (scope_gc != NULL)
+    {
+      g_object_unref (scope_gc);
+      scope_gc = NULL;
+    }
+  audio_ring_free (scope_ring);
+  scope_ring = NULL;
+  g_free (history);
+  history = NULL;
+}
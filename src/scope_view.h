@@ -0,0 +1,54 @@
+/* Oscilloscope view of the audio output.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Oscilloscope view of the audio output.
+ *
+ * The waveform display shows the waveform as it is synthesized from
+ * the data model, while the audio callback applies automatic gain
+ * control and clipping on its own.  This module shows what was
+ * actually played: the audio callback pushes its final output into
+ * ::scope_ring, and a timer in the user interface drains the ring
+ * and draws a triggered oscilloscope picture of it.
+ */
+
+#ifndef SCOPE_VIEW_H
+#define SCOPE_VIEW_H
+
+#include "audio_ring.h"
+
+extern Audio_Ring *scope_ring;
+
+void scope_view_init (void);
+void scope_view_show (gboolean visible);
+void scope_view_shutdown (void);
+
+#endif /* not SCOPE_VIEW_H */
@@ -0,0 +1,307 @@
+/* Core data model, synthesis, and project files.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Core data model, synthesis, and project files.
+ *
+ * Everything declared here only depends on GLib, so it is built into
+ * a separate library that can be linked without GTK+.  The current
+ * model is the global ::wv_all_freqs, but project files can also be
+ * read into a separate model, even on another thread, and swapped in
+ * afterward.  Errors are reported with ::Core_Error codes rather than
+ * dialogs, and it is up to the caller to show them.
+ * The user interface keeps its own per-set state behind the @a ui
+ * field of each fundamental set; the functions here never touch it.
+ */
+
+#ifndef SLIDERCORE_H
+#define SLIDERCORE_H
+
+#include "gawrapper.h"
+
+typedef struct _Wv_Data Wv_Data;
+typedef struct _Wv_Fund_Freq Wv_Fund_Freq;
+typedef struct _Partial Partial;
+
+/**
+ * Data for a single harmonic.
+ */
+struct _Wv_Data
+{
+  unsigned harmc_num; /**< Harmonic number */
+  float amplitude;
+  unsigned group_idx; /**< Index into the allocated array */
+};
+
+GA_WTYPE(Wv_Data);
+
+/**
+ * Collection of all data for a fundamental frequency set.
+ */
+struct _Wv_Fund_Freq
+{
+  float fund_freq; /**< The fundamental's frequency in Hertz */
+  float amplitude;
+  /**
+   * Current phase position in audio playback.
+   *
+   * Ranges from 0.0 to 1.0, with 0.0 indicated playback is at the
+   * beginning of the fundamental frequency's sine wave and 1.0
+   * indicating playback is at the end of one period respectively.
+   * Phase positions of different fundamentals will get off from their
+   * expected positions when the user changes the frequency of
+   * fundamentals in real time, which is why each fundamental's phase
+   * position must be tracked separately.
+   */
+  float phase_pos;
+  /**
+   * The harmonics of the set, sorted by ascending harmonic number.
+   * No two harmonics have the same number.  Use harmonics_find() or
+   * model_find_harmonic() to look one up by number.
+   */
+  Wv_Data_array *harmonics;
+  /**
+   * State of the user interface for this set, or NULL if the set is
+   * not shown in a user interface.  This must be freed and set to
+   * NULL by its owner before the set is removed.
+   */
+  struct _Wv_Fund_Ui *ui;
+};
+
+GA_WTYPE(Wv_Fund_Freq);
+
+/**
+ * A single sine wave component of the composite waveform.
+ */
+struct _Partial
+{
+  float freq; /**< Frequency in Hertz */
+  float amplitude;
+  /** Fundamental frequency of the set the partial belongs to.  The
+      display renders from this and @a harmc_num rather than from
+      @a freq, so that its samples are computed exactly like those of
+      plot_waveform().  */
+  float fund_freq;
+  unsigned harmc_num; /**< Harmonic number, one for the fundamental */
+};
+
+/**
+ * Shapes of harmonic series that model_generate_harmonics() can
+ * create.
+ *
+ * The amplitude of each harmonic is given relative to the amplitude
+ * of the fundamental, which is harmonic number one.
+ */
+typedef enum _Harmc_Series
+{
+  HARMC_SERIES_SAWTOOTH, /**< Every harmonic at 1/n */
+  HARMC_SERIES_SQUARE, /**< Odd harmonics at 1/n */
+  /** Odd harmonics at 1/n^2, with signs that alternate starting
+      with -1/9 for the third harmonic */
+  HARMC_SERIES_TRIANGLE,
+  HARMC_SERIES_INV_SQUARE, /**< Every harmonic at 1/n^2 */
+  HARMC_SERIES_EXPONENTIAL, /**< Every harmonic at rolloff^(n-1) */
+  HARMC_SERIES_COUNT
+} Harmc_Series;
+
+/**
+ * Sample formats that rendered audio can be written in.  Samples are
+ * always stored in little-endian byte order.
+ */
+typedef enum _Sample_Format
+{
+  SAMPLE_FORMAT_F32, /**< 32-bit float, from -1.0 to 1.0 */
+  SAMPLE_FORMAT_S16, /**< 16-bit signed integer */
+  SAMPLE_FORMAT_S24, /**< 24-bit signed integer, packed in 3 bytes */
+  SAMPLE_FORMAT_COUNT
+} Sample_Format;
+
+/**
+ * Error codes returned by the project file functions.
+ */
+typedef enum _Core_Error
+{
+  CORE_OK = 0,
+  /** The file could not be opened, read, or written.  @c errno
+      tells why.  */
+  CORE_ERROR_IO,
+  CORE_ERROR_SYNTAX, /**< The file is not a valid project file */
+  CORE_ERROR_CANCELLED /**< The progress function asked to stop */
+} Core_Error;
+
+/**
+ * Called from time to time while a project file is read or audio is
+ * rendered to a file.
+ *
+ * This is called on the thread that does the work.
+ * @param fraction how much of the work is done so far, from 0.0 to
+ * 1.0
+ * @param user_data the data that was given to the working function
+ * @return TRUE to keep going, FALSE to stop with
+ * ::CORE_ERROR_CANCELLED
+ */
+typedef gboolean (*Core_Progress_Func) (double fraction, gpointer user_data);
+
+/**
+ * A position within a text file, for reporting syntax errors.  Both
+ * numbers start at one.  A line of zero means that the error has no
+ * position, which is the case for binary project files.
+ */
+typedef struct _Core_Location
+{
+  unsigned line;
+  unsigned column; /**< Counted in bytes */
+} Core_Location;
+
+/** Sample rate that audio is rendered at unless another one is
+    chosen.  */
+#define DEFAULT_SAMPLE_RATE 44100
+
+/** File name extension of binary project files.  */
+#define SLIWB_SUFFIX ".sliwb"
+
+/** Size of the buffer that format_float() needs.  */
+#define FLOAT_STR_SIZE G_ASCII_DTOSTR_BUF_SIZE
+
+/** Maximum number of samples rendered per pixel column in the
+    waveform display.  */
+#define MAX_OVERSAMPLE 64
+/** Rough limit on the number of sine evaluations that may be spent on
+    oversampling a single frame of the waveform display.  */
+#define RENDER_WORK_BUDGET 4000000
+
+extern Wv_Fund_Freq_array *wv_all_freqs;
+extern float max_ypt;
+extern const char *const harmc_series_names[HARMC_SERIES_COUNT];
+extern const char *const sample_format_names[SAMPLE_FORMAT_COUNT];
+
+Wv_Fund_Freq_array *model_array_new (void);
+void model_array_free (Wv_Fund_Freq_array *model);
+Wv_Fund_Freq *model_array_add_fund_freq (Wv_Fund_Freq_array *model);
+Wv_Fund_Freq_array *model_copy (const Wv_Fund_Freq_array *model);
+Wv_Fund_Freq_array *model_swap (Wv_Fund_Freq_array *model);
+unsigned harmonics_insert (Wv_Data_array *harmonics, unsigned harmc_num,
+			   float amplitude);
+Wv_Data *harmonics_find (Wv_Data_array *harmonics, unsigned harmc_num);
+void harmonics_reserve (Wv_Data_array *harmonics, unsigned count);
+void harmonics_sort (Wv_Data_array *harmonics);
+void model_init (void);
+void model_free (void);
+void model_add_fund_freq (void);
+void model_remove_fund_freq (unsigned index);
+void model_add_harmonic (unsigned fund_freq);
+unsigned model_insert_harmonic (unsigned fund_freq, unsigned harmc_num,
+				float amplitude);
+Wv_Data *model_find_harmonic (unsigned fund_freq, unsigned harmc_num);
+void model_remove_harmonic (unsigned fund_freq, unsigned index);
+void model_reserve_harmonics (unsigned fund_freq, unsigned count);
+void model_set_harmonics (unsigned fund_freq, const Wv_Data *harmonics,
+			  unsigned count);
+void model_generate_harmonics (unsigned fund_freq, Harmc_Series series,
+			       unsigned count, float rolloff);
+void model_new_project (void);
+gboolean harmc_series_from_name (const char * name, Harmc_Series * series);
+
+float calc_freq_extent (void);
+void render_waves (float * ypts, unsigned num_samples, float x_max);
+unsigned calc_oversample (unsigned num_cols, float x_max);
+void reduce_columns (const float * ypts, float * ymins, float * ymaxs,
+		     unsigned num_cols, unsigned oversample);
+void render_waves_minmax (float * ymins, float * ymaxs, unsigned num_cols,
+			  float x_max);
+Partial *gather_partials (unsigned * num_partials);
+float render_waves_coarse (float * ypts, unsigned num_samples, float x_max,
+			   Partial * partials, unsigned num_partials,
+			   unsigned max_partials);
+void plot_waveform (float * ypts, unsigned num_samples, float x_max,
+		    unsigned fund_freq_idx, unsigned ofs);
+void plot_waveform_range (float * ypts, unsigned num_samples, float x_max,
+			  unsigned fund_freq_idx, unsigned ofs,
+			  unsigned start, unsigned end);
+
+gboolean sample_format_from_name (const char * name, Sample_Format * format);
+unsigned sample_format_size (Sample_Format format);
+void render_samples (const Wv_Fund_Freq_array * model, float * out,
+		     guint64 first_sample, unsigned num_samples,
+		     unsigned rate);
+void apply_agc (float * samples, unsigned num_samples, float volume,
+		float peak);
+void encode_samples (guint8 * dest, const float * samples,
+		     unsigned num_samples, Sample_Format format);
+Core_Error write_wav_file (const Wv_Fund_Freq_array * model,
+			   const char * filename, unsigned rate,
+			   guint64 num_samples, Sample_Format format,
+			   float volume, float peak,
+			   Core_Progress_Func progress, gpointer user_data);
+Core_Error stream_audio (const Wv_Fund_Freq_array * model, int fd,
+			 unsigned rate, guint64 num_samples,
+			 Sample_Format format, float volume, float peak,
+			 gboolean realtime);
+
+void format_sliw_project (GString * out, const Wv_Fund_Freq_array * model);
+gboolean write_all (int fd, const gchar * contents, gsize length);
+Core_Error write_file_atomic (const char * filename, const gchar * contents,
+			      gsize length, gboolean sync);
+Core_Error write_nyquist_script (const char * filename,
+				 const char * header);
+gchar *format_float (gchar * buffer, float value);
+Core_Error read_sliw_project (Wv_Fund_Freq_array * model,
+			      const char * filename,
+			      Core_Location * error_loc,
+			      Core_Progress_Func progress,
+			      gpointer user_data);
+void format_sliwb_project (GString * out, const Wv_Fund_Freq_array * model);
+Core_Error read_sliwb_project (Wv_Fund_Freq_array * model,
+			       const char * filename,
+			       Core_Progress_Func progress,
+			       gpointer user_data);
+GString *format_project (const Wv_Fund_Freq_array * model,
+			 const char * filename);
+Core_Error write_project_from (const Wv_Fund_Freq_array * model,
+			       const char * filename, gboolean sync);
+Core_Error write_project (const char * filename);
+Core_Error read_project_into (Wv_Fund_Freq_array * model,
+			      const char * filename,
+			      Core_Location * error_loc,
+			      Core_Progress_Func progress,
+			      gpointer user_data);
+Core_Error read_project (const char * filename, Core_Location * error_loc);
+
+guint32 hash_fund_freq (const Wv_Fund_Freq * fund);
+void journal_format_header (GString * out, const char * project_name);
+void journal_format_block (GString * out, const Wv_Fund_Freq_array * model,
+			   const gboolean * changed);
+Core_Error append_file (const char * filename, const gchar * contents,
+			gsize length, gboolean sync);
+Core_Error read_journal (Wv_Fund_Freq_array * model, const char * filename,
+			 gchar ** project_name);
+
+#endif /* not SLIDERCORE_H */
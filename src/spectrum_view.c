@@ -0,0 +1,486 @@
+/* Spectrum analyzer of the audio output.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <math.h>
+
+#include <gtk/gtk.h>
+
+#include "spectrum_view.h"
+#include "audio.h"
+#include "fft.h"
+#include "interface.h"
+#include "support.h"
+#include "wv_editors.h"
+
+/** Number of samples that ::spectrum_ring can hold.  */
+#define SPECTRUM_RING_SIZE 32768
+/** Number of samples in each transform.  */
+#define FFT_SIZE 4096
+/** Number of frequency bins in a spectrum.  */
+#define NUM_BINS (FFT_SIZE / 2 + 1)
+/** Number of new samples needed before the next transform.  */
+#define HOP_SIZE (FFT_SIZE / 2)
+/** Shortest time in seconds between two transforms.  Together with
+    the fixed transform size, this bounds the processor time that the
+    analyzer may take.  */
+#define MIN_ANALYSIS_INTERVAL (1.0 / 30)
+/** Microseconds to sleep while waiting for more samples.  */
+#define POLL_INTERVAL 5000
+/** Lowest frequency shown, in hertz.  */
+#define MIN_FREQ 20.0
+/** Level at the bottom edge of the display, in dB full scale.  */
+#define FLOOR_DB -120.0
+
+/** Ring buffer that carries the audio output to the analyzer.  */
+Audio_Ring *spectrum_ring = NULL;
+
+/* The following variables are only used by the main thread.  */
+
+static GtkWidget *spectrum_window = NULL;
+static GtkWidget *spectrum_area = NULL;
+static GdkGC *spectrum_gc = NULL;
+/** The spectrum that is being displayed, in dB full scale.  */
+static float *front_db = NULL;
+/** Processing time statistics that are being displayed.  */
+static double shown_avg_cost = 0.0;
+static double shown_max_cost = 0.0;
+static unsigned shown_dropped = 0;
+
+/* The following variables are shared with the analyzer thread and
+   protected by ::spectrum_lock.  */
+
+static GMutex *spectrum_lock = NULL;
+/** The newest spectrum that has not been displayed yet.  */
+static float *ready_db = NULL;
+/** The idle source that displays ::ready_db, or zero if there is
+    none.  */
+static guint ready_source = 0;
+/** Moving average of the time taken per transform, in seconds.  */
+static double avg_cost = 0.0;
+/** Longest time taken per transform, in seconds.  */
+static double max_cost = 0.0;
+/** Number of samples dropped by the audio callback.  */
+static unsigned total_dropped = 0;
+
+static GThread *analyzer_thread = NULL;
+/** Set to nonzero to make the analyzer thread exit.  */
+static volatile gint analyzer_quit = 0;
+
+/* The following variables are only used by the analyzer thread.  */
+
+static Fft_Plan *plan = NULL;
+/** The most recent FFT_SIZE samples, oldest first.  */
+static float *frame = NULL;
+static float *window = NULL;
+/** ::frame multiplied by ::window */
+static float *windowed = NULL;
+/** Sum of ::window, for scaling bins to sinusoid amplitudes.  */
+static float window_sum = 0.0;
+static float *bin_re = NULL;
+static float *bin_im = NULL;
+/** The spectrum that is being computed.  */
+static float *back_db = NULL;
+
+static GdkColor partial_color = { 0, 0xffff, 0xffff, 0x0000 };
+static GdkColor alias_color = { 0, 0xffff, 0x2222, 0x2222 };
+static GdkColor clip_color = { 0, 0x8888, 0x8888, 0x8888 };
+
+static gpointer analyzer_main (gpointer data);
+
+/**
+ * Allocates the ring buffer and the transform.  This must be called
+ * before the audio callback can run.
+ */
+void
+spectrum_view_init (void)
+{
+  unsigned i;
+
+  spectrum_ring = audio_ring_new (SPECTRUM_RING_SIZE);
+  spectrum_lock = g_mutex_new ();
+  plan = fft_plan_new (FFT_SIZE);
+  frame = g_new0 (float, FFT_SIZE);
+  window = g_new (float, FFT_SIZE);
+  windowed = g_new (float, FFT_SIZE);
+  bin_re = g_new (float, NUM_BINS);
+  bin_im = g_new (float, NUM_BINS);
+  front_db = g_new (float, NUM_BINS);
+  ready_db = g_new (float, NUM_BINS);
+  back_db = g_new (float, NUM_BINS);
+  for (i = 0; i < NUM_BINS; i++)
+    front_db[i] = FLOOR_DB;
+
+  /* Use a Hann window.  */
+  window_sum = 0.0;
+  for (i = 0; i < FFT_SIZE; i++)
+    {
+      window[i] = (float) (0.5 - 0.5 * cos (2 * G_PI * i / FFT_SIZE));
+      window_sum += window[i];
+    }
+}
+
+/** Computes the spectrum of ::frame into ::back_db.  */
+static void
+analyze_frame (void)
+{
+  unsigned i;
+
+  for (i = 0; i < FFT_SIZE; i++)
+    windowed[i] = frame[i] * window[i];
+  fft_real_forward (plan, windowed, bin_re, bin_im);
+  for (i = 0; i < NUM_BINS; i++)
+    {
+      /* Scale so that a full scale sinusoid reads 0 dB.  */
+      float amplitude = 2 * sqrt (bin_re[i] * bin_re[i] +
+				  bin_im[i] * bin_im[i]) / window_sum;
+      back_db[i] = (amplitude > 0.0) ?
+	MAX (20 * log10 (amplitude), FLOOR_DB) : FLOOR_DB;
+    }
+}
+
+/** Displays the newest spectrum.  Runs on the main thread.  */
+static gboolean
+spectrum_ready (gpointer data)
+{
+  float *db;
+  g_mutex_lock (spectrum_lock);
+  db = front_db;
+  front_db = ready_db;
+  ready_db = db;
+  shown_avg_cost = avg_cost;
+  shown_max_cost = max_cost;
+  shown_dropped = total_dropped;
+  ready_source = 0;
+  g_mutex_unlock (spectrum_lock);
+  if (spectrum_area != NULL)
+    gtk_widget_queue_draw (spectrum_area);
+  return FALSE;
+}
+
+/**
+ * Main loop of the analyzer thread.
+ *
+ * If the analyzer falls behind, it skips the oldest samples in the
+ * ring rather than transforming all of them, so its work per second
+ * is bounded no matter how fast samples arrive.
+ */
+static gpointer
+analyzer_main (gpointer data)
+{
+  GTimer *timer = g_timer_new ();
+
+  /* Samples left over from before the window was shown are stale.  */
+  audio_ring_read (spectrum_ring, NULL, audio_ring_available (spectrum_ring));
+  audio_ring_take_dropped (spectrum_ring);
+
+  while (!g_atomic_int_get (&analyzer_quit))
+    {
+      unsigned available = audio_ring_available (spectrum_ring);
+      unsigned dropped;
+      double cost;
+      float *db;
+
+      if (available < HOP_SIZE)
+	{
+	  g_usleep (POLL_INTERVAL);
+	  continue;
+	}
+      if (available > FFT_SIZE)
+	{
+	  audio_ring_read (spectrum_ring, NULL, available - FFT_SIZE);
+	  available = FFT_SIZE;
+	}
+      memmove (frame, &frame[available],
+	       sizeof (float) * (FFT_SIZE - available));
+      audio_ring_read (spectrum_ring, &frame[FFT_SIZE-available], available);
+      dropped = audio_ring_take_dropped (spectrum_ring);
+
+      g_timer_start (timer);
+      analyze_frame ();
+      cost = g_timer_elapsed (timer, NULL);
+
+      g_mutex_lock (spectrum_lock);
+      db = ready_db;
+      ready_db = back_db;
+      back_db = db;
+      avg_cost = (avg_cost == 0.0) ? cost : avg_cost * 0.9 + cost * 0.1;
+      max_cost = MAX (max_cost, cost);
+      total_dropped += dropped;
+      if (ready_source == 0)
+	ready_source = g_idle_add (spectrum_ready, NULL);
+      g_mutex_unlock (spectrum_lock);
+
+      if (cost < MIN_ANALYSIS_INTERVAL)
+	g_usleep ((gulong) ((MIN_ANALYSIS_INTERVAL - cost) * G_USEC_PER_SEC));
+    }
+
+  g_timer_destroy (timer);
+  return NULL;
+}
+
+/** Maps a frequency to a column of the display.  */
+static gint
+freq_to_x (double freq, gint width, double nyquist)
+{
+  return (gint) (width * log (freq / MIN_FREQ) / log (nyquist / MIN_FREQ));
+}
+
+/** Maps a level in dB full scale to a row of the display.  */
+static gint
+db_to_y (double db, gint height)
+{
+  return (gint) (height * db / FLOOR_DB);
+}
+
+/**
+ * Draws markers at the frequencies of the partials in the data model.
+ *
+ * Partials above the Nyquist frequency are drawn where their aliases
+ * will show up, in a different color.
+ */
+static void
+draw_partials (GtkWidget * widget, gint width, gint height, double nyquist)
+{
+  Partial *partials;
+  unsigned num_partials;
+  unsigned i;
+
+  partials = gather_partials (&num_partials);
+  gdk_gc_set_line_attributes (spectrum_gc, 1, GDK_LINE_ON_OFF_DASH,
+			      GDK_CAP_BUTT, GDK_JOIN_MITER);
+  for (i = 0; i < num_partials; i++)
+    {
+      double freq = partials[i].freq;
+      gint x;
+      if (partials[i].amplitude == 0.0 || freq <= 0.0)
+	continue;
+      if (freq < nyquist)
+	gdk_gc_set_rgb_fg_color (spectrum_gc, &partial_color);
+      else
+	{
+	  freq = fmod (freq, 2 * nyquist);
+	  if (freq > nyquist)
+	    freq = 2 * nyquist - freq;
+	  gdk_gc_set_rgb_fg_color (spectrum_gc, &alias_color);
+	}
+      if (freq < MIN_FREQ)
+	continue;
+      x = freq_to_x (freq, width, nyquist);
+      gdk_draw_line (widget->window, spectrum_gc, x, 0, x, height);
+    }
+  gdk_gc_set_line_attributes (spectrum_gc, 1, GDK_LINE_SOLID,
+			      GDK_CAP_BUTT, GDK_JOIN_MITER);
+  g_free (partials);
+}
+
+static gboolean
+spectrum_expose (GtkWidget * widget, GdkEventExpose * event,
+		 gpointer user_data)
+{
+  gint width = widget->allocation.width;
+  gint height = widget->allocation.height;
+  double nyquist = sample_rate / 2.0;
+  double ratio;
+  GdkSegment *segs;
+  gchar *text;
+  PangoLayout *layout;
+  gint i;
+
+  if (spectrum_gc == NULL)
+    spectrum_gc = gdk_gc_new (widget->window);
+  if (width <= 0 || nyquist <= MIN_FREQ)
+    return TRUE;
+
+  /* Draw one bar per column, as high as the loudest bin that falls
+     within the column.  */
+  gdk_gc_set_rgb_fg_color (spectrum_gc, &wr_foreground);
+  ratio = nyquist / MIN_FREQ;
+  segs = g_new (GdkSegment, width);
+  for (i = 0; i < width; i++)
+    {
+      double lo_freq = MIN_FREQ * pow (ratio, (double) i / width);
+      double hi_freq = MIN_FREQ * pow (ratio, (double) (i + 1) / width);
+      unsigned lo_bin = (unsigned) ceil (lo_freq * FFT_SIZE / sample_rate);
+      unsigned hi_bin = (unsigned) floor (hi_freq * FFT_SIZE / sample_rate);
+      float db;
+      unsigned j;
+      if (lo_bin > hi_bin)
+	lo_bin = hi_bin = (unsigned) floor ((lo_freq + hi_freq) / 2 *
+					    FFT_SIZE / sample_rate + 0.5);
+      hi_bin = MIN (hi_bin, NUM_BINS - 1);
+      lo_bin = MIN (lo_bin, hi_bin);
+      db = front_db[lo_bin];
+      for (j = lo_bin + 1; j <= hi_bin; j++)
+	db = MAX (db, front_db[j]);
+      segs[i].x1 = segs[i].x2 = i;
+      segs[i].y1 = db_to_y (db, height);
+      segs[i].y2 = height;
+    }
+  gdk_draw_segments (widget->window, spectrum_gc, segs, width);
+  g_free (segs);
+
+  draw_partials (widget, width, height, nyquist);
+
+  /* Mark the clipping level of the output.  */
+  if (agc_volume > 0.0)
+    {
+      gint y = db_to_y (20 * log10 (agc_volume * 1.25), height);
+      gdk_gc_set_rgb_fg_color (spectrum_gc, &clip_color);
+      gdk_draw_line (widget->window, spectrum_gc, 0, y, width, y);
+    }
+
+  text = g_strdup_printf (_("FFT %u points: %.0f us average, %.0f us max, "
+			    "%u samples dropped"), FFT_SIZE,
+			  shown_avg_cost * G_USEC_PER_SEC,
+			  shown_max_cost * G_USEC_PER_SEC, shown_dropped);
+  layout = gtk_widget_create_pango_layout (widget, text);
+  gdk_gc_set_rgb_fg_color (spectrum_gc, &clip_color);
+  gdk_draw_layout (widget->window, spectrum_gc, 4, 4, layout);
+  g_object_unref (layout);
+  g_free (text);
+  return TRUE;
+}
+
+/** Unchecks the menu item when the window is closed, which in turn
+    hides the window.  */
+static gboolean
+spectrum_delete (GtkWidget * widget, GdkEvent * event, gpointer user_data)
+{
+  GtkUIManager *merge = (GtkUIManager *)
+    g_object_get_data (G_OBJECT (main_window), "ui-manager");
+  GtkAction *action =
+    gtk_ui_manager_get_action (merge, "/MenuBar/ViewMenu/ShowSpectrum");
+  gtk_toggle_action_set_active (GTK_TOGGLE_ACTION (action), FALSE);
+  return TRUE;
+}
+
+static void
+create_spectrum_window (void)
+{
+  spectrum_window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_title (GTK_WINDOW (spectrum_window),
+			_("Spectrum Analyzer"));
+  gtk_window_set_transient_for (GTK_WINDOW (spectrum_window),
+				GTK_WINDOW (main_window));
+  gtk_window_set_default_size (GTK_WINDOW (spectrum_window), 500, 250);
+
+  spectrum_area = gtk_drawing_area_new ();
+  gtk_widget_modify_bg (spectrum_area, GTK_STATE_NORMAL, &wr_background);
+  gtk_widget_show (spectrum_area);
+  gtk_container_add (GTK_CONTAINER (spectrum_window), spectrum_area);
+
+  g_signal_connect ((gpointer) spectrum_window, "delete-event",
+		    G_CALLBACK (spectrum_delete), NULL);
+  g_signal_connect ((gpointer) spectrum_area, "expose_event",
+		    G_CALLBACK (spectrum_expose), NULL);
+}
+
+/** Stops the analyzer thread if it is running.  */
+static void
+stop_analyzer (void)
+{
+  if (analyzer_thread == NULL)
+    return;
+  g_atomic_int_set (&analyzer_quit, 1);
+  g_thread_join (analyzer_thread);
+  analyzer_thread = NULL;
+}
+
+/**
+ * Shows or hides the spectrum analyzer window.
+ *
+ * The analyzer thread only runs while the window is shown.
+ * Otherwise, the ring fills up and the audio callback drops its
+ * samples.
+ */
+void
+spectrum_view_show (gboolean visible)
+{
+  if (visible)
+    {
+      if (spectrum_window == NULL)
+	create_spectrum_window ();
+      gtk_widget_show (spectrum_window);
+      gtk_window_present (GTK_WINDOW (spectrum_window));
+      if (analyzer_thread == NULL)
+	{
+	  g_mutex_lock (spectrum_lock);
+	  avg_cost = max_cost = 0.0;
+	  total_dropped = 0;
+	  g_mutex_unlock (spectrum_lock);
+	  g_atomic_int_set (&analyzer_quit, 0);
+	  analyzer_thread = g_thread_create (analyzer_main, NULL, TRUE, NULL);
+	}
+    }
+  else
+    {
+      stop_analyzer ();
+      if (spectrum_window != NULL)
+	gtk_widget_hide (spectrum_window);
+    }
+}
+
+/**
+ * Stops the analyzer and frees the ring buffer.  This must be called
+ * after the audio callback has been stopped for good.
+ */
+void
+spectrum_view_shutdown (void)
+{
+  stop_analyzer ();
+  if (ready_source != 0)
+    {
+      g_source_remove (ready_source);
+      ready_source = 0;
+    }
+  if (spectrum_gc != NULL)
+    {
+      g_object_unref (spectrum_gc);
+      spectrum_gc = NULL;
+    }
+  audio_ring_free (spectrum_ring);
+  spectrum_ring = NULL;
+  fft_plan_free (plan);
+  plan = NULL;
+  g_mutex_free (spectrum_lock);
+  g_free (frame);
+  g_free (window);
+  g_free (windowed);
+  g_free (bin_re);
+  g_free (bin_im);
+  g_free (front_db);
+  g_free (ready_db);
+  g_free (back_db);
+}
@@ -0,0 +1,55 @@
+/* Spectrum analyzer of the audio output.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Spectrum analyzer of the audio output.
+ *
+ * The audio callback pushes its final output into ::spectrum_ring.
+ * While the analyzer window is shown, a normal priority thread drains
+ * the ring, computes a windowed FFT of the most recent samples, and
+ * hands the spectrum to the user interface, which draws it against
+ * the partials that the data model is expected to produce.  This
+ * shows aliasing of partials above the Nyquist frequency and the
+ * effect of clipping without an external analyzer.
+ */
+
+#ifndef SPECTRUM_VIEW_H
+#define SPECTRUM_VIEW_H
+
+#include "audio_ring.h"
+
+extern Audio_Ring *spectrum_ring;
+
+void spectrum_view_init (void);
+void spectrum_view_show (gboolean visible);
+void spectrum_view_shutdown (void);
+
+#endif /* not SPECTRUM_VIEW_H */
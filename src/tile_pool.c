@@ -0,0 +1,232 @@
+/* Parallel processing of sample ranges.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <glib.h>
+
+#include "tile_pool.h"
+
+typedef struct _Tile_Batch Tile_Batch;
+
+/**
+ * A set of tiles that is being processed.
+ *
+ * A batch is shared by the calling thread and the pool threads that
+ * were asked to help with it, and it is freed when the last of them
+ * lets go of it.
+ */
+struct _Tile_Batch
+{
+  Tile_Func func;
+  gpointer data;
+  unsigned num_samples;
+  unsigned tile_size;
+  gint num_tiles;
+  volatile gint next_tile; /**< Index of the next tile to hand out */
+  volatile gint tiles_done; /**< Number of finished tiles */
+  volatile gint ref_count;
+  GMutex *lock;
+  GCond *done_cond; /**< Signaled when the last tile is finished */
+};
+
+static GStaticMutex pool_lock = G_STATIC_MUTEX_INIT;
+/** TRUE once creation of the pool has been attempted.  */
+static gboolean pool_init = FALSE;
+/** The pool threads, or NULL if tiles are processed serially.  */
+static GThreadPool *pool = NULL;
+static unsigned num_helpers = 0;
+
+static unsigned
+count_processors (void)
+{
+#if GLIB_CHECK_VERSION (2, 36, 0)
+  return g_get_num_processors ();
+#elif defined (_SC_NPROCESSORS_ONLN)
+  long num_procs = sysconf (_SC_NPROCESSORS_ONLN);
+  return (num_procs > 0) ? (unsigned) num_procs : 1;
+#else
+  return 1;
+#endif
+}
+
+static void
+unref_batch (Tile_Batch * batch)
+{
+  if (g_atomic_int_dec_and_test (&batch->ref_count))
+    {
+      g_cond_free (batch->done_cond);
+      g_mutex_free (batch->lock);
+      g_free (batch);
+    }
+}
+
+/** Processes tiles of @a batch until none are left to hand out.  */
+static void
+run_tiles (Tile_Batch * batch)
+{
+  while (TRUE)
+    {
+      gint tile_idx = g_atomic_int_exchange_and_add (&batch->next_tile, 1);
+      unsigned start;
+      unsigned end;
+      if (tile_idx >= batch->num_tiles)
+	break;
+      start = (unsigned) tile_idx * batch->tile_size;
+      end = MIN (start + batch->tile_size, batch->num_samples);
+      batch->func (start, end, tile_idx, batch->data);
+      if (g_atomic_int_exchange_and_add (&batch->tiles_done, 1) + 1 ==
+	  batch->num_tiles)
+	{
+	  g_mutex_lock (batch->lock);
+	  g_cond_broadcast (batch->done_cond);
+	  g_mutex_unlock (batch->lock);
+	}
+    }
+}
+
+static void
+pool_func (gpointer data, gpointer user_data)
+{
+  Tile_Batch *batch = (Tile_Batch *) data;
+  run_tiles (batch);
+  unref_batch (batch);
+}
+
+/**
+ * Creates the pool threads if that has not been tried yet.
+ *
+ * @return TRUE if the pool threads are available, FALSE if tiles must
+ * be processed serially
+ */
+static gboolean
+ensure_pool (void)
+{
+  g_static_mutex_lock (&pool_lock);
+  if (!pool_init)
+    {
+      pool_init = TRUE;
+      num_helpers = count_processors () - 1;
+      if (num_helpers > 0 && g_thread_supported ())
+	pool = g_thread_pool_new (pool_func, NULL, num_helpers, TRUE, NULL);
+    }
+  g_static_mutex_unlock (&pool_lock);
+  return pool != NULL;
+}
+
+/**
+ * Returns the number of tiles that a range of samples is split into.
+ */
+unsigned
+tile_pool_num_tiles (unsigned num_samples)
+{
+  return (num_samples + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+/**
+ * Processes a range of samples in tiles of #TILE_SIZE samples.
+ *
+ * Tiles are handed out in order to the calling thread and the pool
+ * threads, and this function returns once every tile is finished.
+ * @param num_samples the number of samples in the range
+ * @param func the function that processes each tile
+ * @param data user data to pass to @a func
+ */
+void
+tile_pool_run (unsigned num_samples, Tile_Func func, gpointer data)
+{
+  tile_pool_run_sized (num_samples, TILE_SIZE, func, data);
+}
+
+/**
+ * Processes a range of items in tiles of a given size.
+ *
+ * This is the same as tile_pool_run(), except that the caller picks
+ * the tile size.  A tile size of one hands out items one at a time,
+ * which suits items that each take a lot of work.
+ */
+void
+tile_pool_run_sized (unsigned num_samples, unsigned tile_size,
+		     Tile_Func func, gpointer data)
+{
+  unsigned num_tiles = (num_samples + tile_size - 1) / tile_size;
+  Tile_Batch *batch;
+  unsigned num_pushed;
+  unsigned i;
+
+  if (num_tiles <= 1 || !ensure_pool ())
+    {
+      for (i = 0; i < num_tiles; i++)
+	func (i * tile_size, MIN ((i + 1) * tile_size, num_samples), i, data);
+      return;
+    }
+
+  num_pushed = MIN (num_helpers, num_tiles - 1);
+  batch = g_new (Tile_Batch, 1);
+  batch->func = func;
+  batch->data = data;
+  batch->num_samples = num_samples;
+  batch->tile_size = tile_size;
+  batch->num_tiles = num_tiles;
+  batch->next_tile = 0;
+  batch->tiles_done = 0;
+  batch->ref_count = 1 + num_pushed;
+  batch->lock = g_mutex_new ();
+  batch->done_cond = g_cond_new ();
+  for (i = 0; i < num_pushed; i++)
+    g_thread_pool_push (pool, batch, NULL);
+
+  run_tiles (batch);
+  g_mutex_lock (batch->lock);
+  while (g_atomic_int_get (&batch->tiles_done) < batch->num_tiles)
+    g_cond_wait (batch->done_cond, batch->lock);
+  g_mutex_unlock (batch->lock);
+  unref_batch (batch);
+}
+
+/**
+ * Stops the pool threads.
+ *
+ * No other thread may be calling tile_pool_run() at this time.
+ */
+void
+tile_pool_shutdown (void)
+{
+  if (pool != NULL)
+    g_thread_pool_free (pool, FALSE, TRUE);
+  pool = NULL;
+  pool_init = FALSE;
+}
@@ -0,0 +1,67 @@
+/* Parallel processing of sample ranges.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Parallel processing of sample ranges.
+ *
+ * This module splits a range of samples into tiles and processes the
+ * tiles on a persistent pool of threads.  The calling thread helps
+ * out, so a call always makes progress even if every pool thread is
+ * busy with another caller's tiles.  Tiles never overlap, so a tile
+ * function that computes each sample independently produces the same
+ * results as processing the whole range serially.
+ */
+
+#ifndef TILE_POOL_H
+#define TILE_POOL_H
+
+/** Number of samples in a tile, which keeps a tile of floats within a
+    typical L1 data cache.  */
+#define TILE_SIZE 4096
+
+/**
+ * Function that processes one tile.
+ *
+ * @param start the first sample of the tile
+ * @param end one past the last sample of the tile
+ * @param tile_idx the index of the tile
+ * @param data the user data passed to tile_pool_run()
+ */
+typedef void (*Tile_Func) (unsigned start, unsigned end, unsigned tile_idx,
+			   gpointer data);
+
+unsigned tile_pool_num_tiles (unsigned num_samples);
+void tile_pool_run (unsigned num_samples, Tile_Func func, gpointer data);
+void tile_pool_run_sized (unsigned num_samples, unsigned tile_size,
+			  Tile_Func func, gpointer data);
+void tile_pool_shutdown (void);
+
+#endif /* not TILE_POOL_H */
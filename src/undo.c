@@ -0,0 +1,522 @@
+/* Undo and redo history of the data model.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include "interface.h"
+#include "callbacks.h"
+#include "wv_editors.h"
+#include "wave_view.h"
+#include "undo.h"
+
+/** Number of harmonics in each ::Undo_Chunk.  */
+#define UNDO_CHUNK_HARMCS 1024
+
+typedef struct _Undo_Chunk Undo_Chunk;
+
+/**
+ * A run of up to ::UNDO_CHUNK_HARMCS consecutive harmonics of a
+ * snapshot.
+ *
+ * Chunks are never modified after they are created.  A new snapshot
+ * shares every chunk that is unchanged since the previous snapshot
+ * of the same set, so an edit of one harmonic only stores one new
+ * chunk, however many harmonics the set has.
+ */
+struct _Undo_Chunk
+{
+  unsigned ref_count;
+  unsigned len;
+  Wv_Data *harmcs;
+};
+
+/**
+ * Snapshot of the data of one fundamental set.
+ *
+ * Snapshots are never modified after they are created, so they can
+ * be shared by any number of history entries and fundamental sets.
+ */
+struct _Undo_Snap
+{
+  unsigned ref_count;
+  float fund_freq;
+  float amplitude;
+  unsigned num_harmcs;
+  /** The harmonics, split into chunks of ::UNDO_CHUNK_HARMCS */
+  Undo_Chunk **chunks;
+};
+
+typedef struct _Undo_State Undo_State;
+
+/**
+ * A state of the whole project in the undo or redo history.
+ */
+struct _Undo_State
+{
+  /** One ::Undo_Snap for each fundamental set */
+  GPtrArray *sets;
+  unsigned fund_set; /**< ::g_fund_set at the time */
+};
+
+/** Undo history, with the most recent state at the head.  */
+static GQueue undo_stack = { NULL, NULL, 0 };
+/** Redo history, with the most recently undone state at the
+    head.  */
+static GQueue redo_stack = { NULL, NULL, 0 };
+/** Merge key of the last recorded edit, or NULL if the next edit
+    must not be merged.  */
+static gconstpointer last_merge_key = NULL;
+static unsigned last_merge_set;
+/** Measures the time since the last recorded edit.  */
+static GTimer *merge_timer = NULL;
+/** Nesting count of undo_freeze().  */
+static unsigned freeze_count = 0;
+
+static Undo_Snap *
+undo_snap_ref (Undo_Snap * snap)
+{
+  snap->ref_count++;
+  return snap;
+}
+
+static unsigned
+num_chunks (unsigned num_harmcs)
+{
+  return (num_harmcs + UNDO_CHUNK_HARMCS - 1) / UNDO_CHUNK_HARMCS;
+}
+
+static void
+undo_chunk_unref (Undo_Chunk * chunk)
+{
+  if (--chunk->ref_count > 0)
+    return;
+  g_free (chunk->harmcs);
+  g_slice_free (Undo_Chunk, chunk);
+}
+
+void
+undo_snap_unref (Undo_Snap * snap)
+{
+  unsigned i;
+  if (snap == NULL || --snap->ref_count > 0)
+    return;
+  for (i = 0; i < num_chunks (snap->num_harmcs); i++)
+    undo_chunk_unref (snap->chunks[i]);
+  g_free (snap->chunks);
+  g_slice_free (Undo_Snap, snap);
+}
+
+/**
+ * Checks whether a chunk of a snapshot holds the given harmonics.
+ *
+ * @param snap the snapshot to check, or NULL
+ * @param index the index of the chunk in @a snap
+ * @param harmcs the harmonics to compare with
+ * @param len the number of elements in @a harmcs
+ */
+static gboolean
+chunk_matches (Undo_Snap * snap, unsigned index,
+	       const Wv_Data * harmcs, unsigned len)
+{
+  Undo_Chunk *chunk;
+  if (snap == NULL || index >= num_chunks (snap->num_harmcs))
+    return FALSE;
+  chunk = snap->chunks[index];
+  return (chunk->len == len &&
+	  memcmp (chunk->harmcs, harmcs, sizeof (Wv_Data) * len) == 0);
+}
+
+/**
+ * Checks whether a snapshot holds the current data of a fundamental
+ * set.
+ */
+static gboolean
+snap_matches (Undo_Snap * snap, Wv_Fund_Freq * cur_fund)
+{
+  unsigned num_harmcs = cur_fund->harmonics->len;
+  unsigned i;
+  if (snap->fund_freq != cur_fund->fund_freq ||
+      snap->amplitude != cur_fund->amplitude ||
+      snap->num_harmcs != num_harmcs)
+    return FALSE;
+  for (i = 0; i < num_chunks (num_harmcs); i++)
+    {
+      unsigned start = i * UNDO_CHUNK_HARMCS;
+      if (!chunk_matches (snap, i, &cur_fund->harmonics->d[start],
+			  MIN (num_harmcs - start, UNDO_CHUNK_HARMCS)))
+	return FALSE;
+    }
+  return TRUE;
+}
+
+/**
+ * Gets the snapshot of a fundamental set, creating one if the set was
+ * edited since its last snapshot.
+ *
+ * Creating a snapshot compares every harmonic of the set with the
+ * previous snapshot, so it takes time proportional to the number of
+ * harmonics in the set.  Only the chunks that differ are copied,
+ * though.  An edit that changes one harmonic costs
+ * ::UNDO_CHUNK_HARMCS harmonics of memory, but inserting or removing
+ * a harmonic shifts, and therefore copies, every chunk after it.
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param prev the state to look for an unchanged snapshot in, or
+ * NULL
+ */
+static Undo_Snap *
+get_set_snap (unsigned fund_freq, Undo_State * prev)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  Undo_Snap *prev_snap = NULL;
+  Undo_Snap *snap;
+  unsigned i;
+
+  if (cur_fund->ui->snap != NULL)
+    return cur_fund->ui->snap;
+
+  /* Edits that did not actually change anything, such as leaving an
+     entry without typing, should not use any memory.  */
+  if (prev != NULL && fund_freq < prev->sets->len)
+    {
+      prev_snap = (Undo_Snap *) g_ptr_array_index (prev->sets, fund_freq);
+      if (snap_matches (prev_snap, cur_fund))
+	{
+	  cur_fund->ui->snap = undo_snap_ref (prev_snap);
+	  return prev_snap;
+	}
+    }
+
+  snap = g_slice_new (Undo_Snap);
+  snap->ref_count = 1;
+  snap->fund_freq = cur_fund->fund_freq;
+  snap->amplitude = cur_fund->amplitude;
+  snap->num_harmcs = cur_fund->harmonics->len;
+  snap->chunks = g_new (Undo_Chunk *, num_chunks (snap->num_harmcs));
+  for (i = 0; i < num_chunks (snap->num_harmcs); i++)
+    {
+      unsigned start = i * UNDO_CHUNK_HARMCS;
+      unsigned len = MIN (snap->num_harmcs - start, UNDO_CHUNK_HARMCS);
+      Wv_Data *harmcs = &cur_fund->harmonics->d[start];
+      Undo_Chunk *chunk;
+      if (chunk_matches (prev_snap, i, harmcs, len))
+	{
+	  chunk = prev_snap->chunks[i];
+	  chunk->ref_count++;
+	}
+      else
+	{
+	  chunk = g_slice_new (Undo_Chunk);
+	  chunk->ref_count = 1;
+	  chunk->len = len;
+	  chunk->harmcs = (Wv_Data *) g_memdup (harmcs, sizeof (Wv_Data) * len);
+	}
+      snap->chunks[i] = chunk;
+    }
+  cur_fund->ui->snap = snap;
+  return snap;
+}
+
+/**
+ * Captures the current state of the project.
+ *
+ * @param prev the state to share unchanged snapshots with, or NULL
+ */
+static Undo_State *
+capture_state (Undo_State * prev)
+{
+  Undo_State *state = g_slice_new (Undo_State);
+  unsigned i;
+  state->sets = g_ptr_array_sized_new (wv_all_freqs->len);
+  for (i = 0; i < wv_all_freqs->len; i++)
+    g_ptr_array_add (state->sets, undo_snap_ref (get_set_snap (i, prev)));
+  state->fund_set = g_fund_set;
+  return state;
+}
+
+static void
+free_state (Undo_State * state)
+{
+  unsigned i;
+  for (i = 0; i < state->sets->len; i++)
+    undo_snap_unref ((Undo_Snap *) g_ptr_array_index (state->sets, i));
+  g_ptr_array_free (state->sets, TRUE);
+  g_slice_free (Undo_State, state);
+}
+
+static gboolean
+states_equal (Undo_State * a, Undo_State * b)
+{
+  unsigned i;
+  if (a->sets->len != b->sets->len)
+    return FALSE;
+  for (i = 0; i < a->sets->len; i++)
+    {
+      if (g_ptr_array_index (a->sets, i) != g_ptr_array_index (b->sets, i))
+	return FALSE;
+    }
+  return TRUE;
+}
+
+/**
+ * Pushes a state onto a history, dropping the oldest state if the
+ * history is full.
+ */
+static void
+push_state (GQueue * stack, Undo_State * state)
+{
+  g_queue_push_head (stack, state);
+  if (stack->length > UNDO_LIMIT)
+    free_state ((Undo_State *) g_queue_pop_tail (stack));
+}
+
+static void
+clear_stack (GQueue * stack)
+{
+  while (!g_queue_is_empty (stack))
+    free_state ((Undo_State *) g_queue_pop_head (stack));
+}
+
+/**
+ * Updates the sensitivity of the "Undo" and "Redo" actions.
+ */
+static void
+update_actions (void)
+{
+  if (undo_action != NULL)
+    gtk_action_set_sensitive (undo_action, !g_queue_is_empty (&undo_stack));
+  if (redo_action != NULL)
+    gtk_action_set_sensitive (redo_action, !g_queue_is_empty (&redo_stack));
+}
+
+/**
+ * Records the state of the project before an edit.
+ *
+ * The new history entry shares the snapshots of all fundamental sets
+ * that did not change since the last entry.  Afterward, the edited
+ * set is marked as changed.  Slider motions should pass the slider
+ * as @a merge_key, so that a drag only creates one history entry.
+ * @param fund_freq the fundamental frequency set that is about to be
+ * edited, ::UNDO_ALL_SETS, or ::UNDO_SET_LIST
+ * @param merge_key if not NULL, the edit is merged with the previous
+ * one if it had the same key and set
+ */
+void
+undo_record (unsigned fund_freq, gconstpointer merge_key)
+{
+  gboolean merge;
+  if (freeze_count > 0)
+    return;
+
+  if (merge_timer == NULL)
+    merge_timer = g_timer_new ();
+  merge = (merge_key != NULL && merge_key == last_merge_key &&
+	   fund_freq == last_merge_set &&
+	   g_timer_elapsed (merge_timer, NULL) <= UNDO_MERGE_INTERVAL);
+  last_merge_key = merge_key;
+  last_merge_set = fund_freq;
+  g_timer_start (merge_timer);
+
+  if (!merge)
+    {
+      Undo_State *prev = (Undo_State *) g_queue_peek_head (&undo_stack);
+      Undo_State *state = capture_state (prev);
+      if (prev != NULL && states_equal (state, prev))
+	free_state (state);
+      else
+	push_state (&undo_stack, state);
+      clear_stack (&redo_stack);
+      update_actions ();
+    }
+
+  /* Mark the set as changed.  */
+  if (fund_freq == UNDO_ALL_SETS)
+    {
+      unsigned i;
+      for (i = 0; i < wv_all_freqs->len; i++)
+	{
+	  undo_snap_unref (wv_all_freqs->d[i].ui->snap);
+	  wv_all_freqs->d[i].ui->snap = NULL;
+	}
+    }
+  else if (fund_freq < wv_all_freqs->len)
+    {
+      undo_snap_unref (wv_all_freqs->d[fund_freq].ui->snap);
+      wv_all_freqs->d[fund_freq].ui->snap = NULL;
+    }
+}
+
+/**
+ * Replaces the data model with a state from the history.
+ *
+ * Only the fundamental sets whose snapshots differ from the state are
+ * copied.
+ */
+static void
+restore_state (Undo_State * state)
+{
+  gboolean num_sets_changed = (state->sets->len != wv_all_freqs->len);
+  unsigned i;
+
+  undo_freeze ();
+  unselect_fund_freq (g_fund_set);
+  while (wv_all_freqs->len > state->sets->len)
+    remove_fund_freq (wv_all_freqs->len - 1);
+  while (wv_all_freqs->len < state->sets->len)
+    add_fund_freq ();
+
+  for (i = 0; i < state->sets->len; i++)
+    {
+      Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[i];
+      Undo_Snap *snap = (Undo_Snap *) g_ptr_array_index (state->sets, i);
+      Wv_Data *harmcs;
+      unsigned j;
+      if (cur_fund->ui->snap == snap)
+	continue;
+      cur_fund->fund_freq = snap->fund_freq;
+      cur_fund->amplitude = snap->amplitude;
+      harmcs = g_new (Wv_Data, snap->num_harmcs);
+      for (j = 0; j < num_chunks (snap->num_harmcs); j++)
+	memcpy (&harmcs[j * UNDO_CHUNK_HARMCS], snap->chunks[j]->harmcs,
+		sizeof (Wv_Data) * snap->chunks[j]->len);
+      replace_harmonics (i, harmcs, snap->num_harmcs);
+      g_free (harmcs);
+      undo_snap_unref (cur_fund->ui->snap);
+      cur_fund->ui->snap = undo_snap_ref (snap);
+    }
+
+  g_fund_set = MIN (state->fund_set, wv_all_freqs->len - 1);
+  if (num_sets_changed)
+    fill_fund_set_combo ();
+  else
+    gtk_combo_box_set_active (GTK_COMBO_BOX (cb_fund_set), g_fund_set);
+  select_fund_freq (g_fund_set);
+  undo_thaw ();
+
+  file_modified = TRUE;
+  last_merge_key = NULL;
+  wave_view_changed (FALSE);
+}
+
+/**
+ * Moves one state from one history to the other.
+ *
+ * @param from the history to take the state to restore from
+ * @param to the history to save the current state to
+ */
+static gboolean
+undo_step (GQueue * from, GQueue * to)
+{
+  Undo_State *cur;
+  Undo_State *state;
+
+  cur = capture_state ((Undo_State *) g_queue_peek_head (from));
+  /* Skip entries left behind by edits that did not change
+     anything.  */
+  while ((state = (Undo_State *) g_queue_pop_head (from)) != NULL &&
+	 states_equal (state, cur))
+    free_state (state);
+  if (state == NULL)
+    {
+      free_state (cur);
+      update_actions ();
+      return FALSE;
+    }
+
+  push_state (to, cur);
+  restore_state (state);
+  free_state (state);
+  update_actions ();
+  return TRUE;
+}
+
+/**
+ * Returns the project to the state before the last edit.
+ *
+ * @return TRUE if there was anything to undo
+ */
+gboolean
+undo_undo (void)
+{
+  return undo_step (&undo_stack, &redo_stack);
+}
+
+/**
+ * Reapplies the last edit that was undone.
+ *
+ * @return TRUE if there was anything to redo
+ */
+gboolean
+undo_redo (void)
+{
+  return undo_step (&redo_stack, &undo_stack);
+}
+
+/**
+ * Forgets the undo and redo histories.
+ *
+ * This must be called whenever a different project is loaded.
+ */
+void
+undo_clear (void)
+{
+  clear_stack (&undo_stack);
+  clear_stack (&redo_stack);
+  last_merge_key = NULL;
+  update_actions ();
+}
+
+/**
+ * Stops recording edits until undo_thaw() is called.
+ *
+ * This is used when the user interface changes the data model as a
+ * side effect of showing it, rather than because of an edit.
+ */
+void
+undo_freeze (void)
+{
+  freeze_count++;
+}
+
+/**
+ * Resumes recording edits after undo_freeze().
+ */
+void
+undo_thaw (void)
+{
+  g_return_if_fail (freeze_count > 0);
+  freeze_count--;
+}
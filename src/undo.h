@@ -0,0 +1,77 @@
+/* Undo and redo history of the data model.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Undo and redo history of the data model.
+ *
+ * Each history entry is a complete state of the project, but the
+ * entries are cheap because they are built from shared, reference
+ * counted snapshots of the individual fundamental sets.  A
+ * fundamental set keeps pointing to the snapshot that matches its
+ * data until it is edited, so recording an edit only copies the sets
+ * that were changed since the previous entry.  Within a changed set,
+ * the harmonics are compared with the previous snapshot in chunks,
+ * and only the chunks that differ are copied.  Undoing or redoing
+ * only copies back the sets whose snapshots differ.
+ *
+ * Every edit to the data model must be preceded by a call to
+ * undo_record() while the data is still unchanged.
+ */
+
+#ifndef UNDO_H
+#define UNDO_H
+
+/** Maximum number of entries kept in each of the undo and redo
+    histories.  */
+#define UNDO_LIMIT 100
+/** Consecutive edits with the same merge key are merged into one
+    history entry if they are no further apart than this many
+    seconds.  */
+#define UNDO_MERGE_INTERVAL 1.0
+
+/** Pass to undo_record() for an edit that changes every fundamental
+    set.  */
+#define UNDO_ALL_SETS G_MAXUINT
+/** Pass to undo_record() for an edit that only adds or removes whole
+    fundamental sets.  */
+#define UNDO_SET_LIST (G_MAXUINT - 1)
+
+typedef struct _Undo_Snap Undo_Snap;
+
+void undo_record (unsigned fund_freq, gconstpointer merge_key);
+gboolean undo_undo (void);
+gboolean undo_redo (void);
+void undo_clear (void);
+void undo_freeze (void);
+void undo_thaw (void);
+void undo_snap_unref (Undo_Snap * snap);
+
+#endif /* not UNDO_H */
@@ -0,0 +1,264 @@
+/* Rendering audio files in the background.
+
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include "wav_exporter.h"
+#include "callbacks.h"
+#include "interface.h"
+#include "support.h"
+#include "audio.h"
+
+/** Milliseconds between updates of the progress bar.  */
+#define PROGRESS_UPDATE_INTERVAL 100
+/** The progress is shared between threads as an integer fraction of
+    this.  */
+#define PROGRESS_SCALE 10000
+
+typedef struct _Render_Job Render_Job;
+
+/**
+ * State of rendering one audio file.
+ *
+ * The worker thread owns @a model, @a error, and @a saved_errno until
+ * it has scheduled render_finished().
+ */
+struct _Render_Job
+{
+  gchar *filename;
+  /** The copy of the project that is rendered */
+  Wv_Fund_Freq_array *model;
+  unsigned rate;
+  guint64 num_samples;
+  Sample_Format format;
+  float volume; /**< ::agc_volume when rendering started */
+  float peak; /**< ::max_ypt when rendering started */
+  Core_Error error;
+  int saved_errno; /**< @c errno right after the file was written */
+  /** How much of the work is done, out of ::PROGRESS_SCALE */
+  volatile gint progress;
+  /** Set to nonzero to make the worker thread stop */
+  volatile gint cancel;
+  GThread *thread;
+  /** The progress dialog, or NULL if it was destroyed */
+  GtkWidget *dialog;
+  guint timeout_source;
+};
+
+/** The audio file that is being rendered, or NULL if none is.  */
+static Render_Job *cur_job = NULL;
+
+/**
+ * Records the progress of rendering.  Called on the worker thread.
+ */
+static gboolean
+render_progress (double fraction, gpointer user_data)
+{
+  Render_Job *job = (Render_Job *) user_data;
+  g_atomic_int_set (&job->progress, (gint) (fraction * PROGRESS_SCALE));
+  return !g_atomic_int_get (&job->cancel);
+}
+
+static gboolean render_finished (gpointer data);
+
+/**
+ * Renders the audio file, and then hands the result over to the main
+ * loop.
+ */
+static gpointer
+render_main (gpointer data)
+{
+  Render_Job *job = (Render_Job *) data;
+  job->error = write_wav_file (job->model, job->filename, job->rate,
+			       job->num_samples, job->format,
+			       job->volume, job->peak,
+			       render_progress, job);
+  job->saved_errno = errno;
+  g_idle_add (render_finished, job);
+  return NULL;
+}
+
+/**
+ * Timer that shows the current progress in the dialog.
+ */
+static gboolean
+update_render_progress (gpointer data)
+{
+  Render_Job *job = (Render_Job *) data;
+  if (job->dialog != NULL)
+    {
+      GtkWidget *progress_bar = lookup_widget (job->dialog, "progress_bar");
+      gtk_progress_bar_set_fraction
+	(GTK_PROGRESS_BAR (progress_bar),
+	 (double) g_atomic_int_get (&job->progress) / PROGRESS_SCALE);
+    }
+  return TRUE;
+}
+
+/**
+ * Signal handler for the Cancel button of the progress dialog, and
+ * for closing it.
+ */
+static void
+render_dialog_response (GtkDialog * dialog, gint response_id,
+			gpointer user_data)
+{
+  Render_Job *job = (Render_Job *) user_data;
+  g_atomic_int_set (&job->cancel, 1);
+  gtk_dialog_set_response_sensitive (dialog, GTK_RESPONSE_CANCEL, FALSE);
+  if (job->dialog != NULL)
+    gtk_label_set_text (GTK_LABEL (lookup_widget (job->dialog,
+						  "progress_label")),
+			_("Cancelling..."));
+}
+
+/**
+ * Frees a job after its worker thread was joined, along with its
+ * dialog.
+ */
+static void
+free_render_job (Render_Job * job)
+{
+  if (job->timeout_source != 0)
+    g_source_remove (job->timeout_source);
+  if (job->dialog != NULL)
+    gtk_widget_destroy (job->dialog);
+  model_array_free (job->model);
+  g_free (job->filename);
+  g_free (job);
+  if (cur_job == job)
+    cur_job = NULL;
+}
+
+/**
+ * Idle handler that reports the result of the worker thread on the
+ * main loop.
+ */
+static gboolean
+render_finished (gpointer data)
+{
+  Render_Job *job = (Render_Job *) data;
+  GtkWidget *dialog;
+
+  g_thread_join (job->thread);
+  job->thread = NULL;
+  if (job->error != CORE_ERROR_IO)
+    {
+      free_render_job (job);
+      return FALSE;
+    }
+
+  /* The error dialog must not come up behind the modal progress
+     dialog.  */
+  if (job->dialog != NULL)
+    gtk_widget_destroy (job->dialog);
+  dialog = gtk_message_dialog_new_with_markup
+    (GTK_WINDOW (main_window),
+     GTK_DIALOG_DESTROY_WITH_PARENT,
+     GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
+     _("<b><big>An error occurred while rendering your " \
+       "file.</big></b>\n\n%s"),
+     strerror (job->saved_errno));
+  gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
+  free_render_job (job);
+  return FALSE;
+}
+
+/**
+ * Starts rendering the current project to a WAVE file in the
+ * background.  Precision slider motion that is still pending is
+ * applied first.
+ *
+ * @param filename the name of the file to write
+ * @param rate the sample rate in Hertz
+ * @param num_samples the length of the file in samples
+ * @param format the sample format of the file
+ */
+void
+wav_exporter_start (const gchar * filename, unsigned rate,
+		    guint64 num_samples, Sample_Format format)
+{
+  Render_Job *job;
+  gchar *display_name;
+  gchar *label_text;
+
+  g_return_if_fail (cur_job == NULL);
+  precslid_flush ();
+  job = g_new0 (Render_Job, 1);
+  job->filename = g_strdup (filename);
+  job->model = model_copy (wv_all_freqs);
+  job->rate = rate;
+  job->num_samples = num_samples;
+  job->format = format;
+  job->volume = agc_volume;
+  job->peak = max_ypt;
+
+  display_name = g_filename_display_basename (filename);
+  label_text = g_strdup_printf (_("Rendering %s"), display_name);
+  job->dialog = create_progress_dialog (_("Rendering Audio"), label_text);
+  g_free (label_text);
+  g_free (display_name);
+  g_signal_connect ((gpointer) job->dialog, "destroy",
+		    G_CALLBACK (gtk_widget_destroyed), &job->dialog);
+  g_signal_connect ((gpointer) job->dialog, "response",
+		    G_CALLBACK (render_dialog_response), job);
+  gtk_widget_show (job->dialog);
+  job->timeout_source = g_timeout_add (PROGRESS_UPDATE_INTERVAL,
+				       update_render_progress, job);
+
+  cur_job = job;
+  job->thread = g_thread_create (render_main, job, TRUE, NULL);
+}
+
+/**
+ * Stops rendering, if an audio file is being rendered, and removes
+ * the partly written file.  This must be called after the main loop
+ * has quit.
+ */
+void
+wav_exporter_shutdown (void)
+{
+  Render_Job *job = cur_job;
+  if (job == NULL)
+    return;
+  g_atomic_int_set (&job->cancel, 1);
+  g_thread_join (job->thread);
+  g_idle_remove_by_data (job);
+  free_render_job (job);
+}
@@ -0,0 +1,1641 @@
+/* Composite waveform display.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <math.h>
+
+#include <gtk/gtk.h>
+
+#include "interface.h"
+#include "callbacks.h"
+#include "tile_pool.h"
+#include "wv_editors.h"
+#include "wave_view.h"
+
+
+/** Time in milliseconds that slider input must be idle before the
+    display is refined to full quality.  */
+#define REFINE_DELAY 150
+/** Target time in seconds for rendering one coarse frame.  */
+#define FRAME_BUDGET (1.0 / 60)
+/** Largest column decimation factor used for coarse frames.  */
+#define MAX_LOD_STEP 16
+#define MIN_COARSE_PARTIALS 8
+#define MAX_COARSE_PARTIALS 512
+/** Number of incremental updates after which the cached sums are
+    rebuilt from the curves to keep rounding errors from piling up.  */
+#define RESUM_INTERVAL 256
+/** Largest number of samples that may be held in cached curves.  */
+#define CURVE_CACHE_LIMIT (4 * 1024 * 1024)
+/** Largest number of samples that may be held in layers.  */
+#define LAYER_CACHE_LIMIT (16 * 1024 * 1024)
+/** Largest number of sine evaluations that may be spent on updating
+    the cache for an interactive frame before a coarse frame is drawn
+    instead.  */
+#define INTERACTIVE_WORK (RENDER_WORK_BUDGET / 16)
+/** Number of pixel columns in a cached view tile.  */
+#define VIEW_TILE_COLS 64
+/** Number of view tiles kept in the cache.  */
+#define MAX_VIEW_TILES 1024
+/** Number of view tiles rendered ahead in the direction of panning.  */
+#define PREFETCH_TILES 8
+/** Largest number of zoom steps away from the automatic time
+    scale.  */
+#define MAX_ZOOM_STEPS (16 * ZOOM_STEPS_PER_OCTAVE)
+
+typedef struct _Layer Layer;
+typedef struct _Render_Request Render_Request;
+typedef struct _Frame Frame;
+typedef struct _View_Tile View_Tile;
+
+/**
+ * The cached contribution of a fundamental frequency set to the
+ * composite waveform.
+ */
+struct _Layer
+{
+  unsigned num_partials;
+  /** The fundamental followed by the harmonics that @a ypts was
+      rendered with.  */
+  Partial *partials;
+  /** Unit-amplitude samples of each partial, or NULL if curves are
+      not being cached.  */
+  float **curves;
+  float *ypts; /**< Samples of the set's contribution */
+};
+
+/**
+ * A request for the render thread to draw a frame.
+ *
+ * The request holds a snapshot of everything the render thread needs
+ * to know about ::wv_all_freqs, so the render thread never touches
+ * the live data model.
+ */
+struct _Render_Request
+{
+  /** Value of ::render_version when this request was made */
+  gint version;
+  /** Value of ::model_version when this request was made */
+  gint model_version;
+  gboolean interactive; /**< Use a coarse frame if needed */
+  gboolean overlays; /**< Render the layer of each set */
+  unsigned num_cols;
+  unsigned oversample;
+  float x_max;
+  /** The selected fundamental frequency set, whose overlay is drawn
+      last.  */
+  unsigned fund_set;
+  unsigned num_sets;
+  /** Index into @a partials of the fundamental of each set */
+  unsigned *set_starts;
+  /** Number of partials in each set */
+  unsigned *set_sizes;
+  /** All partials, as returned by gather_partials() */
+  Partial *partials;
+  unsigned num_partials;
+  /** If TRUE, the display shows the zoomed and panned time axis
+      described by the following fields.  Otherwise, it shows the
+      automatic time scale given by @a x_max.  The layer cache always
+      works on the automatic time scale.  */
+  gboolean manual_view;
+  double col_dt; /**< Seconds per column */
+  gint first_col; /**< Column at the left edge, counted from zero */
+  unsigned view_oversample;
+  gint pan_dir; /**< Direction of the last pan: -1, 0, or 1 */
+};
+
+/**
+ * A finished frame of the waveform display.
+ */
+struct _Frame
+{
+  unsigned num_cols;
+  float *ymins; /**< Minimum of each column */
+  float *ymaxs; /**< Maximum of each column */
+  float peak; /**< Displacement that maps to the window edges */
+  /** TRUE if the frame is exact, in which case @a peak is the new
+      value for ::max_ypt.  */
+  gboolean full_quality;
+  /** Number of overlays, which are stored in drawing order */
+  unsigned num_overlays;
+  unsigned *overlay_sets; /**< Set index of each overlay */
+  float *overlay_mins;
+  float *overlay_maxs;
+};
+
+/**
+ * A cached piece of the zoomed and panned waveform display.
+ *
+ * A tile is identified by its position, the time scale, and the
+ * model version it was rendered from, so that panning over a region
+ * that was already rendered just reuses the tiles.
+ */
+struct _View_Tile
+{
+  /** Position on the time axis in units of #VIEW_TILE_COLS columns */
+  gint index;
+  double col_dt;
+  unsigned oversample;
+  gint model_version;
+  /** Number of per-set envelopes, or zero if there are none */
+  unsigned num_sets;
+  gboolean valid; /**< FALSE if the tile has not been rendered */
+  /** Value of ::tile_clock when the tile was last used */
+  guint last_used;
+  float ymins[VIEW_TILE_COLS];
+  float ymaxs[VIEW_TILE_COLS];
+  float *set_mins;
+  float *set_maxs;
+};
+
+/* The following variables are only used by the main thread.  */
+
+/** TRUE while the user is dragging a slider.  */
+static gboolean interacting = FALSE;
+/** Source ID of the pending refine timeout, or zero if none.  */
+static guint refine_source = 0;
+/** TRUE if each layer is drawn as a colored overlay.  */
+static gboolean show_overlays = FALSE;
+/** Graphics context for drawing overlays.  */
+static GdkGC *overlay_gc = NULL;
+/** Number of columns in the most recent request.  */
+static unsigned requested_cols = 0;
+/** The frame that is being displayed.  */
+static Frame *front_frame = NULL;
+/** Incremented whenever the data model changes.  */
+static gint model_version = 0;
+/** TRUE if the user has zoomed or panned the display.  */
+static gboolean manual_view = FALSE;
+/** Seconds per column of the automatic time scale at the moment the
+    user started zooming or panning.  */
+static double base_col_dt = 0.0;
+/** Number of zoom steps in from ::base_col_dt.  */
+static gint zoom_level = 0;
+/** Column at the left edge of the manual view.  */
+static gint view_first_col = 0;
+/** Direction of the last pan: -1, 0, or 1.  */
+static gint pan_dir = 0;
+
+/* The following variables are shared between the main thread and the
+   render thread and are protected by ::render_lock.  */
+
+static GMutex *render_lock = NULL;
+static GCond *render_cond = NULL;
+static GThread *render_thread = NULL;
+static gboolean render_quit = FALSE;
+/** The newest request that has not been picked up yet.  */
+static Render_Request *pending_request = NULL;
+/** The newest finished frame that has not been displayed yet.  */
+static Frame *ready_frame = NULL;
+/** Source ID of the idle handler that displays ::ready_frame.  */
+static guint ready_source = 0;
+
+/**
+ * Incremented for every request, so that the render thread can tell
+ * that the request it is working on is stale.  Only accessed
+ * atomically.
+ */
+static volatile gint render_version = 0;
+
+/* The following variables are only used by the render thread.  */
+
+/** The frame that is being rendered.  */
+static Frame *back_frame = NULL;
+/** Only every @a lod_step pixel column is rendered in coarse
+    frames.  */
+static unsigned lod_step = 2;
+/** Number of partials, strongest first, that are rendered in coarse
+    frames.  */
+static unsigned lod_partials = 64;
+/** One layer for each fundamental frequency set.  */
+static Layer *layers = NULL;
+static unsigned num_layers = 0;
+/** Number of samples in each layer.  */
+static unsigned layer_samples = 0;
+/** x-axis extent that the layers were rendered for.  */
+static float layer_x_max = 0.0;
+/** TRUE if the layers hold per-partial curves.  */
+static gboolean use_curves = FALSE;
+/** Sum of all layers, which is the composite waveform, up to float
+    rounding.  */
+static float *layer_sum = NULL;
+/** Number of incremental updates applied to the layers since they
+    were last rebuilt.  */
+static unsigned num_deltas = 0;
+/** Peak displacement of the waveform at the automatic time scale, as
+    of the last time it was rendered.  */
+static float auto_peak = 0.0;
+/** Cache of view tiles for the manual view.  */
+static View_Tile view_tiles[MAX_VIEW_TILES];
+/** Incremented for every frame of the manual view, for finding the
+    least recently used view tile.  */
+static guint tile_clock = 0;
+
+/** Colors that overlays cycle through.  */
+static GdkColor overlay_colors[] = {
+  { 0, 0xcccc, 0x2222, 0x2222 },
+  { 0, 0x2222, 0x8888, 0x2222 },
+  { 0, 0x2222, 0x4444, 0xcccc },
+  { 0, 0xcccc, 0x8888, 0x0000 },
+  { 0, 0x8888, 0x2222, 0xaaaa },
+  { 0, 0x0000, 0x8888, 0x8888 },
+};
+
+static gpointer render_main (gpointer data);
+static void free_layers (void);
+static void free_view_tiles (void);
+
+static void
+free_request (Render_Request * req)
+{
+  g_free (req->set_starts);
+  g_free (req->set_sizes);
+  g_free (req->partials);
+  g_free (req);
+}
+
+static void
+free_frame (Frame * frame)
+{
+  g_free (frame->ymins);
+  g_free (frame->ymaxs);
+  g_free (frame->overlay_sets);
+  g_free (frame->overlay_mins);
+  g_free (frame->overlay_maxs);
+  g_free (frame);
+}
+
+/**
+ * Makes sure that a frame has room for the given number of columns
+ * and overlays.
+ */
+static void
+reserve_frame (Frame * frame, unsigned num_cols, unsigned num_overlays)
+{
+  frame->ymins = (float *) g_realloc (frame->ymins,
+				      sizeof (float) * num_cols);
+  frame->ymaxs = (float *) g_realloc (frame->ymaxs,
+				      sizeof (float) * num_cols);
+  frame->overlay_sets = (unsigned *)
+    g_realloc (frame->overlay_sets, sizeof (unsigned) * num_overlays);
+  frame->overlay_mins = (float *)
+    g_realloc (frame->overlay_mins, sizeof (float) * num_cols * num_overlays);
+  frame->overlay_maxs = (float *)
+    g_realloc (frame->overlay_maxs, sizeof (float) * num_cols * num_overlays);
+  frame->num_cols = num_cols;
+  frame->num_overlays = 0;
+}
+
+/**
+ * Starts the render thread.
+ *
+ * This function must be called after the GLib thread system has been
+ * initialized and before the waveform display is created.
+ */
+void
+wave_view_init (void)
+{
+  render_lock = g_mutex_new ();
+  render_cond = g_cond_new ();
+  front_frame = g_new0 (Frame, 1);
+  ready_frame = g_new0 (Frame, 1);
+  back_frame = g_new0 (Frame, 1);
+  render_quit = FALSE;
+  render_thread = g_thread_create (render_main, NULL, TRUE, NULL);
+}
+
+/**
+ * Stops the render thread and frees all memory used by the waveform
+ * display.
+ */
+void
+wave_view_shutdown (void)
+{
+  g_mutex_lock (render_lock);
+  render_quit = TRUE;
+  g_cond_signal (render_cond);
+  g_mutex_unlock (render_lock);
+  g_thread_join (render_thread);
+  render_thread = NULL;
+
+  if (refine_source != 0)
+    g_source_remove (refine_source);
+  if (ready_source != 0)
+    g_source_remove (ready_source);
+  refine_source = 0;
+  ready_source = 0;
+  if (pending_request != NULL)
+    free_request (pending_request);
+  pending_request = NULL;
+  free_frame (front_frame);
+  free_frame (ready_frame);
+  free_frame (back_frame);
+  front_frame = ready_frame = back_frame = NULL;
+  free_layers ();
+  free_view_tiles ();
+  g_cond_free (render_cond);
+  g_mutex_free (render_lock);
+  if (overlay_gc != NULL)
+    g_object_unref (overlay_gc);
+  overlay_gc = NULL;
+}
+
+/**
+ * Sends a snapshot of ::wv_all_freqs to the render thread.
+ *
+ * Any request that the render thread has not finished yet becomes
+ * stale and is abandoned.
+ * @param interactive TRUE if a coarse frame may be rendered
+ */
+static void
+post_request (gboolean interactive)
+{
+  Render_Request *req;
+  unsigned start = 0;
+  unsigned i;
+
+  if (wave_render == NULL)
+    return; /* The display does not exist yet.  */
+  req = g_new (Render_Request, 1);
+  req->interactive = interactive;
+  req->overlays = show_overlays;
+  req->num_cols = MAX (wave_render->allocation.width, 1);
+  req->x_max = 1.0 / calc_freq_extent ();
+  req->oversample = calc_oversample (req->num_cols, req->x_max);
+  req->fund_set = g_fund_set;
+  req->num_sets = wv_all_freqs->len;
+  req->set_starts = g_new (unsigned, req->num_sets);
+  req->set_sizes = g_new (unsigned, req->num_sets);
+  for (i = 0; i < req->num_sets; i++)
+    {
+      req->set_starts[i] = start;
+      req->set_sizes[i] = 1 + wv_all_freqs->d[i].harmonics->len;
+      start += req->set_sizes[i];
+    }
+  req->partials = gather_partials (&req->num_partials);
+  req->model_version = model_version;
+  req->manual_view = manual_view;
+  if (manual_view)
+    {
+      req->col_dt = base_col_dt *
+	pow (2.0, -(double) zoom_level / ZOOM_STEPS_PER_OCTAVE);
+      req->first_col = view_first_col;
+      req->view_oversample =
+	calc_oversample (req->num_cols, req->col_dt * req->num_cols);
+      req->pan_dir = pan_dir;
+    }
+  requested_cols = req->num_cols;
+
+  g_mutex_lock (render_lock);
+  g_atomic_int_inc (&render_version);
+  req->version = g_atomic_int_get (&render_version);
+  if (pending_request != NULL)
+    free_request (pending_request);
+  pending_request = req;
+  g_cond_signal (render_cond);
+  g_mutex_unlock (render_lock);
+}
+
+static gboolean
+refine_timeout (gpointer data)
+{
+  refine_source = 0;
+  interacting = FALSE;
+  post_request (FALSE);
+  return FALSE;
+}
+
+/**
+ * Notifies the waveform display that the waveform has changed.
+ *
+ * @param interactive TRUE if the change is part of a continuous
+ * interaction, such as dragging a precision slider.  In that case, a
+ * coarse frame may be drawn and a full quality frame is drawn once the
+ * interaction has been idle for #REFINE_DELAY milliseconds.
+ */
+void
+wave_view_changed (gboolean interactive)
+{
+  if (refine_source != 0)
+    {
+      g_source_remove (refine_source);
+      refine_source = 0;
+    }
+  interacting = interactive;
+  if (interactive)
+    refine_source = g_timeout_add (REFINE_DELAY, refine_timeout, NULL);
+  model_version++;
+  post_request (interactive);
+}
+
+/** Switches from the automatic time scale to the manual view,
+    starting out at the automatic time scale.  */
+static void
+enter_manual_view (void)
+{
+  unsigned num_cols = MAX (wave_render->allocation.width, 1);
+  base_col_dt = 1.0 / calc_freq_extent () / num_cols;
+  zoom_level = 0;
+  view_first_col = 0;
+  manual_view = TRUE;
+}
+
+/**
+ * Zooms the time axis of the waveform display.
+ *
+ * @param steps the number of zoom steps to zoom in, or out if
+ * negative.  #ZOOM_STEPS_PER_OCTAVE steps halve or double the
+ * time scale.
+ * @param x the column that stays fixed in place
+ */
+void
+wave_view_zoom (gint steps, gint x)
+{
+  double col_dt;
+  double anchor;
+
+  if (!manual_view)
+    enter_manual_view ();
+  col_dt = base_col_dt *
+    pow (2.0, -(double) zoom_level / ZOOM_STEPS_PER_OCTAVE);
+  anchor = (view_first_col + x + 1) * col_dt;
+  zoom_level = CLAMP (zoom_level + steps, -MAX_ZOOM_STEPS, MAX_ZOOM_STEPS);
+  col_dt = base_col_dt *
+    pow (2.0, -(double) zoom_level / ZOOM_STEPS_PER_OCTAVE);
+  view_first_col = (gint) floor (anchor / col_dt + 0.5) - x - 1;
+  pan_dir = 0;
+  post_request (interacting);
+}
+
+/**
+ * Pans the time axis of the waveform display.
+ *
+ * @param dx the number of columns to move forward in time, or
+ * backward if negative
+ */
+void
+wave_view_pan (gint dx)
+{
+  if (dx == 0)
+    return;
+  if (!manual_view)
+    enter_manual_view ();
+  view_first_col += dx;
+  pan_dir = (dx > 0) ? 1 : -1;
+  post_request (interacting);
+}
+
+/**
+ * Returns the waveform display to the automatic time scale.
+ */
+void
+wave_view_reset_zoom (void)
+{
+  manual_view = FALSE;
+  zoom_level = 0;
+  view_first_col = 0;
+  pan_dir = 0;
+  post_request (interacting);
+}
+
+/**
+ * Turns the colored overlays of each fundamental frequency set's
+ * contribution on or off.
+ */
+void
+wave_view_set_overlays (gboolean active)
+{
+  show_overlays = active;
+  post_request (interacting);
+}
+
+/**
+ * Displays a frame that the render thread has finished.
+ *
+ * This is an idle handler that runs in the main thread.
+ */
+static gboolean
+frame_ready (gpointer data)
+{
+  Frame *frame;
+  g_mutex_lock (render_lock);
+  frame = front_frame;
+  front_frame = ready_frame;
+  ready_frame = frame;
+  ready_source = 0;
+  g_mutex_unlock (render_lock);
+
+  if (front_frame->full_quality)
+    max_ypt = front_frame->peak;
+  gtk_widget_queue_draw (wave_render);
+  return FALSE;
+}
+
+/** Returns TRUE if a newer request than @a req has been made.  */
+static gboolean
+request_stale (const Render_Request * req)
+{
+  return g_atomic_int_get (&render_version) != req->version;
+}
+
+/**
+ * Adjusts the level of detail of coarse frames.
+ *
+ * Quality is traded away first by dropping weak partials and then by
+ * skipping pixel columns until a coarse frame fits in
+ * #FRAME_BUDGET.  Detail is restored in the opposite order when there
+ * is plenty of time left over.
+ * @param elapsed the time in seconds that the last coarse frame took
+ */
+static void
+adapt_lod (gdouble elapsed)
+{
+  if (elapsed > FRAME_BUDGET)
+    {
+      if (lod_partials > MIN_COARSE_PARTIALS)
+	lod_partials /= 2;
+      else if (lod_step < MAX_LOD_STEP)
+	lod_step *= 2;
+    }
+  else if (elapsed < FRAME_BUDGET / 4)
+    {
+      if (lod_step > 1)
+	lod_step /= 2;
+      else if (lod_partials < MAX_COARSE_PARTIALS)
+	lod_partials *= 2;
+    }
+}
+
+static void
+free_layer (Layer * layer)
+{
+  unsigned k;
+  if (layer->curves != NULL)
+    {
+      for (k = 0; k < layer->num_partials; k++)
+	g_free (layer->curves[k]);
+      g_free (layer->curves);
+    }
+  g_free (layer->partials);
+  g_free (layer->ypts);
+  layer->num_partials = 0;
+  layer->partials = NULL;
+  layer->curves = NULL;
+  layer->ypts = NULL;
+}
+
+static void
+free_layers (void)
+{
+  unsigned i;
+  for (i = 0; i < num_layers; i++)
+    free_layer (&layers[i]);
+  g_free (layers);
+  g_free (layer_sum);
+  layers = NULL;
+  layer_sum = NULL;
+  num_layers = 0;
+  layer_samples = 0;
+}
+
+/**
+ * Renders part of a single partial at unit amplitude.
+ *
+ * Each sample is computed with the same expression, in the same
+ * order, as the corresponding term of plot_waveform() in
+ * render_waves().  Multiplying by a harmonic number of one is exact,
+ * so the fundamental matches too.  Only the samples from @a start up
+ * to but not including @a end are rendered.
+ */
+static void
+render_curve (float * ypts, unsigned num_samples, float x_max,
+	      const Partial * partial, unsigned start, unsigned end)
+{
+  float inv_num_samp = 1.0 / num_samples;
+  float freq_mult = partial->fund_freq * x_max;
+  unsigned harmc_num = partial->harmc_num;
+  unsigned i;
+  for (i = start; i < end; i++)
+    ypts[i] = sinf ((float) (i + 1) * harmc_num * inv_num_samp *
+		    2 * G_PI * freq_mult);
+}
+
+/** Adds part of a single partial to @a ypts, computing each term the
+    same way as render_curve().  */
+static void
+add_partial (float * ypts, unsigned num_samples, float x_max,
+	     const Partial * partial, unsigned start, unsigned end)
+{
+  float inv_num_samp = 1.0 / num_samples;
+  float freq_mult = partial->fund_freq * x_max;
+  unsigned harmc_num = partial->harmc_num;
+  unsigned i;
+  if (partial->amplitude == 0.0)
+    return;
+  for (i = start; i < end; i++)
+    ypts[i] += sinf ((float) (i + 1) * harmc_num * inv_num_samp *
+		     2 * G_PI * freq_mult) * partial->amplitude;
+}
+
+/** Checks whether two partials have different unit-amplitude
+    curves.  */
+static gboolean
+curve_changed (const Partial * a, const Partial * b)
+{
+  return (a->fund_freq != b->fund_freq || a->harmc_num != b->harmc_num);
+}
+
+/** Adds samples @a start up to @a end of @a src scaled by @a scale to
+    @a dest.  */
+static void
+add_scaled_range (float * dest, const float * src, float scale,
+		  unsigned start, unsigned end)
+{
+  unsigned i;
+  if (scale == 0.0)
+    return;
+  for (i = start; i < end; i++)
+    dest[i] += src[i] * scale;
+}
+
+/** Adds @a src scaled by @a scale to @a dest, both of which hold
+    ::layer_samples samples.  */
+static void
+add_scaled (float * dest, const float * src, float scale)
+{
+  add_scaled_range (dest, src, scale, 0, layer_samples);
+}
+
+static void
+clear_samples (float * ypts, unsigned num_samples)
+{
+  unsigned i;
+  for (i = 0; i < num_samples; i++)
+    ypts[i] = 0.0;
+}
+
+/** Shared state for rendering the tiles of a list of partials.  */
+typedef struct _Partials_Job Partials_Job;
+struct _Partials_Job
+{
+  const Render_Request *req;
+  const Partial *partials;
+  unsigned num_partials;
+  unsigned num_samples;
+  float x_max;
+  float *ypts; /**< Sum of the partials */
+  /** If not NULL, the unit-amplitude curve of each partial is stored
+      here as well.  */
+  float **curves;
+  /** Set if a tile found that the request became stale.  */
+  volatile gint stale;
+};
+
+static void
+partials_tile (unsigned start, unsigned end, unsigned tile_idx,
+	       gpointer data)
+{
+  Partials_Job *job = (Partials_Job *) data;
+  unsigned i;
+  unsigned k;
+
+  if (request_stale (job->req))
+    {
+      job->stale = TRUE;
+      return;
+    }
+  for (i = start; i < end; i++)
+    job->ypts[i] = 0.0;
+  for (k = 0; k < job->num_partials; k++)
+    {
+      const Partial *partial = &job->partials[k];
+      if (job->curves != NULL)
+	{
+	  render_curve (job->curves[k], job->num_samples, job->x_max,
+			partial, start, end);
+	  add_scaled_range (job->ypts, job->curves[k], partial->amplitude,
+			    start, end);
+	}
+      else
+	add_partial (job->ypts, job->num_samples, job->x_max, partial,
+		     start, end);
+    }
+}
+
+/**
+ * Sums a list of partials, splitting the samples into tiles that are
+ * rendered in parallel.
+ *
+ * Every sample is computed by the same operations in the same order
+ * no matter how the samples are tiled.  A freshly rendered layer is
+ * therefore bit-identical to plot_waveform() for its set.  The sum of
+ * several layers and layers updated incrementally can still differ
+ * from render_waves() by float rounding, since their terms are added
+ * in a different order.
+ * @return TRUE on success, FALSE if the request became stale
+ */
+static gboolean
+render_partials (Partials_Job * job)
+{
+  job->stale = FALSE;
+  tile_pool_run (job->num_samples, partials_tile, job);
+  return !job->stale && !request_stale (job->req);
+}
+
+/**
+ * Renders the layer of a fundamental frequency set from scratch.
+ *
+ * The previous contents of the layer, if any, are replaced in
+ * ::layer_sum.
+ * @param req the request being rendered
+ * @param fund_freq_idx the fundamental frequency set to render
+ * @return TRUE on success, FALSE if @a req became stale, in which
+ * case the layer is left unchanged
+ */
+static gboolean
+render_layer (const Render_Request * req, unsigned fund_freq_idx)
+{
+  const Partial *partials = &req->partials[req->set_starts[fund_freq_idx]];
+  Layer *layer = &layers[fund_freq_idx];
+  Layer new_layer;
+  Partials_Job job;
+  unsigned k;
+
+  new_layer.num_partials = req->set_sizes[fund_freq_idx];
+  new_layer.partials = (Partial *)
+    g_memdup (partials, sizeof (Partial) * new_layer.num_partials);
+  new_layer.curves = NULL;
+  new_layer.ypts = (float *) g_malloc (sizeof (float) * layer_samples);
+  if (use_curves)
+    {
+      new_layer.curves =
+	(float **) g_malloc (sizeof (float *) * new_layer.num_partials);
+      for (k = 0; k < new_layer.num_partials; k++)
+	new_layer.curves[k] =
+	  (float *) g_malloc (sizeof (float) * layer_samples);
+    }
+
+  job.req = req;
+  job.partials = partials;
+  job.num_partials = new_layer.num_partials;
+  job.num_samples = layer_samples;
+  job.x_max = layer_x_max;
+  job.ypts = new_layer.ypts;
+  job.curves = new_layer.curves;
+  if (!render_partials (&job))
+    {
+      free_layer (&new_layer);
+      return FALSE;
+    }
+
+  if (layer->ypts != NULL)
+    add_scaled (layer_sum, layer->ypts, -1.0);
+  free_layer (layer);
+  *layer = new_layer;
+  add_scaled (layer_sum, layer->ypts, 1.0);
+  num_deltas++;
+  return TRUE;
+}
+
+/**
+ * Estimates how much work it takes to bring a layer up to date.
+ *
+ * @param req the request being rendered
+ * @param fund_freq_idx the fundamental frequency set of the layer
+ * @param dirty location to store whether the layer is out of date
+ * @return the number of sine evaluations needed, which is zero if
+ * only amplitudes of cached curves have changed
+ */
+static gsize
+layer_work (const Render_Request * req, unsigned fund_freq_idx,
+	    gboolean * dirty)
+{
+  const Partial *partials = &req->partials[req->set_starts[fund_freq_idx]];
+  unsigned num_partials = req->set_sizes[fund_freq_idx];
+  Layer *layer = &layers[fund_freq_idx];
+  gsize work = 0;
+  unsigned k;
+
+  *dirty = FALSE;
+  if (num_partials != layer->num_partials)
+    {
+      *dirty = TRUE;
+      return (gsize) num_partials * layer_samples;
+    }
+  for (k = 0; k < num_partials; k++)
+    {
+      if (curve_changed (&partials[k], &layer->partials[k]))
+	{
+	  *dirty = TRUE;
+	  work += layer_samples;
+	}
+      else if (partials[k].amplitude != layer->partials[k].amplitude)
+	*dirty = TRUE;
+    }
+  if (*dirty && !use_curves)
+    return (gsize) num_partials * layer_samples;
+  return work;
+}
+
+/**
+ * Brings a layer up to date with a request.
+ *
+ * Since the composite waveform is linear in each amplitude, a change
+ * in amplitude is applied as a single scaled add of that partial's
+ * cached curve to the layer and to ::layer_sum.  A change in
+ * frequency re-renders only the affected curve.  Without curves, or
+ * when harmonics were added or removed, the whole layer is
+ * re-rendered.
+ * @param req the request being rendered
+ * @param fund_freq_idx the fundamental frequency set of the layer
+ * @return TRUE on success, FALSE if @a req became stale
+ */
+static gboolean
+update_layer (const Render_Request * req, unsigned fund_freq_idx)
+{
+  const Partial *partials = &req->partials[req->set_starts[fund_freq_idx]];
+  Layer *layer = &layers[fund_freq_idx];
+  gboolean dirty;
+  unsigned k;
+
+  layer_work (req, fund_freq_idx, &dirty);
+  if (!dirty)
+    return TRUE;
+  if (!use_curves || layer->num_partials != req->set_sizes[fund_freq_idx])
+    return render_layer (req, fund_freq_idx);
+
+  for (k = 0; k < layer->num_partials; k++)
+    {
+      Partial *cached = &layer->partials[k];
+      if (curve_changed (&partials[k], cached))
+	{
+	  if (request_stale (req))
+	    return FALSE;
+	  add_scaled (layer->ypts, layer->curves[k], -cached->amplitude);
+	  add_scaled (layer_sum, layer->curves[k], -cached->amplitude);
+	  render_curve (layer->curves[k], layer_samples, layer_x_max,
+			&partials[k], 0, layer_samples);
+	  add_scaled (layer->ypts, layer->curves[k], partials[k].amplitude);
+	  add_scaled (layer_sum, layer->curves[k], partials[k].amplitude);
+	}
+      else if (partials[k].amplitude != cached->amplitude)
+	{
+	  float delta = partials[k].amplitude - cached->amplitude;
+	  add_scaled (layer->ypts, layer->curves[k], delta);
+	  add_scaled (layer_sum, layer->curves[k], delta);
+	}
+      else
+	continue;
+      *cached = partials[k];
+      num_deltas++;
+    }
+  return TRUE;
+}
+
+/** Rebuilds every layer and ::layer_sum from the cached curves.  */
+static void
+resum_layers (void)
+{
+  unsigned i;
+  unsigned k;
+  clear_samples (layer_sum, layer_samples);
+  for (i = 0; i < num_layers; i++)
+    {
+      Layer *layer = &layers[i];
+      if (layer->ypts == NULL)
+	continue;
+      if (layer->curves != NULL)
+	{
+	  clear_samples (layer->ypts, layer_samples);
+	  for (k = 0; k < layer->num_partials; k++)
+	    add_scaled (layer->ypts, layer->curves[k],
+			layer->partials[k].amplitude);
+	}
+      add_scaled (layer_sum, layer->ypts, 1.0);
+    }
+  num_deltas = 0;
+}
+
+/**
+ * Brings the layer cache up to date with a request.
+ *
+ * Only the layers of fundamental frequency sets that have changed are
+ * updated.  Changes in the number of sets or in the rendering
+ * geometry rebuild the whole cache.  The cache stays consistent even
+ * if the request becomes stale midway.
+ * @param req the request being rendered
+ * @param max_work the largest number of sine evaluations that may be
+ * spent.  If more are needed, the cache is left untouched.
+ * @return TRUE if ::layer_sum is up to date, FALSE otherwise
+ */
+static gboolean
+update_layers (const Render_Request * req, gsize max_work)
+{
+  unsigned num_samples = req->num_cols * req->oversample;
+  gsize total_samples = (gsize) req->num_partials * num_samples;
+  gboolean want_curves = (total_samples <= CURVE_CACHE_LIMIT);
+  gsize work = 0;
+  unsigned i;
+
+  if ((gsize) req->num_sets * num_samples > LAYER_CACHE_LIMIT)
+    {
+      free_layers ();
+      return FALSE;
+    }
+
+  if (req->num_sets != num_layers || num_samples != layer_samples ||
+      req->x_max != layer_x_max || want_curves != use_curves)
+    {
+      if (total_samples > max_work)
+	return FALSE;
+      /* Empty layers are filled in by update_layer() below.  */
+      free_layers ();
+      layers = (Layer *) g_malloc0 (sizeof (Layer) * MAX (req->num_sets, 1));
+      layer_sum = (float *) g_malloc (sizeof (float) * num_samples);
+      num_layers = req->num_sets;
+      layer_samples = num_samples;
+      layer_x_max = req->x_max;
+      use_curves = want_curves;
+      clear_samples (layer_sum, layer_samples);
+    }
+  else
+    {
+      for (i = 0; i < num_layers; i++)
+	{
+	  gboolean dirty;
+	  work += layer_work (req, i, &dirty);
+	}
+      if (work > max_work)
+	return FALSE;
+    }
+
+  for (i = 0; i < num_layers; i++)
+    {
+      if (!update_layer (req, i))
+	return FALSE;
+    }
+  if (num_deltas >= RESUM_INTERVAL)
+    resum_layers ();
+  return TRUE;
+}
+
+/**
+ * Renders a full quality frame using the layer cache.
+ *
+ * @param req the request being rendered
+ * @param frame the frame to render into
+ * @param max_work see update_layers()
+ * @return TRUE if the frame was rendered, FALSE otherwise
+ */
+static gboolean
+render_cached (const Render_Request * req, Frame * frame, gsize max_work)
+{
+  float peak = 0.0;
+  unsigned i;
+
+  if (!update_layers (req, max_work))
+    return FALSE;
+  for (i = 0; i < layer_samples; i++)
+    peak = MAX (ABS (layer_sum[i]), peak);
+  frame->peak = peak;
+  reduce_columns (layer_sum, frame->ymins, frame->ymaxs, req->num_cols,
+		  req->oversample);
+
+  if (req->overlays)
+    {
+      /* Draw the layer of the selected set last so that it stays on
+	 top.  */
+      for (i = 0; i < num_layers; i++)
+	{
+	  unsigned fund_freq_idx = (req->fund_set + 1 + i) % num_layers;
+	  unsigned ofs = frame->num_overlays * req->num_cols;
+	  reduce_columns (layers[fund_freq_idx].ypts,
+			  &frame->overlay_mins[ofs],
+			  &frame->overlay_maxs[ofs],
+			  req->num_cols, req->oversample);
+	  frame->overlay_sets[frame->num_overlays++] = fund_freq_idx;
+	}
+    }
+  return TRUE;
+}
+
+/**
+ * Renders a full quality frame without the layer cache.
+ *
+ * This is only used if the layer cache would be too large.
+ * @return TRUE on success, FALSE if @a req became stale
+ */
+static gboolean
+render_direct (const Render_Request * req, Frame * frame)
+{
+  unsigned num_samples = req->num_cols * req->oversample;
+  Partials_Job job;
+  float peak = 0.0;
+  unsigned i;
+
+  job.req = req;
+  job.partials = req->partials;
+  job.num_partials = req->num_partials;
+  job.num_samples = num_samples;
+  job.x_max = req->x_max;
+  job.ypts = (float *) g_malloc (sizeof (float) * num_samples);
+  job.curves = NULL;
+  if (!render_partials (&job))
+    {
+      g_free (job.ypts);
+      return FALSE;
+    }
+  for (i = 0; i < num_samples; i++)
+    peak = MAX (ABS (job.ypts[i]), peak);
+  frame->peak = peak;
+  reduce_columns (job.ypts, frame->ymins, frame->ymaxs, req->num_cols,
+		  req->oversample);
+  g_free (job.ypts);
+  return TRUE;
+}
+
+/**
+ * Renders a coarse frame of the composite waveform.
+ *
+ * The frame is scaled like the last full quality frame, which is the
+ * scale that ::max_ypt has as well.  Only if there has not been one
+ * yet is it scaled by its own peak.
+ * @param req the request being rendered.  Its partials are reordered.
+ * @param frame the frame to render into
+ */
+static void
+render_coarse (Render_Request * req, Frame * frame)
+{
+  unsigned num_cols = req->num_cols;
+  unsigned num_samples = (num_cols + lod_step - 1) / lod_step;
+  float *ypts;
+  unsigned i;
+
+  ypts = (float *) g_malloc (sizeof (float) * num_samples);
+  frame->peak = render_waves_coarse (ypts, num_samples, req->x_max,
+				     req->partials, req->num_partials,
+				     lod_partials);
+  /* Keep the vertical scale of the last full quality frame, so that
+     the display does not jump when a drag starts and ends.  The
+     waveform may run off the edges until the drag is over.  */
+  if (auto_peak > 0.0)
+    frame->peak = auto_peak;
+
+  /* Column i lies at (i + 1) / num_cols of the time extent, and
+     coarse sample j lies at (j + 1) / num_samples, so interpolate
+     between the two nearest coarse samples.  */
+  for (i = 0; i < num_cols; i++)
+    {
+      float pos = (float) (i + 1) * num_samples / num_cols - 1;
+      unsigned j;
+      float frac;
+      if (pos <= 0)
+	{
+	  frame->ymins[i] = frame->ymaxs[i] = ypts[0];
+	  continue;
+	}
+      j = (unsigned) pos;
+      frac = pos - j;
+      if (j + 1 >= num_samples)
+	frame->ymins[i] = ypts[num_samples-1];
+      else
+	frame->ymins[i] = ypts[j] + (ypts[j+1] - ypts[j]) * frac;
+      frame->ymaxs[i] = frame->ymins[i];
+    }
+
+  g_free (ypts);
+}
+
+static void
+free_view_tiles (void)
+{
+  unsigned i;
+  for (i = 0; i < MAX_VIEW_TILES; i++)
+    {
+      g_free (view_tiles[i].set_mins);
+      g_free (view_tiles[i].set_maxs);
+      view_tiles[i].set_mins = NULL;
+      view_tiles[i].set_maxs = NULL;
+      view_tiles[i].valid = FALSE;
+      view_tiles[i].last_used = 0;
+    }
+}
+
+/** Divides and rounds toward negative infinity.  */
+static gint
+floor_div (gint a, gint b)
+{
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/** Looks up a view tile in the cache.  */
+static View_Tile *
+find_view_tile (const Render_Request * req, gint index, gboolean with_sets)
+{
+  unsigned i;
+  for (i = 0; i < MAX_VIEW_TILES; i++)
+    {
+      View_Tile *tile = &view_tiles[i];
+      if (tile->valid && tile->index == index &&
+	  tile->col_dt == req->col_dt &&
+	  tile->oversample == req->view_oversample &&
+	  tile->model_version == req->model_version &&
+	  (!with_sets || tile->num_sets == req->num_sets))
+	return tile;
+    }
+  return NULL;
+}
+
+/**
+ * Evicts the least recently used view tile and reuses its slot.
+ *
+ * Tiles used by the current frame are never evicted.
+ * @return the claimed tile, which still has to be rendered, or NULL
+ * if every slot is in use by the current frame
+ */
+static View_Tile *
+claim_view_tile (const Render_Request * req, gint index, gboolean with_sets)
+{
+  View_Tile *victim = NULL;
+  unsigned num_sets = with_sets ? req->num_sets : 0;
+  unsigned i;
+
+  for (i = 0; i < MAX_VIEW_TILES; i++)
+    {
+      View_Tile *tile = &view_tiles[i];
+      if (tile->last_used == tile_clock)
+	continue;
+      if (victim == NULL || !tile->valid ||
+	  (victim->valid && tile->last_used < victim->last_used))
+	victim = tile;
+      if (!victim->valid)
+	break;
+    }
+  if (victim == NULL)
+    return NULL;
+
+  victim->index = index;
+  victim->col_dt = req->col_dt;
+  victim->oversample = req->view_oversample;
+  victim->model_version = req->model_version;
+  victim->valid = FALSE;
+  victim->last_used = tile_clock;
+  if (victim->num_sets != num_sets)
+    {
+      victim->set_mins = (float *) g_realloc
+	(victim->set_mins, sizeof (float) * VIEW_TILE_COLS * num_sets);
+      victim->set_maxs = (float *) g_realloc
+	(victim->set_maxs, sizeof (float) * VIEW_TILE_COLS * num_sets);
+      victim->num_sets = num_sets;
+    }
+  return victim;
+}
+
+/**
+ * Renders a view tile.
+ *
+ * The phase of each sample is computed in double precision from its
+ * absolute position on the time axis, so that tiles far from the
+ * origin line up exactly with their neighbors.
+ */
+static void
+render_view_tile (const Render_Request * req, View_Tile * tile)
+{
+  unsigned oversample = tile->oversample;
+  unsigned num_samples = VIEW_TILE_COLS * oversample;
+  double sample_dt = tile->col_dt / oversample;
+  double first_sample = (double) tile->index * num_samples;
+  float *ypts;
+  float *set_ypts;
+  unsigned s;
+  unsigned k;
+  unsigned j;
+
+  ypts = (float *) g_malloc (sizeof (float) * num_samples);
+  set_ypts = (float *) g_malloc (sizeof (float) * num_samples);
+  clear_samples (ypts, num_samples);
+  for (s = 0; s < req->num_sets; s++)
+    {
+      const Partial *partials = &req->partials[req->set_starts[s]];
+      clear_samples (set_ypts, num_samples);
+      for (k = 0; k < req->set_sizes[s]; k++)
+	{
+	  double omega = 2 * G_PI * partials[k].freq * sample_dt;
+	  float amplitude = partials[k].amplitude;
+	  if (amplitude == 0.0)
+	    continue;
+	  for (j = 0; j < num_samples; j++)
+	    set_ypts[j] += (float) sin ((first_sample + j + 1) * omega) *
+	      amplitude;
+	}
+      if (tile->num_sets > 0)
+	reduce_columns (set_ypts, &tile->set_mins[s*VIEW_TILE_COLS],
+			&tile->set_maxs[s*VIEW_TILE_COLS], VIEW_TILE_COLS,
+			oversample);
+      for (j = 0; j < num_samples; j++)
+	ypts[j] += set_ypts[j];
+    }
+  reduce_columns (ypts, tile->ymins, tile->ymaxs, VIEW_TILE_COLS,
+		  oversample);
+  g_free (ypts);
+  g_free (set_ypts);
+}
+
+/** Shared state for rendering missing view tiles in parallel.  */
+typedef struct _View_Job View_Job;
+struct _View_Job
+{
+  const Render_Request *req;
+  View_Tile **tiles;
+};
+
+static void
+view_tile_func (unsigned start, unsigned end, unsigned tile_idx,
+		gpointer data)
+{
+  View_Job *job = (View_Job *) data;
+  unsigned i;
+  for (i = start; i < end; i++)
+    {
+      if (request_stale (job->req))
+	return;
+      render_view_tile (job->req, job->tiles[i]);
+      job->tiles[i]->valid = TRUE;
+    }
+}
+
+/**
+ * Makes sure that a range of view tiles is in the cache.
+ *
+ * Missing tiles are rendered in parallel, one tile per work item.
+ * @param req the request being rendered
+ * @param first the index of the first tile
+ * @param last the index of the last tile
+ * @param tiles if not NULL, the array that will hold the tiles
+ * @return TRUE if all of the tiles are available, FALSE if @a req
+ * became stale
+ */
+static gboolean
+ensure_view_tiles (const Render_Request * req, gint first, gint last,
+		   View_Tile ** tiles)
+{
+  View_Tile **missing;
+  unsigned num_missing = 0;
+  View_Job job;
+  gboolean success = TRUE;
+  gint index;
+  unsigned i;
+
+  missing = g_new (View_Tile *, last - first + 1);
+  for (index = first; index <= last; index++)
+    {
+      View_Tile *tile = find_view_tile (req, index, req->overlays);
+      if (tile == NULL)
+	{
+	  tile = claim_view_tile (req, index, req->overlays);
+	  if (tile == NULL)
+	    {
+	      success = FALSE;
+	      break;
+	    }
+	  missing[num_missing++] = tile;
+	}
+      tile->last_used = tile_clock;
+      if (tiles != NULL)
+	tiles[index-first] = tile;
+    }
+
+  job.req = req;
+  job.tiles = missing;
+  tile_pool_run_sized (num_missing, 1, view_tile_func, &job);
+  for (i = 0; i < num_missing; i++)
+    {
+      if (!missing[i]->valid)
+	success = FALSE;
+    }
+  g_free (missing);
+  return success;
+}
+
+/**
+ * Renders the tiles ahead of the manual view in the direction that
+ * the user is panning, so that they are ready when they scroll into
+ * view.
+ */
+static void
+prefetch_view_tiles (const Render_Request * req)
+{
+  gint first;
+  gint last;
+  if (!req->manual_view || req->pan_dir == 0)
+    return;
+  if (req->pan_dir > 0)
+    {
+      first = floor_div (req->first_col + (gint) req->num_cols - 1,
+			 VIEW_TILE_COLS) + 1;
+      last = first + PREFETCH_TILES - 1;
+    }
+  else
+    {
+      last = floor_div (req->first_col, VIEW_TILE_COLS) - 1;
+      first = last - PREFETCH_TILES + 1;
+    }
+  ensure_view_tiles (req, first, last, NULL);
+}
+
+/**
+ * Copies one envelope out of a row of view tiles.
+ *
+ * @param mins the array that will hold the minimum of each column
+ * @param maxs the array that will hold the maximum of each column
+ * @param set the set whose envelope to copy, or -1 for the composite
+ */
+static void
+copy_view_envelope (const Render_Request * req, View_Tile ** tiles,
+		    gint first_tile, gint set, float * mins, float * maxs)
+{
+  unsigned i;
+  for (i = 0; i < req->num_cols; i++)
+    {
+      gint col = req->first_col + (gint) i;
+      gint tile_idx = floor_div (col, VIEW_TILE_COLS);
+      View_Tile *tile = tiles[tile_idx-first_tile];
+      unsigned ofs = col - tile_idx * VIEW_TILE_COLS;
+      if (set < 0)
+	{
+	  mins[i] = tile->ymins[ofs];
+	  maxs[i] = tile->ymaxs[ofs];
+	}
+      else
+	{
+	  mins[i] = tile->set_mins[set*VIEW_TILE_COLS+ofs];
+	  maxs[i] = tile->set_maxs[set*VIEW_TILE_COLS+ofs];
+	}
+    }
+}
+
+/**
+ * Renders a frame of the manual view from the view tile cache.
+ *
+ * The vertical scale and ::max_ypt stay tied to the automatic time
+ * scale, so that neither the display height nor the audio level
+ * changes while zooming or panning.  The layer cache is brought up to
+ * date for that purpose.
+ * @return TRUE if the frame is finished, FALSE if @a req became
+ * stale
+ */
+static gboolean
+render_view (const Render_Request * req, Frame * frame)
+{
+  gint first_tile = floor_div (req->first_col, VIEW_TILE_COLS);
+  gint last_tile = floor_div (req->first_col + (gint) req->num_cols - 1,
+			      VIEW_TILE_COLS);
+  View_Tile **tiles;
+  unsigned i;
+
+  frame->full_quality =
+    update_layers (req, req->interactive ? INTERACTIVE_WORK : G_MAXSIZE);
+  if (request_stale (req))
+    return FALSE;
+  if (frame->full_quality)
+    {
+      float peak = 0.0;
+      for (i = 0; i < layer_samples; i++)
+	peak = MAX (ABS (layer_sum[i]), peak);
+      auto_peak = peak;
+    }
+  frame->peak = auto_peak;
+
+  tile_clock++;
+  tiles = g_new (View_Tile *, last_tile - first_tile + 1);
+  if (!ensure_view_tiles (req, first_tile, last_tile, tiles))
+    {
+      g_free (tiles);
+      return FALSE;
+    }
+  copy_view_envelope (req, tiles, first_tile, -1,
+		      frame->ymins, frame->ymaxs);
+  if (req->overlays)
+    {
+      /* Draw the layer of the selected set last so that it stays on
+	 top.  */
+      for (i = 0; i < req->num_sets; i++)
+	{
+	  unsigned fund_freq_idx = (req->fund_set + 1 + i) % req->num_sets;
+	  unsigned ofs = frame->num_overlays * req->num_cols;
+	  copy_view_envelope (req, tiles, first_tile, fund_freq_idx,
+			      &frame->overlay_mins[ofs],
+			      &frame->overlay_maxs[ofs]);
+	  frame->overlay_sets[frame->num_overlays++] = fund_freq_idx;
+	}
+    }
+  g_free (tiles);
+  return !request_stale (req);
+}
+
+/**
+ * Renders a frame for a request.
+ *
+ * @param req the request to render
+ * @param frame the frame to render into
+ * @return TRUE if the frame is finished, FALSE if @a req became
+ * stale
+ */
+static gboolean
+render_frame (Render_Request * req, Frame * frame)
+{
+  reserve_frame (frame, req->num_cols, req->overlays ? req->num_sets : 0);
+  if (req->manual_view)
+    return render_view (req, frame);
+  frame->full_quality = TRUE;
+  if (req->interactive && render_cached (req, frame, INTERACTIVE_WORK))
+    {
+      /* The edit only touched a few partials, which the layer cache
+	 handles exactly in little time.  */
+    }
+  else if (req->interactive)
+    {
+      GTimer *timer;
+      if (request_stale (req))
+	return FALSE;
+      /* Coarse frames don't update ::max_ypt so that the audio level
+	 does not jump around while a slider is dragged.  */
+      timer = g_timer_new ();
+      render_coarse (req, frame);
+      adapt_lod (g_timer_elapsed (timer, NULL));
+      g_timer_destroy (timer);
+      frame->full_quality = FALSE;
+    }
+  else if (!render_cached (req, frame, G_MAXSIZE))
+    {
+      if (request_stale (req) || !render_direct (req, frame))
+	return FALSE;
+    }
+  if (frame->full_quality)
+    auto_peak = frame->peak;
+  return !request_stale (req);
+}
+
+/**
+ * Main function of the render thread.
+ *
+ * The render thread waits for requests, renders them into
+ * ::back_frame, and hands finished frames to the main thread through
+ * ::ready_frame.
+ */
+static gpointer
+render_main (gpointer data)
+{
+  g_mutex_lock (render_lock);
+  while (TRUE)
+    {
+      Render_Request *req;
+      while (pending_request == NULL && !render_quit)
+	g_cond_wait (render_cond, render_lock);
+      if (render_quit)
+	break;
+      req = pending_request;
+      pending_request = NULL;
+      g_mutex_unlock (render_lock);
+
+      if (render_frame (req, back_frame))
+	{
+	  Frame *frame;
+	  g_mutex_lock (render_lock);
+	  frame = ready_frame;
+	  ready_frame = back_frame;
+	  back_frame = frame;
+	  if (ready_source == 0)
+	    ready_source = g_idle_add (frame_ready, NULL);
+	  g_mutex_unlock (render_lock);
+	  prefetch_view_tiles (req);
+	}
+      free_request (req);
+      g_mutex_lock (render_lock);
+    }
+  g_mutex_unlock (render_lock);
+  return NULL;
+}
+
+/**
+ * Draws a per-column envelope, one vertical segment for each pixel
+ * column.
+ *
+ * This is shared by the waveform display and the oscilloscope.
+ * @param widget the drawing area to draw into
+ * @param gc the graphics context to draw with
+ * @param ymins the minimum displacement of each column
+ * @param ymaxs the maximum displacement of each column
+ * @param num_cols the number of columns to draw, starting at x = 0
+ * @param peak the displacement that maps to the top and bottom
+ * edges of the drawing area
+ */
+void
+wave_view_draw_envelope (GtkWidget * widget, GdkGC * gc,
+			 const float * ymins, const float * ymaxs,
+			 unsigned num_cols, float peak)
+{
+  gint win_height = widget->allocation.height;
+  gint last_top, last_bot;
+  GdkSegment *segs;
+  unsigned i;
+
+  /* Accumulate one vertical segment per column and then submit them
+     all in a single request.  Drawing each column with its own
+     gdk_draw_line() call costs one X request per pixel column, which
+     is very slow on wide windows and remote displays.  */
+  segs = (GdkSegment *) g_malloc (sizeof (GdkSegment) * num_cols);
+  last_top = win_height / 2;
+  last_bot = win_height / 2;
+  for (i = 0; i < num_cols; i++)
+    {
+      gint top, bot;
+      top = win_height / 2 - (gint) (ymaxs[i] / peak * win_height / 2);
+      bot = win_height / 2 - (gint) (ymins[i] / peak * win_height / 2);
+      /* Stretch the column's envelope by one pixel toward the previous
+	 column so that the trace stays connected.  */
+      segs[i].y1 = top;
+      segs[i].y2 = bot;
+      if (last_bot < top)
+	segs[i].y1 = last_bot + 1;
+      else if (last_top > bot)
+	segs[i].y2 = last_top - 1;
+      segs[i].x1 = i;
+      segs[i].x2 = i;
+      last_top = top;
+      last_bot = bot;
+    }
+  gdk_draw_segments (widget->window, gc, segs, num_cols);
+  g_free (segs);
+}
+
+/**
+ * Draws the latest finished frame into the waveform display.
+ *
+ * No rendering happens here.  If the frame does not match the
+ * current size of the display, a new frame is requested and the old
+ * one is drawn in the meantime.  This function must only be called
+ * from the "expose_event" signal handler of ::wave_render.
+ */
+void
+wave_view_draw (GtkWidget * widget)
+{
+  Frame *frame = front_frame;
+  unsigned num_cols;
+  float peak;
+  unsigned i;
+
+  if (frame->num_cols != (unsigned) widget->allocation.width &&
+      requested_cols != (unsigned) widget->allocation.width)
+    post_request (interacting);
+  if (frame->num_cols == 0)
+    return; /* Nothing has been rendered yet.  */
+
+  num_cols = MIN (frame->num_cols, (unsigned) widget->allocation.width);
+  peak = frame->peak;
+  if (peak == 0.0)
+    peak = 1.0; /* Silence: draw a flat line.  */
+  if (frame->num_overlays > 0 && overlay_gc == NULL)
+    overlay_gc = gdk_gc_new (widget->window);
+  for (i = 0; i < frame->num_overlays; i++)
+    {
+      unsigned ofs = i * frame->num_cols;
+      gdk_gc_set_rgb_fg_color
+	(overlay_gc, &overlay_colors[frame->overlay_sets[i] %
+				     G_N_ELEMENTS (overlay_colors)]);
+      wave_view_draw_envelope (widget, overlay_gc, &frame->overlay_mins[ofs],
+			       &frame->overlay_maxs[ofs], num_cols, peak);
+    }
+  wave_view_draw_envelope (widget, wr_gc, frame->ymins, frame->ymaxs,
+			   num_cols, peak);
+}
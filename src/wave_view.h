@@ -0,0 +1,75 @@
+/* Composite waveform display.
+
+Copyright (C) 2017 Andrew Makousky
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.  */
+
+/**
+ * @file
+ * Composite waveform display.
+ *
+ * This module decides how the composite waveform is rendered into
+ * ::wave_render.  Rendering happens on a separate thread that works
+ * from a snapshot of ::wv_all_freqs, so the user interface never
+ * waits for synthesis.  Whenever the data model changes, a new
+ * snapshot is sent to the render thread and any frame still in
+ * progress is abandoned.  The main thread only draws the latest
+ * finished frame.
+ *
+ * While the user is dragging a precision slider, a coarse
+ * approximation of the waveform may be rendered within a frame time
+ * budget, and once the input settles the display is refined to full
+ * quality.  Full quality frames are summed from a cache of layers, one
+ * for each fundamental frequency set, so that editing one set only
+ * re-renders that set's layer.  When memory allows, layers also cache
+ * per-partial curves, so that an amplitude change only costs one pass
+ * over the display width.
+ *
+ * The user may also zoom and pan the time axis.  The zoomed display
+ * is assembled from a cache of fixed-width tiles, so that panning
+ * only renders the columns that scroll into view.
+ */
+
+#ifndef WAVE_VIEW_H
+#define WAVE_VIEW_H
+
+/** Number of zoom steps that halve the time scale.  */
+#define ZOOM_STEPS_PER_OCTAVE 4
+
+void wave_view_init (void);
+void wave_view_shutdown (void);
+void wave_view_changed (gboolean interactive);
+void wave_view_set_overlays (gboolean active);
+void wave_view_zoom (gint steps, gint x);
+void wave_view_pan (gint dx);
+void wave_view_reset_zoom (void);
+void wave_view_draw (GtkWidget * widget);
+void wave_view_draw_envelope (GtkWidget * widget, GdkGC * gc,
+			      const float * ymins, const float * ymaxs,
+			      unsigned num_cols, float peak);
+
+#endif /* not WAVE_VIEW_H */
@@ -33,27 +33,20 @@ DAMAGE.  */
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
-#include <math.h>
-#include <locale.h>
 #include <string.h>
+#include <math.h>
 
 #include <gtk/gtk.h>
 
 #include "interface.h"
 #include "callbacks.h"
-#include "file_business.h"
 #include "support.h"
 #include "wv_editors.h"
-
-/**
- * An array of all of the fundamental frequency sets.
- *
- * Inside of each element is one array that references each of the
- * windows for a fundamental frequency and another array that
- * references all harmonics.
- */
-Wv_Fund_Freq_array *wv_all_freqs = NULL;
+#include "editor_strip.h"
+#include "model_pool.h"
+#include "undo.h"
 
 /** Current fundamental set.  */
 unsigned g_fund_set = 0;
@@ -62,6 +55,14 @@ unsigned g_fund_set = 0;
     was initialized or not.  */
 static gboolean combo_init = FALSE;
 
+/** Number of structures to allocate at once in the model pools.  */
+#define MODEL_POOL_BLOCK 64
+
+/** Pool for the ::Wv_Editor_Data of the current project.  */
+static Model_Pool *editor_pool = NULL;
+/** Pool for the ::Slide_Data of the current project.  */
+static Model_Pool *slider_pool = NULL;
+
 /* Even though the original application was planned to have a command
    called '1st Harmonic Drop', it turns out that the original idea is
    only possible if all higher harmonics are also harmonics of each
@@ -78,48 +79,106 @@ static gboolean combo_init = FALSE;
 void
 init_wv_editors (void)
 {
-  wv_all_freqs = (Wv_Fund_Freq_array *)
-    g_array_new (FALSE, FALSE, sizeof (Wv_Fund_Freq));
+  model_init ();
   g_fund_set = 0;
   combo_init = FALSE;
+  editor_pool = model_pool_new (sizeof (Wv_Editor_Data), MODEL_POOL_BLOCK);
+  slider_pool = model_pool_new (sizeof (Slide_Data), MODEL_POOL_BLOCK);
 }
 
 /**
  * Frees ::wv_all_freqs.
  *
  * All dynamically allocated data within ::wv_all_freqs is also freed.
+ * The wave editor windows and precision sliders are not freed one by
+ * one, but rather all at once by destroying their pools.
  */
 void
 free_wv_editors (void)
 {
   unsigned i;
+  /* Dropping the whole model is much faster than removing the entries
+     one by one.  */
   if (cb_fund_set != NULL)
+    gtk_combo_box_set_model (GTK_COMBO_BOX (cb_fund_set), NULL);
+  for (i = 0; i < wv_all_freqs->len; i++)
     {
-      for (i = 0; i < wv_all_freqs->len; i++)
-	gtk_combo_box_remove_text (GTK_COMBO_BOX (cb_fund_set), 0);
+      Wv_Fund_Ui *ui = wv_all_freqs->d[i].ui;
+      /* A project that failed to load may have sets without user
+	 interface state.  */
+      if (ui == NULL)
+	continue;
+      /* The wave editor windows and their slider lists all live in
+	 the pools released below, so only the per-set structures are
+	 freed here.  */
+      g_array_free ((GArray *) ui->wv_editors, TRUE);
+      if (ui->harmc_store != NULL)
+	g_object_unref (ui->harmc_store);
+      undo_snap_unref (ui->snap);
+      g_free (ui->editor_tops);
+      g_slice_free (Wv_Fund_Ui, ui);
+      wv_all_freqs->d[i].ui = NULL;
     }
-  for (i = 0; i < wv_all_freqs->len; i++)
+  model_free ();
+  model_pool_destroy (editor_pool);
+  editor_pool = NULL;
+  model_pool_destroy (slider_pool);
+  slider_pool = NULL;
+  undo_clear ();
+}
+
+/**
+ * Allocates a precision slider's data from the current project's
+ * pool.  The contents of the returned structure are undefined.
+ */
+Slide_Data *
+alloc_slide_data (void)
+{
+  return (Slide_Data *) model_pool_alloc (slider_pool);
+}
+
+/**
+ * Returns a precision slider's data to the current project's pool.
+ */
+void
+free_slide_data (Slide_Data *slider)
+{
+  model_pool_free (slider_pool, slider);
+}
+
+/**
+ * Adds the data of a precision slider to the end of a slider group.
+ *
+ * The new slider starts at the middle of its range, and its base is
+ * chosen so that adding it does not change the value of the group.
+ * No widget is created for it.
+ * @param sliders the slider group to add to, which must have fewer
+ * than ::MAX_PREC_SLIDERS sliders
+ * @param fund_assoc TRUE if the group belongs to the fundamental
+ * frequency editor window
+ * @param parent_index the @a parent_index of the new slider
+ * @return the new slider data
+ */
+Slide_Data *
+append_slide_data (Slide_Data_List *sliders, gboolean fund_assoc,
+		   unsigned parent_index)
+{
+  Slide_Data *sd_block = alloc_slide_data ();
+  sd_block->widget = NULL;
+  sd_block->last_value = 10;
+  sd_block->index = sliders->len;
+  sd_block->fund_assoc = fund_assoc;
+  sd_block->parent_index = parent_index;
+  sd_block->value_mult = pow (100, -((gdouble) sd_block->index));
+  sd_block->base = -10.0 * sd_block->value_mult;
+  if (sd_block->index > 0)
     {
-      unsigned j;
-      g_array_free ((GArray *) wv_all_freqs->d[i].harmonics, TRUE);
-      free_slider_data (wv_all_freqs->d[i].fund_editor.freq_sliders);
-      g_array_free ((GArray *) wv_all_freqs->d[i].fund_editor.freq_sliders,
-		    TRUE);
-      free_slider_data (wv_all_freqs->d[i].fund_editor.amp_sliders);
-      g_array_free ((GArray *) wv_all_freqs->d[i].fund_editor.amp_sliders,
-		    TRUE);
-      for (j = 0; j < wv_all_freqs->d[i].wv_editors->len; j++)
-	{
-	  free_slider_data (wv_all_freqs->d[i].wv_editors->d[j]->amp_sliders);
-	  g_array_free ((GArray *) wv_all_freqs->d[i].
-			wv_editors->d[j]->amp_sliders, TRUE);
-	  g_slice_free1 (sizeof (Wv_Editor_Data),
-			 wv_all_freqs->d[i].wv_editors->d[j]);
-	}
-      g_array_free ((GArray *) wv_all_freqs->d[i].wv_editors, TRUE);
+      Slide_Data *last_slider = sliders->d[sd_block->index-1];
+      sd_block->base += last_slider->base +
+	last_slider->last_value * last_slider->value_mult;
     }
-  g_array_free ((GArray *) wv_all_freqs, TRUE);
-  wv_all_freqs = NULL;
+  sliders->d[sliders->len++] = sd_block;
+  return sd_block;
 }
 
 /**
@@ -129,22 +188,23 @@ free_wv_editors (void)
  * @param sliders the slider data to free
  */
 void
-free_slider_data (Slide_Data_Ptr_array *sliders)
+free_slider_data (Slide_Data_List *sliders)
 {
   unsigned i;
   for (i = 0; i < sliders->len; i++)
     {
-      g_slice_free1 (sizeof (Slide_Data), sliders->d[i]);
+      free_slide_data (sliders->d[i]);
       sliders->d[i] = NULL;
     }
+  sliders->len = 0;
 }
 
 /**
  * Adds a wave editor window.
  *
  * Inserts a wave editor window before the given index, viewing the
- * given data.  The coresponding widgets are not created until
- * create_wvedit_holder() is called.
+ * given data.  The coresponding widgets are not bound until the
+ * editor strip is updated with editor_strip_update().
  * @param fund_freq the fundamental frequency set to work with
  * @param index zero-based index of the wave editor window to insert
  * before
@@ -155,20 +215,22 @@ void
 add_wv_editor (unsigned fund_freq, unsigned index, Wv_Data *last_wv_data)
 {
   Wv_Editor_Data *cur_editor;
-  cur_editor = (Wv_Editor_Data *) g_slice_alloc (sizeof (Wv_Editor_Data));
-  g_array_insert_val ((GArray *) wv_all_freqs->d[fund_freq].wv_editors,
+  cur_editor = (Wv_Editor_Data *) model_pool_alloc (editor_pool);
+  g_array_insert_val ((GArray *) wv_all_freqs->d[fund_freq].ui->wv_editors,
 		      index, cur_editor);
   cur_editor->widget = NULL;
+  cur_editor->view = NULL;
   cur_editor->index = index;
   cur_editor->data = last_wv_data;
   /* Frequency sliders are used only for the fundamental
      frequency.  */
-  cur_editor->freq_sliders = (Slide_Data_Ptr_array *)
-    g_array_new (FALSE, FALSE, sizeof (Slide_Data_Ptr));
-  cur_editor->freq_sliders->len = 0;
-  cur_editor->freq_sliders->d = NULL;
-  cur_editor->amp_sliders = (Slide_Data_Ptr_array *)
-    g_array_new (FALSE, FALSE, sizeof (Slide_Data_Ptr));
+  cur_editor->freq_sliders.len = 0;
+  cur_editor->amp_sliders.len = 0;
+  /* Every window has at least one amplitude slider.  Its data is
+     created here so that binding widgets to the window later does not
+     need to change anything.  */
+  append_slide_data (&cur_editor->amp_sliders, FALSE, index);
+  editor_strip_invalidate (fund_freq);
 
   /* Recalculate all the indexes after the new editor.  */
   {
@@ -177,14 +239,14 @@ add_wv_editor (unsigned fund_freq, unsigned index, Wv_Data *last_wv_data)
       i = index - 1;
     else
       i = 0;
-    for (; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
+    for (; i < wv_all_freqs->d[fund_freq].ui->wv_editors->len; i++)
       {
 	Wv_Editor_Data *cur_editor;
 	unsigned j;
-	cur_editor = wv_all_freqs->d[fund_freq].wv_editors->d[i];
+	cur_editor = wv_all_freqs->d[fund_freq].ui->wv_editors->d[i];
 	cur_editor->index = i;
-	for (j = 0; j < cur_editor->amp_sliders->len; j++)
-	  cur_editor->amp_sliders->d[j]->parent_index = i;
+	for (j = 0; j < cur_editor->amp_sliders.len; j++)
+	  cur_editor->amp_sliders.d[j]->parent_index = i;
       }
   }
 }
@@ -192,8 +254,8 @@ add_wv_editor (unsigned fund_freq, unsigned index, Wv_Data *last_wv_data)
 /**
  * Deletes a wave editor window.
  *
- * Any associated GTK+ widgets will be destroyed when the wave editor
- * window is removed.
+ * If the wave editor window is bound to widgets in the editor strip,
+ * the widgets are returned to the editor strip for reuse.
  * @param fund_freq the fundamental frequency set to work with
  * @param index the index of the wave editor window to remove
  */
@@ -201,16 +263,15 @@ void
 remove_wv_editor (unsigned fund_freq, unsigned index)
 {
   Wv_Editor_Data *cur_editor;
-  cur_editor = wv_all_freqs->d[fund_freq].wv_editors->d[index];
-  free_slider_data (cur_editor->freq_sliders);
-  g_array_free ((GArray *) cur_editor->freq_sliders, TRUE);
-  free_slider_data (cur_editor->amp_sliders);
-  g_array_free ((GArray *) cur_editor->amp_sliders, TRUE);
-  if (cur_editor->widget != NULL)
-    gtk_widget_destroy (cur_editor->widget);
-  g_slice_free1 (sizeof (Wv_Editor_Data), cur_editor);
-  g_array_remove_index ((GArray *) wv_all_freqs->d[fund_freq].wv_editors,
+  cur_editor = wv_all_freqs->d[fund_freq].ui->wv_editors->d[index];
+  if (cur_editor->view != NULL)
+    editor_strip_release (cur_editor);
+  free_slider_data (&cur_editor->freq_sliders);
+  free_slider_data (&cur_editor->amp_sliders);
+  model_pool_free (editor_pool, cur_editor);
+  g_array_remove_index ((GArray *) wv_all_freqs->d[fund_freq].ui->wv_editors,
 			index);
+  editor_strip_invalidate (fund_freq);
 
   /* Recalculate all the indexes after the deleted editor.  */
   {
@@ -219,18 +280,41 @@ remove_wv_editor (unsigned fund_freq, unsigned index)
       i = index - 1;
     else
       i = 0;
-    for (; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
+    for (; i < wv_all_freqs->d[fund_freq].ui->wv_editors->len; i++)
       {
 	Wv_Editor_Data *cur_editor;
 	unsigned j;
-	cur_editor = wv_all_freqs->d[fund_freq].wv_editors->d[i];
+	cur_editor = wv_all_freqs->d[fund_freq].ui->wv_editors->d[i];
 	cur_editor->index = i;
-	for (j = 0; j < cur_editor->amp_sliders->len; j++)
-	  cur_editor->amp_sliders->d[j]->parent_index = i;
+	for (j = 0; j < cur_editor->amp_sliders.len; j++)
+	  cur_editor->amp_sliders.d[j]->parent_index = i;
       }
   }
 }
 
+/**
+ * Records which harmonic each wave editor window of a fundamental
+ * frequency set is viewing.
+ *
+ * Changing the harmonic array can move it, so the windows' harmonic
+ * pointers must be rebuilt from these indices afterward.
+ * @param fund_freq the fundamental frequency set to work with
+ * @return the harmonic index of each window, which must be freed with
+ * g_free()
+ */
+static guint *
+get_editor_indices (unsigned fund_freq)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  Wv_Editor_Data_Ptr_array *editors = cur_fund->ui->wv_editors;
+  guint *indices = g_new (guint, MAX (editors->len, 1));
+  unsigned i;
+
+  for (i = 0; i < editors->len; i++)
+    indices[i] = editors->d[i]->data - cur_fund->harmonics->d;
+  return indices;
+}
+
 /**
  * Adds a harmonic.
  *
@@ -244,6 +328,7 @@ add_harmonic (unsigned fund_freq)
   unsigned index;
   Wv_Data *cur_harmonic;
   Wv_Data *array_base;
+  guint *indices;
   unsigned i;
 
   index = wv_all_freqs->d[fund_freq].harmonics->len;
@@ -251,38 +336,37 @@ add_harmonic (unsigned fund_freq)
   /* Due to the possibility that changing the array can cause the
      array's base address to be moved, all of the wave editor data
      pointers must be rebased.  */
-  array_base = wv_all_freqs->d[fund_freq].harmonics->d;
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    wv_all_freqs->d[fund_freq].wv_editors->d[i]->data =
-      (Wv_Data *) (wv_all_freqs->d[fund_freq].wv_editors->d[i]->data -
-		   array_base);
-
-  g_array_set_size ((GArray *) wv_all_freqs->d[fund_freq].harmonics,
-		    index + 1);
+  indices = get_editor_indices (fund_freq);
+  model_add_harmonic (fund_freq);
 
   array_base = wv_all_freqs->d[fund_freq].harmonics->d;
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    wv_all_freqs->d[fund_freq].wv_editors->d[i]->data = array_base +
-      (unsigned) (wv_all_freqs->d[fund_freq].wv_editors->d[i]->data);
+  for (i = 0; i < wv_all_freqs->d[fund_freq].ui->wv_editors->len; i++)
+    wv_all_freqs->d[fund_freq].ui->wv_editors->d[i]->data =
+      array_base + indices[i];
+  g_free (indices);
 
   cur_harmonic = &(wv_all_freqs->d[fund_freq].harmonics->d[index]);
-  cur_harmonic->amplitude = 1.0;
 
-  if (index != 0)
+  if (wv_all_freqs->d[fund_freq].ui->harmc_store != NULL)
     {
-      cur_harmonic->harmc_num =
-	wv_all_freqs->d[fund_freq].harmonics->d[index-1].harmc_num + 1;
+      GtkTreeIter iter;
+      gchar cb_text[11];
+      sprintf (cb_text, "%u", cur_harmonic->harmc_num);
+      gtk_list_store_append (wv_all_freqs->d[fund_freq].ui->harmc_store,
+			     &iter);
+      gtk_list_store_set (wv_all_freqs->d[fund_freq].ui->harmc_store, &iter,
+			  0, cb_text, -1);
     }
-  else
-    cur_harmonic->harmc_num = 2;
-  cur_harmonic->group_idx = index;
 }
 
 /**
  * Deletes a harmonic.
  *
  * Whenever a harmonic is not removed from the end of the list, any
- * references to later harmonics will have to be changed.
+ * references to later harmonics will have to be changed.  Wave editor
+ * windows that were viewing the removed harmonic are moved to the
+ * preceding harmonic, or to the following one if the first harmonic
+ * was removed.
  * @param fund_freq the fundamental frequency set to work with
  * @param index zero-based index of the harmonic to remove
  */
@@ -291,34 +375,94 @@ remove_harmonic (unsigned fund_freq, unsigned index)
 {
   unsigned i;
   Wv_Data *array_base;
+  guint *indices;
 
   /* Due to the possibility that changing the array can cause the
      array's base address to be moved, all of the wave editor data
      pointers must be rebased.  */
-  array_base = wv_all_freqs->d[fund_freq].harmonics->d;
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    wv_all_freqs->d[fund_freq].wv_editors->d[i]->data =
-      (Wv_Data *) (wv_all_freqs->d[fund_freq].wv_editors->d[i]->data -
-		   array_base);
-
-  g_array_remove_index ((GArray *) wv_all_freqs->d[fund_freq].harmonics,
-			index);
+  indices = get_editor_indices (fund_freq);
+  model_remove_harmonic (fund_freq, index);
 
   array_base = wv_all_freqs->d[fund_freq].harmonics->d;
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    wv_all_freqs->d[fund_freq].wv_editors->d[i]->data = array_base +
-      (unsigned) (wv_all_freqs->d[fund_freq].wv_editors->d[i]->data);
+  for (i = 0; i < wv_all_freqs->d[fund_freq].ui->wv_editors->len; i++)
+    {
+      Wv_Editor_Data *cur_editor;
+      unsigned offset;
+      cur_editor = wv_all_freqs->d[fund_freq].ui->wv_editors->d[i];
+      offset = indices[i];
+      if (offset > 0 && offset >= index)
+	offset--;
+      cur_editor->data = array_base + offset;
+    }
+  g_free (indices);
+
+  /* The data pointers must be valid before the row is removed, since
+     the combo boxes viewing it will be changed.  */
+  if (wv_all_freqs->d[fund_freq].ui->harmc_store != NULL)
+    {
+      GtkTreeIter iter;
+      gtk_tree_model_iter_nth_child
+	(GTK_TREE_MODEL (wv_all_freqs->d[fund_freq].ui->harmc_store),
+	 &iter, NULL, index);
+      gtk_list_store_remove (wv_all_freqs->d[fund_freq].ui->harmc_store,
+			     &iter);
+    }
 
   if (wv_all_freqs->d[fund_freq].harmonics->len == 0)
     {
       /* Remove all editor windows.  */
-      while (wv_all_freqs->d[fund_freq].wv_editors->len > 0)
+      while (wv_all_freqs->d[fund_freq].ui->wv_editors->len > 0)
 	    remove_wv_editor (fund_freq, 0);
     }
+}
+
+/**
+ * Creates the user interface state of a fundamental frequency set.
+ *
+ * The set starts out without any wave editor windows, and all the
+ * widget fields are set to NULL.
+ * @param fund_freq the fundamental frequency set to work with
+ */
+static void
+create_fund_ui (unsigned fund_freq)
+{
+  Wv_Fund_Ui *ui = g_slice_new (Wv_Fund_Ui);
 
-  /* Recalculate group indices as necessary.  */
-  for (i = index; i < wv_all_freqs->d[fund_freq].harmonics->len; i++)
-      wv_all_freqs->d[fund_freq].harmonics->d[i].group_idx = i;
+  /* Initialize the fundamental frequency editor window.  */
+  ui->fund_editor.widget = NULL;
+  ui->fund_editor.view = NULL;
+  ui->fund_editor.data = NULL;
+  ui->fund_editor.freq_sliders.len = 0;
+  ui->fund_editor.amp_sliders.len = 0;
+
+  ui->wv_editors = (Wv_Editor_Data_Ptr_array *)
+    g_array_new (FALSE, FALSE, sizeof (Wv_Editor_Data_Ptr));
+  ui->harmc_store = NULL;
+  ui->snap = NULL;
+  ui->editor_tops = NULL;
+  wv_all_freqs->d[fund_freq].ui = ui;
+}
+
+/**
+ * Creates the user interface state of a range of fundamental
+ * frequency sets after a project was read, with one wave editor
+ * window for each set that has harmonics.
+ *
+ * A large project can be done a few sets at a time, as long as the
+ * user cannot reach any set that does not have its state yet.
+ * @param first the first set to create the state of
+ * @param end one past the last set to create the state of
+ */
+void
+create_fund_uis (unsigned first, unsigned end)
+{
+  unsigned i;
+  for (i = first; i < end; i++)
+    {
+      create_fund_ui (i);
+      if (wv_all_freqs->d[i].harmonics->len > 0)
+	add_wv_editor (i, 0, &wv_all_freqs->d[i].harmonics->d[0]);
+    }
 }
 
 /**
@@ -332,26 +476,8 @@ remove_harmonic (unsigned fund_freq, unsigned index)
 void
 add_fund_freq (void)
 {
-  unsigned index;
-  index = wv_all_freqs->len;
-  g_array_set_size ((GArray *) wv_all_freqs, index + 1);
-  wv_all_freqs->d[index].fund_freq = 440.0;
-  wv_all_freqs->d[index].amplitude = 1.0;
-  wv_all_freqs->d[index].phase_pos = 0.0;
-  wv_all_freqs->d[index].fund_editor.widget = NULL;
-  wv_all_freqs->d[index].harmonics = (Wv_Data_array *)
-    g_array_new (FALSE, FALSE, sizeof (Wv_Data));
-
-  /* Initialize the fundamental frequency editor window.  */
-  wv_all_freqs->d[index].fund_editor.widget = NULL;
-  wv_all_freqs->d[index].fund_editor.data = NULL;
-  wv_all_freqs->d[index].fund_editor.freq_sliders = (Slide_Data_Ptr_array *)
-    g_array_new (FALSE, FALSE, sizeof (Slide_Data_Ptr));
-  wv_all_freqs->d[index].fund_editor.amp_sliders = (Slide_Data_Ptr_array *)
-    g_array_new (FALSE, FALSE, sizeof (Slide_Data_Ptr));
-
-  wv_all_freqs->d[index].wv_editors = (Wv_Editor_Data_Ptr_array *)
-    g_array_new (FALSE, FALSE, sizeof (Wv_Editor_Data_Ptr));
+  model_add_fund_freq ();
+  create_fund_ui (wv_all_freqs->len - 1);
 }
 
 /**
@@ -367,26 +493,59 @@ add_fund_freq (void)
 void
 remove_fund_freq (unsigned index)
 {
-  g_array_free ((GArray *) wv_all_freqs->d[index].harmonics, TRUE);
-  free_slider_data (wv_all_freqs->d[index].fund_editor.freq_sliders);
-  g_array_free ((GArray *) wv_all_freqs->d[index].fund_editor.freq_sliders,
-		TRUE);
-  free_slider_data (wv_all_freqs->d[index].fund_editor.amp_sliders);
-  g_array_free ((GArray *) wv_all_freqs->d[index].fund_editor.amp_sliders,
-		TRUE);
+  Wv_Fund_Ui *ui = wv_all_freqs->d[index].ui;
+  free_slider_data (&ui->fund_editor.freq_sliders);
+  free_slider_data (&ui->fund_editor.amp_sliders);
   /* Destroy the members of the wave editors array first.  */
-  while (wv_all_freqs->d[index].wv_editors->len > 0)
+  while (ui->wv_editors->len > 0)
     remove_wv_editor (index, 0);
-  g_array_free ((GArray *) wv_all_freqs->d[index].wv_editors, TRUE);
-  g_array_remove_index ((GArray *) wv_all_freqs, index);
+  g_array_free ((GArray *) ui->wv_editors, TRUE);
+  if (ui->harmc_store != NULL)
+    g_object_unref (ui->harmc_store);
+  undo_snap_unref (ui->snap);
+  g_free (ui->editor_tops);
+  g_slice_free (Wv_Fund_Ui, ui);
+  wv_all_freqs->d[index].ui = NULL;
+  model_remove_fund_freq (index);
+}
+
+/**
+ * Gets the model shared by the harmonic selection combo boxes.
+ *
+ * The model is built the first time it is needed, and it is kept up
+ * to date by add_harmonic() and remove_harmonic() from then on.
+ * @param fund_freq the fundamental frequency set to work with
+ */
+GtkListStore *
+get_harmc_store (unsigned fund_freq)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  unsigned i;
+
+  if (cur_fund->ui->harmc_store != NULL)
+    return cur_fund->ui->harmc_store;
+
+  cur_fund->ui->harmc_store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < cur_fund->harmonics->len; i++)
+    {
+      GtkTreeIter iter;
+      gchar cb_text[11];
+      sprintf (cb_text, "%u", cur_fund->harmonics->d[i].harmc_num);
+      gtk_list_store_append (cur_fund->ui->harmc_store, &iter);
+      gtk_list_store_set (cur_fund->ui->harmc_store, &iter, 0, cb_text, -1);
+    }
+  return cur_fund->ui->harmc_store;
 }
 
 /**
  * Restores the values of the precision sliders.
  *
- * During reselection, widgets get destroyed and previous widgets need
- * to get recreated.  This function should be called to restore the
- * values of precision sliders during such an event.
+ * During reselection, the fundamental frequency editor's widgets get
+ * destroyed and previous widgets need to get recreated.  This
+ * function should be called to restore the values of its precision
+ * sliders during such an event.  The precision sliders of the
+ * harmonic wave editor windows are restored by the editor strip
+ * whenever it binds a window.
  */
 void
 restore_prec_sliders (void)
@@ -394,15 +553,15 @@ restore_prec_sliders (void)
   GtkWidget *hscrollbar;
   GtkWidget *parent_box;
   Slide_Data *sd_block;
-  unsigned i;
   unsigned j;
 
-  parent_box = wv_all_freqs->d[g_fund_set].fund_editor.freq_sliders_vbox;
-  for (j = 0; j < wv_all_freqs->d[g_fund_set].fund_editor.
-	 freq_sliders->len; j++)
+  parent_box = wv_all_freqs->d[g_fund_set].ui->fund_editor.freq_sliders_vbox;
+  for (j = 0; j < wv_all_freqs->d[g_fund_set].ui->fund_editor.
+	 freq_sliders.len; j++)
     {
       gdouble last_value;
-      sd_block = wv_all_freqs->d[g_fund_set].fund_editor.freq_sliders->d[j];
+      sd_block =
+	wv_all_freqs->d[g_fund_set].ui->fund_editor.freq_sliders.d[j];
       last_value = sd_block->last_value;
       hscrollbar =
 	gtk_hscrollbar_new (GTK_ADJUSTMENT
@@ -414,12 +573,12 @@ restore_prec_sliders (void)
 		G_CALLBACK (precslid_value_changed), (gpointer) sd_block);
     }
 
-  parent_box = wv_all_freqs->d[g_fund_set].fund_editor.amp_sliders_vbox;
-  for (j = 0; j < wv_all_freqs->d[g_fund_set].fund_editor.
-	 amp_sliders->len; j++)
+  parent_box = wv_all_freqs->d[g_fund_set].ui->fund_editor.amp_sliders_vbox;
+  for (j = 0; j < wv_all_freqs->d[g_fund_set].ui->fund_editor.
+	 amp_sliders.len; j++)
     {
       gdouble last_value;
-      sd_block = wv_all_freqs->d[g_fund_set].fund_editor.amp_sliders->d[j];
+      sd_block = wv_all_freqs->d[g_fund_set].ui->fund_editor.amp_sliders.d[j];
       last_value = sd_block->last_value;
       hscrollbar =
 	gtk_hscrollbar_new (GTK_ADJUSTMENT
@@ -430,29 +589,35 @@ restore_prec_sliders (void)
       g_signal_connect ((gpointer) hscrollbar, "value_changed",
 		G_CALLBACK (precslid_value_changed), (gpointer) sd_block);
     }
+}
 
-  for (i = 0; i < wv_all_freqs->d[g_fund_set].wv_editors->len; i++)
+/**
+ * Fills the fundamental set selection combo box.
+ *
+ * The rows are put into a new model before it is given to the combo
+ * box, so that the combo box does not have to react to each row as
+ * it is added.  This must be called again whenever the number of
+ * fundamental sets changes other than by adding or removing a single
+ * set.
+ */
+void
+fill_fund_set_combo (void)
+{
+  GtkListStore *store;
+  unsigned i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < wv_all_freqs->len; i++)
     {
-      parent_box = wv_all_freqs->d[g_fund_set].wv_editors->d[i]->
-	amp_sliders_vbox;
-      for (j = 0;
-	   j < wv_all_freqs->d[g_fund_set].wv_editors->d[i]->amp_sliders->len;
-	   j++)
-	{
-	  gdouble last_value;
-	  sd_block =
-	    wv_all_freqs->d[g_fund_set].wv_editors->d[i]->amp_sliders->d[j];
-	  last_value = sd_block->last_value;
-	  hscrollbar =
-	    gtk_hscrollbar_new (GTK_ADJUSTMENT
-		(gtk_adjustment_new (last_value, 0, 21, 0.1, 1.0, 1.0)));
-	  gtk_widget_show (hscrollbar);
-	  sd_block->widget = hscrollbar;
-	  gtk_box_pack_start (GTK_BOX (parent_box), hscrollbar, TRUE, TRUE, 0);
-	  g_signal_connect ((gpointer) hscrollbar, "value_changed",
-		    G_CALLBACK (precslid_value_changed), (gpointer) sd_block);
-	}
+      GtkTreeIter iter;
+      gchar cb_text[11];
+      sprintf (cb_text, "%u", i + 1);
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, cb_text, -1);
     }
+  gtk_combo_box_set_model (GTK_COMBO_BOX (cb_fund_set),
+			   GTK_TREE_MODEL (store));
+  g_object_unref (store);
+  gtk_combo_box_set_active (GTK_COMBO_BOX (cb_fund_set), g_fund_set);
 }
 
 /**
@@ -469,50 +634,36 @@ select_fund_freq (unsigned fund_freq)
 {
   /* Create all the editor widgets */
   gboolean sliders_init;
-  unsigned i;
   g_fund_set = fund_freq;
 
   /* Check to see if reselection is necessary.  */
-  if (wv_all_freqs->d[g_fund_set].fund_editor.freq_sliders->len == 0 &&
-      wv_all_freqs->d[g_fund_set].fund_editor.amp_sliders->len == 0)
+  if (wv_all_freqs->d[g_fund_set].ui->fund_editor.freq_sliders.len == 0 &&
+      wv_all_freqs->d[g_fund_set].ui->fund_editor.amp_sliders.len == 0)
     sliders_init = TRUE;
   else
     sliders_init = FALSE;
 
-  wv_all_freqs->d[fund_freq].fund_editor.widget =
-    create_wvedit_holder (TRUE, fund_freq);
+  wv_all_freqs->d[fund_freq].ui->fund_editor.widget =
+    create_fund_editor (fund_freq);
   gtk_box_pack_start (GTK_BOX (wave_edit_cntr),
-	      wv_all_freqs->d[fund_freq].fund_editor.widget, FALSE, FALSE, 0);
-
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    {
-      Wv_Editor_Data *cur_editor;
-      cur_editor = wv_all_freqs->d[fund_freq].wv_editors->d[i];
-      /* The values of all the widget fields will be set in the
-	 following function.  */
-      cur_editor->widget = create_wvedit_holder (FALSE, i);
-      gtk_box_pack_start (GTK_BOX (wave_edit_cntr), cur_editor->widget,
-			  FALSE, FALSE, 0);
-    }
+		      wv_all_freqs->d[fund_freq].ui->fund_editor.widget,
+		      FALSE, FALSE, 0);
+  gtk_box_reorder_child (GTK_BOX (wave_edit_cntr),
+			 wv_all_freqs->d[fund_freq].ui->fund_editor.widget, 0);
 
   if (!combo_init)
     {
       combo_init = TRUE;
-      /* Add combo box entries.  */
-      for (i = 0; i < wv_all_freqs->len; i++)
-	{
-	  unsigned cur_fund;
-	  gchar cb_text[11];
-	  cur_fund = i + 1;
-	  sprintf (cb_text, "%u", cur_fund);
-	  gtk_combo_box_append_text (GTK_COMBO_BOX (cb_fund_set), cb_text);
-	  if (cur_fund == 1)
-	    gtk_combo_box_set_active (GTK_COMBO_BOX (cb_fund_set), 0);
-	}
+      fill_fund_set_combo ();
     }
 
   if (!sliders_init)
     restore_prec_sliders ();
+
+  /* Only the harmonic wave editor windows that are scrolled into view
+     get widgets, so this does not depend on the number of
+     harmonics.  */
+  editor_strip_update ();
 }
 
 /**
@@ -526,253 +677,42 @@ select_fund_freq (unsigned fund_freq)
 void
 unselect_fund_freq (unsigned fund_freq)
 {
-  /* Destroy all the editor widgets.  */
-  unsigned i;
-  gtk_widget_destroy (wv_all_freqs->d[fund_freq].fund_editor.widget);
-  wv_all_freqs->d[fund_freq].fund_editor.widget = NULL;
-  for (i = 0; i < wv_all_freqs->d[fund_freq].wv_editors->len; i++)
-    {
-      gtk_widget_destroy (wv_all_freqs->d[fund_freq].wv_editors->d[i]->widget);
-      wv_all_freqs->d[fund_freq].wv_editors->d[i]->widget = NULL;
-    }
-}
-
-/**
- * Saves a Slider Wave Editor project file.
- *
- * @param filename the file name to save to
- * @return TRUE if save was successful, FALSE otherwise
- */
-gboolean
-save_sliw_project (char *filename)
-{
-  FILE *fp;
-  char *locale_temp;
-  char *last_locale;
-
-  fp = fopen (filename, "w");
-  if (fp == NULL)
-    goto error;
-
-  fputs (
-"# This is a Slider Wave Editor project file.  Comments are only\n"
-"# allowed at the beginning of a project file, and they are not\n"
-"# preserved during file loading and saving in Slider.\n"
-"#\n"
-"# A harmonic is specified as a pair of numbers.  The first number is\n"
-"# the harmonic number, and the second is the amplitude.\n", fp);
-
-  /* The project file's contents are written in English to prevent
-     compatibility problems with Slider running in different
-     languages.  */
-  locale_temp = setlocale (LC_NUMERIC, NULL);
-  last_locale = (char *) g_malloc (strlen (locale_temp) + 1);
-  strcpy (last_locale, locale_temp);
-  setlocale (LC_NUMERIC, "C");
-
-  /* "libintl" overrides the default *printf functions, so to prevent
-     problems with passing file pointers between different versions of
-     the Microsoft C runtime, all fprintf functions must be declared
-     in a separate source file.  */
-  do_save_printing (fp);
-
-  setlocale (LC_NUMERIC, last_locale);
-  g_free (last_locale);
-  if (fclose (fp) == EOF)
-    goto error;
-  return TRUE;
-
- error:
-  {
-    GtkWidget *dialog;
-    dialog = gtk_message_dialog_new_with_markup
-      (GTK_WINDOW (main_window),
-       GTK_DIALOG_DESTROY_WITH_PARENT,
-       GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
-       _("<b><big>An error occurred while saving your " \
-	 "file.</big></b>\n\n%s"),
-       strerror(errno));
-    gtk_dialog_run (GTK_DIALOG (dialog));
-    gtk_widget_destroy (dialog);
-    return FALSE;
-  }
+  /* Destroy the fundamental editor widgets, and return the harmonic
+     editor widgets to the editor strip.  */
+  precslid_flush ();
+  gtk_widget_destroy (wv_all_freqs->d[fund_freq].ui->fund_editor.widget);
+  wv_all_freqs->d[fund_freq].ui->fund_editor.widget = NULL;
+  editor_strip_release_all ();
 }
 
 /**
  * Exports a Slider Wave Editor project.
  *
- * The exported file is represented as a series of waveforms defined
- * only by frequency and amplitude in the format of a Nyquist Lisp
- * script.  This function is intended to be used as an efficient way
- * to import Slider sounds into other applications.
+ * The exported file is a Nyquist Lisp script written by
+ * write_nyquist_script().
  * @param filename the name of the file to export to
  */
 void
 export_sliw_project (char *filename)
 {
-  FILE* fp;
-  char *locale_temp;
-  char *last_locale;
-
-  fp = fopen (filename, "w");
-  if (fp == NULL)
-    goto error;
-
-  fputs (_( \
+  GtkWidget *dialog;
+  if (write_nyquist_script (filename, _( \
 "; This is a Nyquist Lisp file.\n" \
 "; You can use this with Audacity to generate a waveform.\n" \
 "; To do this, select a portion of time on a track, then go to \"Effect\n" \
-"; > Nyquist Prompt...\" and paste the contents of this file in.\n"), fp);
-
-  /* The script's contents are written in English since that is the
-     standard in computer programming.  */
-  locale_temp = setlocale (LC_NUMERIC, NULL);
-  last_locale = (char *) g_malloc (strlen (locale_temp) + 1);
-  strcpy (last_locale, locale_temp);
-  setlocale (LC_NUMERIC, "C");
-
-  fputs ("(sum", fp);
-  /* "libintl" overrides the default *printf functions, so to prevent
-     problems with passing file pointers between different versions of
-     the Microsoft C runtime, all fprintf functions must be declared
-     in a separate source file.  */
-  do_export_printing (fp);
-  fputs (")\n", fp);
-
-  setlocale (LC_NUMERIC, last_locale);
-  g_free (last_locale);
-  if (fclose (fp) == EOF)
-    goto error;
-  return;
-
- error:
-  {
-    GtkWidget *dialog;
-    dialog = gtk_message_dialog_new_with_markup
-      (GTK_WINDOW (main_window),
-       GTK_DIALOG_DESTROY_WITH_PARENT,
-       GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
-       _("<b><big>An error occurred while exporting your " \
-	 "file.</big></b>\n\n%s"),
-       strerror(errno));
-    gtk_dialog_run (GTK_DIALOG (dialog));
-    gtk_widget_destroy (dialog);
+"; > Nyquist Prompt...\" and paste the contents of this file in.\n"))
+      == CORE_OK)
     return;
-  }
-}
 
-/**
- * Loads a Slider Wave Editor project file.
- *
- * Opens, reads, and parses a Slider project file.  Slider project
- * files are plain text files, typically saved with the .txt
- * extension.  Note that parse error checking in this function is
- * minimal, and non well-formed documents can result in false
- * successful return status with incorrect data.
- * @param filename the name of the file to load
- * @return TRUE on successful load, FALSE on error.
- */
-gboolean
-load_sliw_project (char *filename)
-{
-  gboolean retval = FALSE;
-  FILE *fp;
-  char *locale_temp;
-  char *last_locale;
-  unsigned cur_fund;
-
-  fp = fopen (filename, "r");
-  if (fp == NULL)
-    {
-      GtkWidget *dialog;
-      dialog = gtk_message_dialog_new_with_markup
-	(NULL,
-	 GTK_DIALOG_DESTROY_WITH_PARENT,
-	 GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
-	 _("<b><big>Your file could not be opened.</big></b>\n\n" \
-	   "%s"),
-	 strerror(errno));
-      gtk_window_set_title (GTK_WINDOW (dialog), _("Slider Wave Editor"));
-      gtk_dialog_run (GTK_DIALOG (dialog));
-      gtk_widget_destroy (dialog);
-      return FALSE;
-    }
-
-  /* The project file's contents are written in English to prevent
-     compatibility problems with Slider running in different
-     languages.  */
-  locale_temp = setlocale (LC_NUMERIC, NULL);
-  last_locale = (char *) g_malloc (strlen (locale_temp) + 1);
-  strcpy (last_locale, locale_temp);
-  setlocale (LC_NUMERIC, "C");
-
-  { /* First skip the comments.  */
-    int ch;
-    while ((ch = getc (fp)) == '#')
-      while ((ch = getc (fp)) != EOF && ch != '\n');
-    if (ch == EOF)
-      goto cleanup;
-  }
-
-  if (fscanf (fp, "\nFundamental %u\n", &cur_fund) != 1)
-    goto cleanup;
-  while (!feof (fp))
-    {
-      unsigned i, j;
-      gboolean next_fundamental;
-      char test_buf[11];
-      i = cur_fund - 1;
-      add_fund_freq ();
-      add_wv_editor (wv_all_freqs->len - 1, 0,
-		     &wv_all_freqs->d[i].harmonics->d[0]);
-      if (fscanf (fp, "Frequency: %g\n", &wv_all_freqs->d[i].fund_freq) != 1 ||
-	  fscanf (fp, "Amplitude: %g\n", &wv_all_freqs->d[i].amplitude) != 1)
-	goto cleanup;
-      if (fscanf (fp, "%10c", test_buf) != 1)
-	goto cleanup;
-      test_buf[10] = '\0';
-      if (strcmp(test_buf, "Harmonics:"))
-	goto cleanup;
-
-      j = 0;
-      next_fundamental = FALSE;
-      do
-	{
-	  int scan_status;
-	  add_harmonic (i);
-	  scan_status = fscanf (fp, " %u, %g;",
-				&wv_all_freqs->d[i].harmonics->d[j].harmc_num,
-				&wv_all_freqs->d[i].harmonics->d[j].amplitude);
-	  if (scan_status != 2) /* No harmonics read */
-	    remove_harmonic (i, wv_all_freqs->d[i].harmonics->len - 1);
-	  if (fscanf (fp, "\nFundamental %u\n", &cur_fund) == 1)
-	      next_fundamental = TRUE;
-	  else if (feof (fp))
-	    break;
-	  j++;
-	} while (!next_fundamental);
-      fscanf (fp, "\n");
-    }
-  retval = TRUE;
- cleanup:
-  if (!retval)
-    {
-      GtkWidget *dialog;
-      dialog = gtk_message_dialog_new_with_markup
-	(NULL,
-	 GTK_DIALOG_DESTROY_WITH_PARENT,
-	 GTK_MESSAGE_ERROR, GTK_BUTTONS_OK,
-	 _("<b><big>A syntax error was found in your file.</big></b>\n\n" \
-	   "A blank template will be loaded instead."));
-      gtk_window_set_title (GTK_WINDOW (dialog), _("Slider Wave Editor"));
-      gtk_dialog_run (GTK_DIALOG (dialog));
-      gtk_widget_destroy (dialog);
-      return FALSE;
-    }
-  setlocale (LC_NUMERIC, last_locale);
-  g_free (last_locale);
-  fclose (fp);
-  return retval;
+  dialog = gtk_message_dialog_new_with_markup
+    (GTK_WINDOW (main_window),
+     GTK_DIALOG_DESTROY_WITH_PARENT,
+     GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE,
+     _("<b><big>An error occurred while exporting your " \
+       "file.</big></b>\n\n%s"),
+     strerror(errno));
+  gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
 }
 
 /**
@@ -781,130 +721,8 @@ load_sliw_project (char *filename)
 void
 new_sliw_project (void)
 {
-  Wv_Data *second_harmonic;
-  add_fund_freq ();
-  add_harmonic (0);
-  second_harmonic = &wv_all_freqs->d[0].harmonics->d[0];
-  add_wv_editor (0, 0, second_harmonic);
-}
-
-/**
- * Calculates the maximum frequency extent of the interesting parts of
- * a composite waveform.
- *
- * This function calculates the reciprocal of the maximum time extent
- * needed to view the interesting parts of the current sound effect in
- * ::wv_all_freqs.
- * @return the reciprocal of the time extent
- */
-float calc_freq_extent (void)
-{
-  unsigned i;
-  float most_fnd_frq;
-  float next_most_fnd_frq;
-  float least_fnd_frq;
-  float freq_ext;
-
-  /* Find the highest fundamental frequency.  */
-  most_fnd_frq = wv_all_freqs->d[0].fund_freq;
-  for (i = 0; i < wv_all_freqs->len; i++)
-    most_fnd_frq = MAX (wv_all_freqs->d[i].fund_freq, most_fnd_frq);
-  /* Find the next highest fundamental frequency.  */
-  next_most_fnd_frq = wv_all_freqs->d[0].fund_freq;
-  for (i = 0; i < wv_all_freqs->len; i++)
-    {
-      if (most_fnd_frq != wv_all_freqs->d[i].fund_freq)
-	{
-	  if (next_most_fnd_frq == most_fnd_frq)
-	    next_most_fnd_frq = wv_all_freqs->d[i].fund_freq;
-	  else
-	    next_most_fnd_frq = MAX (wv_all_freqs->d[i].fund_freq,
-				      next_most_fnd_frq);
-	}
-    }
-  /* If two different fundamental frequencies happen to be equal, set
-     next_most_fnd_frq to zero.  */
-  if (next_most_fnd_frq == most_fnd_frq)
-    next_most_fnd_frq = 0;
-  /* Find the lowest fundamental frequency.  */
-  least_fnd_frq = wv_all_freqs->d[0].fund_freq;
-  for (i = 0; i < wv_all_freqs->len; i++)
-    least_fnd_frq = MIN (wv_all_freqs->d[i].fund_freq, least_fnd_frq);
-
-  freq_ext = most_fnd_frq - next_most_fnd_frq;
-  /* When the frequency difference is greater than 100%, then the
-     display window should only reach to the extent of the component
-     with the longest wavelength.  */
-  if (freq_ext / next_most_fnd_frq > 1.00)
-    freq_ext = least_fnd_frq;
-  return freq_ext;
-}
-
-/**
- * Renders a composite waveform.
- *
- * Renders a waveform composed of all the fundamental frequency sets.
- * @param ypts the array that will hold the rendered samples, which
- * must be sufficiently allocated
- * @param num_samples the number of points to plot
- * @param x_max the maximum x-axis extent for rendering
- * @return a malloc'ed array of rendered points, which must be freed.
- */
-void
-render_waves (float * ypts, unsigned num_samples, float x_max)
-{
-  float pre_max_ypt = 0.0;
-  unsigned i;
-  for (i = 0; i < num_samples; i++)
-    ypts[i] = 0.0; /* Don't use memset ().  That will not set the
-		      actual value to "0.0".  */
-
-  for (i = 0; i < wv_all_freqs->len; i++)
-    plot_waveform (ypts, num_samples, x_max, i, 1);
-
-  for (i = 0; i < num_samples; i++)
-    pre_max_ypt = MAX(ABS(ypts[i]), pre_max_ypt);
-  max_ypt = pre_max_ypt;
-}
-
-/**
- * Plots a single fundamental frequency set.
- *
- * @param ypts the array that will hold the plotted points, which must
- * be sufficiently allocated.  The plotted waveform will be added to
- * the current values.
- * @param num_samples the number of points to plot
- * @param x_max the maximum x-axis extent for rendering
- * @param fund_freq_idx the fundamental frequency set to work with
- * @param ofs offset in samples from the beginning of the sine wave
- * cycle
- */
-void
-plot_waveform (float * ypts, unsigned num_samples, float x_max,
-	       unsigned fund_freq_idx, unsigned ofs)
-{
-  float inv_num_samp = 1.0 / num_samples;
-  float fund_freq = wv_all_freqs->d[fund_freq_idx].fund_freq;
-  float fund_amplitude = wv_all_freqs->d[fund_freq_idx].amplitude;
-  Wv_Data *harmonics = wv_all_freqs->d[fund_freq_idx].harmonics->d;
-  unsigned num_harmonics = wv_all_freqs->d[fund_freq_idx].harmonics->len;
-  unsigned i;
-  unsigned j;
-
-  for (i = 0; i < num_samples; i++)
-    {
-      float freq_mult;
-      freq_mult = fund_freq * x_max;
-      ypts[i] += sinf ((float) (i + ofs) * inv_num_samp * 2 * G_PI *
-		       freq_mult) * fund_amplitude;
-      for (j = 0; j < num_harmonics; j++)
-	{
-	  unsigned harmc_num = harmonics[j].harmc_num;
-	  ypts[i] += sinf ((float) (i + ofs) * harmc_num * inv_num_samp *
-			   2 * G_PI * freq_mult) *
-	    harmonics[j].amplitude;
-	}
-    }
+  model_new_project ();
+  create_fund_uis (0, wv_all_freqs->len);
 }
 
 /**
@@ -981,14 +799,13 @@ mult_amplitudes (float new_amplitude, GtkWidget * last_dialog)
   total_samples = 0;
   for (i = 0; i < wv_all_freqs->len; i++)
     {
+      Wv_Data_array *harmonics = wv_all_freqs->d[i].harmonics;
       unsigned max_harmonic;
-      unsigned j;
+      /* Harmonics are sorted, so the last one is the highest.  */
       max_harmonic = 1;
-      for (j = 0; j < wv_all_freqs->d[i].harmonics->len; j++)
-	{
-	  max_harmonic = MAX (wv_all_freqs->d[i].harmonics->d[j].harmc_num,
-			      max_harmonic);
-	}
+      if (harmonics->len > 0)
+	max_harmonic = MAX (harmonics->d[harmonics->len-1].harmc_num,
+			    max_harmonic);
       /* Just use an arbitrary brute force number pick.  */
       num_samples[i] = max_harmonic * 200;
       total_samples += num_samples[i];
@@ -1058,3 +875,112 @@ mult_amplitudes (float new_amplitude, GtkWidget * last_dialog)
   unselect_fund_freq (g_fund_set);
   select_fund_freq (g_fund_set);
 }
+
+/**
+ * Records the harmonic index of each wave editor window of a
+ * fundamental frequency set, so that the harmonic array can be
+ * reallocated.
+ *
+ * @param fund_freq the fundamental frequency set to work with
+ * @param count the number of harmonics there will be afterward
+ * @return the harmonic index of each window, which must be passed to
+ * attach_wv_editors()
+ */
+static guint *
+detach_wv_editors (unsigned fund_freq, unsigned count)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  Wv_Editor_Data_Ptr_array *editors = cur_fund->ui->wv_editors;
+
+  if (count == 0)
+    {
+      /* Remove all editor windows.  */
+      while (editors->len > 0)
+	remove_wv_editor (fund_freq, 0);
+    }
+  return get_editor_indices (fund_freq);
+}
+
+/**
+ * Points the wave editor windows back at their harmonics after
+ * detach_wv_editors().
+ *
+ * Every window stays on the same harmonic index if it still exists,
+ * or moves to the last harmonic otherwise.  If the set has harmonics
+ * but no windows, one window is opened on the first harmonic.
+ * @param fund_freq the fundamental frequency set to work with
+ * @param indices the harmonic indices from detach_wv_editors(),
+ * which are freed
+ */
+static void
+attach_wv_editors (unsigned fund_freq, guint * indices)
+{
+  Wv_Fund_Freq *cur_fund = &wv_all_freqs->d[fund_freq];
+  Wv_Editor_Data_Ptr_array *editors = cur_fund->ui->wv_editors;
+  unsigned count = cur_fund->harmonics->len;
+  Wv_Data *array_base = cur_fund->harmonics->d;
+  unsigned i;
+
+  for (i = 0; i < editors->len; i++)
+    editors->d[i]->data = array_base + MIN (indices[i], count - 1);
+  g_free (indices);
+
+  if (count > 0 && editors->len == 0)
+    add_wv_editor (fund_freq, 0, &array_base[0]);
+
+  /* The combo box model will be rebuilt the next time it is
+     needed.  */
+  if (cur_fund->ui->harmc_store != NULL)
+    {
+      g_object_unref (cur_fund->ui->harmc_store);
+      cur_fund->ui->harmc_store = NULL;
+    }
+}
+
+/**
+ * Replaces all of the harmonics of a fundamental frequency set.
+ *
+ * The harmonic array is resized only once, and the existing wave
+ * editor windows are kept.  Every window stays on the same harmonic
+ * index if it still exists, or moves to the last harmonic otherwise.
+ * Since no widgets are touched, the caller must unselect the
+ * fundamental frequency set first if it is selected and select it
+ * again afterward.
+ * @param fund_freq the fundamental frequency set to work with
+ * @param harmonics the new harmonics
+ * @param count the number of elements in @a harmonics
+ */
+void
+replace_harmonics (unsigned fund_freq, const Wv_Data *harmonics,
+		   unsigned count)
+{
+  guint *indices = detach_wv_editors (fund_freq, count);
+  model_set_harmonics (fund_freq, harmonics, count);
+  attach_wv_editors (fund_freq, indices);
+}
+
+/**
+ * Replaces the harmonics of a fundamental frequency set with a
+ * generated harmonic series.
+ *
+ * See replace_harmonics() for how the wave editor windows and widgets
+ * are treated.
+ * @param fund_freq the fundamental frequency set to work with
+ * @param series the shape of the harmonic series
+ * @param count the number of harmonics to generate, not counting the
+ * fundamental
+ * @param rolloff the ratio between the amplitudes of neighboring
+ * harmonics for ::HARMC_SERIES_EXPONENTIAL
+ */
+void
+generate_harmonics (unsigned fund_freq, Harmc_Series series,
+		    unsigned count, float rolloff)
+{
+  guint *indices;
+
+  g_return_if_fail (count > 0);
+
+  indices = detach_wv_editors (fund_freq, count);
+  model_generate_harmonics (fund_freq, series, count, rolloff);
+  attach_wv_editors (fund_freq, indices);
+}
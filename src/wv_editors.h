@@ -43,24 +43,12 @@ DAMAGE.  */
 #ifndef WV_EDITORS_H
 #define WV_EDITORS_H
 
-#include "gawrapper.h"
+#include "slidercore.h"
 
-typedef struct _Wv_Data Wv_Data;
 typedef struct _Wv_Editor_Data Wv_Editor_Data;
-typedef struct _Wv_Fund_Freq Wv_Fund_Freq;
+typedef struct _Wv_Fund_Ui Wv_Fund_Ui;
 typedef struct _Slide_Data Slide_Data;
-
-/**
- * Data for a single harmonic.
- */
-struct _Wv_Data
-{
-  unsigned harmc_num; /**< Harmonic number */
-  float amplitude;
-  unsigned group_idx; /**< Index into the allocated array */
-};
-
-GA_WTYPE(Wv_Data);
+typedef struct _Slide_Data_List Slide_Data_List;
 
 /**
  * Reference structure for a scrollbar in a slider group.
@@ -71,7 +59,7 @@ GA_WTYPE(Wv_Data);
 struct _Slide_Data
 {
   GtkWidget *widget; /**< Scrollbar widget */
-  unsigned index; /**< Index into the owning Slide_Data_Ptr_array */
+  unsigned index; /**< Index into the owning Slide_Data_List */
   /**
    * Used to calculate the value being adjusted
    *
@@ -79,6 +67,12 @@ struct _Slide_Data
    */
   gdouble base;
   gdouble last_value; /**< Previous scrollbar value */
+  /**
+   * Scale of this slider in the formula above, which is
+   * <code>pow(100, -index)</code>.  It is cached since the index
+   * never changes.
+   */
+  gdouble value_mult;
   gboolean fund_assoc; /**< Is this associated with @a fund_editor?  */
   /** Index into @a wv_editors.  If @a fund_assoc is TRUE, this is
    * zero for @a freq_sliders and one for @a amp_sliders.  */
@@ -86,7 +80,25 @@ struct _Slide_Data
 };
 
 typedef Slide_Data* Slide_Data_Ptr;
-GA_WTYPE(Slide_Data_Ptr);
+
+/**
+ * Largest number of precision sliders in one group.  Each slider
+ * moves the value 100 times more finely than the one before it, so
+ * a ninth slider would change a value by less than the precision of
+ * a double.
+ */
+#define MAX_PREC_SLIDERS 8
+
+/**
+ * The precision sliders of one group.  The list is stored inline in
+ * its wave editor window, so it is allocated and released together
+ * with the window rather than separately.
+ */
+struct _Slide_Data_List
+{
+  Slide_Data_Ptr d[MAX_PREC_SLIDERS];
+  unsigned len;
+};
 
 /**
  * Data for a wave editor window.
@@ -99,6 +111,13 @@ GA_WTYPE(Slide_Data_Ptr);
  */
 struct _Wv_Editor_Data
 {
+  /**
+   * The frame holding the editor window's widgets.  For the harmonic
+   * wave editor windows, this and the other widget fields are only
+   * valid while the window is scrolled into view and bound to a
+   * recycled set of widgets from the editor strip, and they are NULL
+   * otherwise.
+   */
   GtkWidget *widget;
   unsigned index; /**< Index into the allocated array */
   Wv_Data *data;
@@ -107,38 +126,27 @@ struct _Wv_Editor_Data
   GtkWidget *amp_mntisa;
   GtkWidget *amp_exp;
   GtkWidget *harmc_sel;
-  Slide_Data_Ptr_array *freq_sliders;
+  Slide_Data_List freq_sliders;
   GtkWidget *freq_slid_rm_btn;
   GtkWidget *freq_sliders_vbox;
-  Slide_Data_Ptr_array *amp_sliders;
+  Slide_Data_List amp_sliders;
   GtkWidget *amp_slid_rm_btn;
   GtkWidget *amp_sliders_vbox;
   GtkWidget *harmc_win_rm_btn;
+  /** The editor strip's widgets bound to this window, if any */
+  struct _Harmc_View *view;
 };
 
 typedef Wv_Editor_Data* Wv_Editor_Data_Ptr;
 GA_WTYPE(Wv_Editor_Data_Ptr);
 
 /**
- * Collection of all data for a fundamental frequency set.
+ * State of the user interface for a fundamental frequency set.
+ *
+ * This is pointed to by the @a ui field of ::Wv_Fund_Freq.
  */
-struct _Wv_Fund_Freq
+struct _Wv_Fund_Ui
 {
-  float fund_freq; /**< The fundamental's frequency in Hertz */
-  float amplitude;
-  /**
-   * Current phase position in audio playback.
-   *
-   * Ranges from 0.0 to 1.0, with 0.0 indicated playback is at the
-   * beginning of the fundamental frequency's sine wave and 1.0
-   * indicating playback is at the end of one period respectively.
-   * Phase positions of different fundamentals will get off from their
-   * expected positions when the user changes the frequency of
-   * fundamentals in real time, which is why each fundamental's phase
-   * position must be tracked separately.
-   */
-  float phase_pos;
-  Wv_Data_array *harmonics;
   /** Fundamental frequency editor */
   Wv_Editor_Data fund_editor;
   /**
@@ -151,16 +159,38 @@ struct _Wv_Fund_Freq
    * user_data.
    */
   Wv_Editor_Data_Ptr_array *wv_editors;
+  /**
+   * Harmonic numbers shown in the harmonic selection combo boxes.
+   *
+   * All of the combo boxes share this one model, so it is only built
+   * once by get_harmc_store() and then kept up to date as harmonics
+   * are added and removed.  It is NULL until it is first needed.
+   */
+  GtkListStore *harmc_store;
+  /**
+   * Undo snapshot that matches the current data of this set, or NULL
+   * if the set was edited since its last snapshot.  See undo.h.
+   */
+  struct _Undo_Snap *snap;
+  /**
+   * Offset of each harmonic wave editor window from the top of the
+   * first one, followed by the total height of the windows.  This is
+   * built by the editor strip when it is needed, and it is NULL
+   * whenever windows or their precision sliders were added or removed
+   * since.  See editor_strip_invalidate().
+   */
+  gint *editor_tops;
 };
 
-GA_WTYPE(Wv_Fund_Freq);
-
-extern Wv_Fund_Freq_array *wv_all_freqs;
 extern unsigned g_fund_set;
 
 void init_wv_editors (void);
 void free_wv_editors (void);
-void free_slider_data (Slide_Data_Ptr_array *sliders);
+void free_slider_data (Slide_Data_List *sliders);
+Slide_Data *alloc_slide_data (void);
+Slide_Data *append_slide_data (Slide_Data_List *sliders,
+			       gboolean fund_assoc, unsigned parent_index);
+void free_slide_data (Slide_Data *slider);
 void add_wv_editor (unsigned fund_freq, unsigned index,
 		    Wv_Data *last_wv_data);
 void remove_wv_editor (unsigned fund_freq, unsigned index);
@@ -168,17 +198,18 @@ void add_harmonic (unsigned fund_freq);
 void remove_harmonic (unsigned fund_freq, unsigned index);
 void add_fund_freq (void);
 void remove_fund_freq (unsigned index);
+void create_fund_uis (unsigned first, unsigned end);
+GtkListStore *get_harmc_store (unsigned fund_freq);
+void fill_fund_set_combo (void);
 void restore_prec_sliders (void);
 void select_fund_freq (unsigned fund_freq);
 void unselect_fund_freq (unsigned fund_freq);
-gboolean save_sliw_project (char *filename);
 void export_sliw_project (char *filename);
-gboolean load_sliw_project (char *filename);
 void new_sliw_project (void);
-float calc_freq_extent (void);
-void render_waves (float * ypts, unsigned num_samples, float x_max);
-void plot_waveform (float * ypts, unsigned num_samples, float x_max,
-		    unsigned fund_freq_idx, unsigned ofs);
 void mult_amplitudes (float new_amplitude, GtkWidget * last_dialog);
+void replace_harmonics (unsigned fund_freq, const Wv_Data *harmonics,
+			unsigned count);
+void generate_harmonics (unsigned fund_freq, Harmc_Series series,
+			 unsigned count, float rolloff);
 
 #endif /* not WV_EDITORS_H */